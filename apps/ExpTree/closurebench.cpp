@@ -0,0 +1,97 @@
+//
+// File:   closurebench.cpp
+// Author: <Your Glorious Instructor>
+// Purpose:
+// Time one formula over many rows of input, evaluated every way we have:
+// walking the tree, running bytecode, calling closures, and the
+// compile-time expression the compiler sees in full.
+//
+// Usage: closurebench [rows]
+// The default is 1M rows.  Build in Release mode or the numbers mean
+// nothing.
+//
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "ExpBytecode.hpp"
+#include "ExpClosure.hpp"
+#include "ExpNode.hpp"
+#include "ExpParser.hpp"
+#include "ExpStatic.hpp"
+
+// Run a function and return how long it took in milliseconds.
+template <typename Func>
+double timeIt(Func f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+#define FORMULA "(x*2.5 + y) * (x - 1.5) / (y*y + 1) - x/3"
+
+int main(int argc, char* argv[]) {
+    std::size_t rows = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    std::mt19937 rng(8);
+    std::vector<double> xs(rows), ys(rows), out(rows);
+    for (std::size_t r = 0; r < rows; ++r) {
+        xs[r] = std::uniform_real_distribution<double>(-5, 5)(rng);
+        ys[r] = std::uniform_real_distribution<double>(-5, 5)(rng);
+    }
+    const double* columns[] = {xs.data(), ys.data()};
+    double sink = 0;
+    auto drain = [&] {
+        for (double v : out) sink += v;
+    };
+
+    TreeOfExpNodes tree = parseExpTree(FORMULA);
+    ExpProgram program = compileExpTree(tree);
+    ExpClosure closure = compileClosure(tree);
+    constexpr auto formula = staticExpression<FORMULA>;
+
+    std::cout << FORMULA << ", " << rows << " rows\n"
+              << std::setw(26) << "evaluator" << std::setw(12) << "ns/row" << "\n";
+    auto report = [&](const char* name, double ms) {
+        drain();
+        std::cout << std::setw(26) << name << std::fixed << std::setprecision(2) << std::setw(12)
+                  << ms * 1e6 / rows << "\n";
+    };
+
+    report("tree walk", timeIt([&] {
+        ExpVariables vars{{"x", 0}, {"y", 0}};
+        for (std::size_t r = 0; r < rows; ++r) {
+            vars["x"] = xs[r];
+            vars["y"] = ys[r];
+            out[r] = evalExpTree(tree, vars);
+        }
+    }));
+    report("bytecode, row by row", timeIt([&] {
+        for (std::size_t r = 0; r < rows; ++r) {
+            double vars[] = {xs[r], ys[r]};
+            out[r] = program.run(vars);
+        }
+    }));
+    report("closures, row by row", timeIt([&] {
+        for (std::size_t r = 0; r < rows; ++r) {
+            double vars[] = {xs[r], ys[r]};
+            out[r] = closure(vars);
+        }
+    }));
+    report("constexpr, row by row", timeIt([&] {
+        for (std::size_t r = 0; r < rows; ++r) out[r] = formula(xs[r], ys[r]);
+    }));
+    report("bytecode runBatch", timeIt([&] { program.runBatch(columns, rows, out.data()); }));
+    report("constexpr runBatch", timeIt([&] { formula.runBatch(columns, rows, out.data()); }));
+    report("hand-written loop", timeIt([&] {
+        for (std::size_t r = 0; r < rows; ++r) {
+            double x = xs[r], y = ys[r];
+            out[r] = (x * 2.5 + y) * (x - 1.5) / (y * y + 1) - x / 3;
+        }
+    }));
+    std::cout << "(checksum " << sink << ")\n";
+    return 0;
+}
@@ -0,0 +1,111 @@
+//
+// File:   compactbench.cpp
+// Author: <Your Glorious Instructor>
+// Purpose:
+// Compare a big expression held as a Tree of ExpNodes with the same
+// expression in a CompactExp: how much memory each takes, and how long
+// each takes to evaluate.
+//
+// Usage: compactbench [levels]
+// The expression is a random full tree with the given number of operator
+// levels (default 19, a little over a million nodes).  Leaves are random
+// numbers, or x, y or z about a third of the time.  Memory is what is
+// still allocated on the heap once each one is built, from glibc's
+// mallinfo2() before and after.  Build in Release mode or the times mean
+// nothing.
+//
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <malloc.h>
+#include <random>
+#include <string>
+#include <vector>
+#include "ExpBytecode.hpp"
+#include "ExpCompact.hpp"
+#include "ExpNode.hpp"
+
+// Heap bytes currently allocated, as malloc counts them: chunks handed out
+// from its arenas plus blocks it mapped on its own.
+static std::size_t liveBytes() {
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+}
+
+// Run a function and return how long it took in milliseconds.
+template <typename Func>
+double timeIt(Func f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+TreeOfExpNodes randomTree(std::mt19937& rng, int levels) {
+    if (levels == 0) {
+        if (rng() % 3 == 0)
+            return TreeOfExpNodes(TreeOfExpNodes(), ExpNode(VARIABLE, 0, std::string(1, "xyz"[rng() % 3])),
+                                  TreeOfExpNodes());
+        return TreeOfExpNodes(TreeOfExpNodes(), ExpNode(std::uniform_real_distribution<double>(1, 2)(rng)),
+                              TreeOfExpNodes());
+    }
+    static const char* const ops[] = {"+", "-", "*", "/"};
+    TreeOfExpNodes left = randomTree(rng, levels - 1);
+    TreeOfExpNodes right = randomTree(rng, levels - 1);
+    return TreeOfExpNodes(left, ExpNode(ops[rng() % 4]), right);
+}
+
+int main(int argc, char* argv[]) {
+    int levels = argc > 1 ? std::atoi(argv[1]) : 19;
+    const int runs = 20;
+    std::mt19937 rng(45);
+
+    std::size_t before = liveBytes();
+    TreeOfExpNodes tree = randomTree(rng, levels);
+    std::size_t treeBytes = liveBytes() - before;
+    std::size_t treeNodes = (std::size_t(2) << levels) - 1;
+
+    before = liveBytes();
+    CompactExp exp = CompactExp::fromTree(tree);
+    std::size_t buildBytes = liveBytes() - before;
+    exp.freeze();
+    std::size_t compactBytes = liveBytes() - before;
+
+    ExpProgram program = compileExpTree(tree);
+    ExpVariables vars{{"x", 1.25}, {"y", 1.5}, {"z", 1.75}};
+    std::vector<double> values;
+    for (const std::string& name : exp.variables()) values.push_back(vars[name]);
+    std::vector<double> programValues;
+    for (const std::string& name : program.variables()) programValues.push_back(vars[name]);
+
+    std::cout << levels << " levels, " << treeNodes << " tree nodes, " << exp.size() << " compact nodes\n\n"
+              << std::setw(28) << "form" << std::setw(14) << "bytes" << std::setw(14) << "bytes/node" << "\n";
+    auto memory = [&](const char* name, std::size_t bytes) {
+        std::cout << std::setw(28) << name << std::setw(14) << bytes << std::fixed << std::setprecision(1)
+                  << std::setw(14) << double(bytes) / treeNodes << "\n";
+    };
+    memory("Tree of ExpNodes", treeBytes);
+    memory("CompactExp while building", buildBytes);
+    memory("CompactExp, frozen", compactBytes);
+
+    double sink = 0;
+    std::cout << "\n" << std::setw(28) << "evaluator" << std::setw(14) << "ms/eval" << std::setw(14) << "ns/node"
+              << "\n";
+    auto report = [&](const char* name, double ms) {
+        std::cout << std::setw(28) << name << std::fixed << std::setprecision(3) << std::setw(14) << ms / runs
+                  << std::setprecision(2) << std::setw(14) << ms * 1e6 / runs / treeNodes << "\n";
+    };
+    report("evalExpTree", timeIt([&] {
+        for (int i = 0; i < runs; ++i) sink += evalExpTree(tree, vars);
+    }));
+    report("bytecode", timeIt([&] {
+        for (int i = 0; i < runs; ++i) sink += program.run(programValues.data());
+    }));
+    std::vector<double> scratch;
+    report("CompactExp", timeIt([&] {
+        for (int i = 0; i < runs; ++i) sink += exp.evaluate(values.data(), scratch);
+    }));
+    std::cout << "(checksum " << sink << ")\n";
+    return 0;
+}
@@ -0,0 +1,148 @@
+//
+// File:   expbench.cpp
+// Author: <Your Glorious Instructor>
+// Purpose:
+// Time evaluating the same expression over and over by walking the tree
+// (evalExpTree) against compiling it once and running the bytecode.  Then
+// time a formula over columns of input, one row at a time with run()
+// against a block at a time with runBatch().  Last, time big generated
+// formulas with lots of repeated pieces before and after optimizeExpTree.
+//
+// Usage: expbench [evaluations]
+// Each expression is evaluated that many times (default 1M), and the
+// columns have that many rows.  Build in Release mode or the numbers mean
+// nothing.
+//
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "ExpBytecode.hpp"
+#include "ExpNode.hpp"
+#include "ExpOptimize.hpp"
+
+// Run a function and return how long it took in milliseconds.
+template <typename Func>
+double timeIt(Func f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+// A random full expression tree with the given number of operator levels.
+// Division is left out so the values stay finite.  With withVars, about
+// half the leaves are one of four variables a to d.
+TreeOfExpNodes randomTree(std::mt19937& rng, int levels, bool withVars = false) {
+    if (levels == 0) {
+        if (withVars && rng() % 2 == 0) {
+            ExpNode leaf(VARIABLE, 0, std::string(1, "abcd"[rng() % 4]));
+            return TreeOfExpNodes(TreeOfExpNodes(), leaf, TreeOfExpNodes());
+        }
+        ExpNode leaf(std::uniform_real_distribution<double>(0.5, 2.0)(rng));
+        return TreeOfExpNodes(TreeOfExpNodes(), leaf, TreeOfExpNodes());
+    }
+    static const char* const ops[] = {"+", "-", "*"};
+    ExpNode op(std::string(ops[rng() % 3]));
+    return TreeOfExpNodes(randomTree(rng, levels - 1, withVars), op, randomTree(rng, levels - 1, withVars));
+}
+
+// A generated formula: a full tree whose leaves are x, y, 0, 1 or 2, so
+// the same small subexpressions turn up again and again, as they do in
+// machine-written formulas.
+TreeOfExpNodes generatedFormula(std::mt19937& rng, int levels) {
+    if (levels == 0) {
+        int pick = static_cast<int>(rng() % 5);
+        ExpNode leaf = pick < 2 ? ExpNode(VARIABLE, 0, pick == 0 ? "x" : "y") : ExpNode(double(pick - 2));
+        return TreeOfExpNodes(TreeOfExpNodes(), leaf, TreeOfExpNodes());
+    }
+    static const char* const ops[] = {"+", "-", "*"};
+    ExpNode op(std::string(ops[rng() % 3]));
+    return TreeOfExpNodes(generatedFormula(rng, levels - 1), op, generatedFormula(rng, levels - 1));
+}
+
+int main(int argc, char* argv[]) {
+    long evaluations = argc > 1 ? std::atol(argv[1]) : 1000000;
+    std::mt19937 rng(2024);
+    double sink = 0;
+
+    std::cout << evaluations << " evaluations of each expression\n"
+              << std::setw(8) << "nodes" << std::setw(14) << "tree ns" << std::setw(14) << "bytecode ns"
+              << std::setw(10) << "speedup" << "\n";
+    for (int levels : {1, 3, 5, 7}) {
+        TreeOfExpNodes tree = randomTree(rng, levels);
+        // Fewer runs for the big trees, so each row takes about as long.
+        long runs = evaluations >> (levels - 1);
+        double walk = timeIt([&] {
+            for (long i = 0; i < runs; ++i) sink += evalExpTree(tree);
+        });
+        ExpProgram program;
+        double compiled = timeIt([&] {
+            program = compileExpTree(tree);
+            for (long i = 0; i < runs; ++i) sink += program.run();
+        });
+        std::cout << std::setw(8) << tree.size() << std::fixed << std::setprecision(1)
+                  << std::setw(14) << walk * 1e6 / runs << std::setw(14) << compiled * 1e6 / runs
+                  << std::setw(9) << walk / compiled << "x\n";
+    }
+
+    std::size_t rows = static_cast<std::size_t>(evaluations);
+    std::vector<std::vector<double>> data(4, std::vector<double>(rows));
+    for (auto& column : data)
+        for (double& v : column) v = std::uniform_real_distribution<double>(0.5, 2.0)(rng);
+    std::vector<double> out(rows);
+
+    std::cout << "\n" << rows << " rows of four columns\n"
+              << std::setw(8) << "nodes" << std::setw(14) << "row ns" << std::setw(14) << "batch ns"
+              << std::setw(10) << "speedup" << "\n";
+    for (int levels : {1, 3, 5, 7}) {
+        ExpProgram program = compileExpTree(randomTree(rng, levels, true));
+        std::vector<const double*> columns;
+        for (const std::string& name : program.variables()) columns.push_back(data[name[0] - 'a'].data());
+
+        double byRow = timeIt([&] {
+            std::vector<double> row(columns.size());
+            for (std::size_t r = 0; r < rows; ++r) {
+                for (std::size_t c = 0; c < columns.size(); ++c) row[c] = columns[c][r];
+                out[r] = program.run(row.data());
+            }
+        });
+        for (double v : out) sink += v;
+        double batched = timeIt([&] { program.runBatch(columns.data(), rows, out.data()); });
+        for (double v : out) sink += v;
+        std::cout << std::setw(8) << program.code().size() << std::fixed << std::setprecision(2)
+                  << std::setw(14) << byRow * 1e6 / rows << std::setw(14) << batched * 1e6 / rows
+                  << std::setw(9) << std::setprecision(1) << byRow / batched << "x\n";
+    }
+
+    std::cout << "\n" << rows << " rows of generated formulas, before and after optimizing\n"
+              << std::setw(8) << "nodes" << std::setw(10) << "dag" << std::setw(10) << "code"
+              << std::setw(10) << "opt code" << std::setw(12) << "batch ns" << std::setw(12) << "opt ns"
+              << std::setw(10) << "speedup" << "\n";
+    for (int levels : {4, 8, 12}) {
+        TreeOfExpNodes tree = generatedFormula(rng, levels);
+        TreeOfExpNodes dag = optimizeExpTree(tree);
+        ExpProgram plain = compileExpTree(tree);
+        ExpProgram optimized = compileExpTree(dag);
+        auto columnsFor = [&](const ExpProgram& program) {
+            std::vector<const double*> columns;
+            for (const std::string& name : program.variables()) columns.push_back(data[name[0] - 'x'].data());
+            return columns;
+        };
+        std::vector<const double*> plainColumns = columnsFor(plain);
+        std::vector<const double*> optColumns = columnsFor(optimized);
+
+        double before = timeIt([&] { plain.runBatch(plainColumns.data(), rows, out.data()); });
+        for (double v : out) sink += v;
+        double after = timeIt([&] { optimized.runBatch(optColumns.data(), rows, out.data()); });
+        for (double v : out) sink += v;
+        std::cout << std::setw(8) << tree.size() << std::setw(10) << expDagSize(dag) << std::setw(10)
+                  << plain.code().size() << std::setw(10) << optimized.code().size() << std::fixed
+                  << std::setprecision(2) << std::setw(12) << before * 1e6 / rows << std::setw(12)
+                  << after * 1e6 / rows << std::setw(9) << std::setprecision(1) << before / after << "x\n";
+    }
+    std::cout << "(checksum " << sink << ")\n";
+    return 0;
+}
@@ -0,0 +1,169 @@
+//
+// File:   gexpparsertest.cpp
+// Author: <Your Glorious Instructor>
+// Purpose:
+//  Provide unit tests for the expression tokenizer and parser
+#include <gtest/gtest.h>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include "ExpNode.hpp"
+#include "ExpParser.hpp"
+
+// The position of the syntax error in text, or -1 if it parses.
+long errorAt(const std::string& text) {
+    try {
+        parseExpTree(text);
+    } catch (const ExpSyntaxError& e) {
+        return static_cast<long>(e.position());
+    }
+    return -1;
+}
+
+// A random expression with every operation in parentheses, the format
+// simplecalc and ExpTree used to require, along with its tree.
+std::string randomParenthesized(std::mt19937& rng, int levels, TreeOfExpNodes& tree) {
+    if (levels == 0) {
+        double value = std::uniform_int_distribution<int>(0, 999)(rng) / 8.0;
+        tree = TreeOfExpNodes(TreeOfExpNodes(), ExpNode(value), TreeOfExpNodes());
+        return std::to_string(value);
+    }
+    char op = "+-*/"[rng() % 4];
+    TreeOfExpNodes left, right;
+    std::string text = "(" + randomParenthesized(rng, levels - 1, left) + " " + op + " " +
+                       randomParenthesized(rng, levels - 1, right) + ")";
+    tree = TreeOfExpNodes(left, ExpNode(std::string(1, op)), right);
+    return text;
+}
+
+// Test: The tokenizer splits text into tokens that point into it
+// Precondition: The text " 12.5*(rate_2 -x)".
+// Postcondition: Number, Operator, LeftParen, Name, Operator, Name,
+//                RightParen, then End for good, with the right text and
+//                positions.
+TEST(ExpTokenizer, Tokens) {
+    std::string text = " 12.5*(rate_2 -x)";
+    ExpTokenizer tokens(text);
+    ExpTokenKind kinds[] = {ExpTokenKind::Number, ExpTokenKind::Operator, ExpTokenKind::LeftParen,
+                            ExpTokenKind::Name, ExpTokenKind::Operator, ExpTokenKind::Name,
+                            ExpTokenKind::RightParen};
+    const char* texts[] = {"12.5", "*", "(", "rate_2", "-", "x", ")"};
+    std::size_t positions[] = {1, 5, 6, 7, 14, 15, 16};
+    for (int i = 0; i < 7; ++i) {
+        ExpToken token = tokens.next();
+        EXPECT_EQ(token.kind, kinds[i]);
+        EXPECT_EQ(token.text, texts[i]);
+        EXPECT_EQ(token.position, positions[i]);
+        EXPECT_GE(token.text.data(), text.data());
+        EXPECT_LT(token.text.data(), text.data() + text.size());
+    }
+    EXPECT_EQ(tokens.next().kind, ExpTokenKind::End);
+    EXPECT_EQ(tokens.peek().kind, ExpTokenKind::End);
+}
+
+// Test: Numbers are read in full
+// Precondition: Integers, decimals, a leading point and an exponent.
+// Postcondition: Each is one Number token with the right value.
+TEST(ExpTokenizer, Numbers) {
+    EXPECT_EQ(ExpTokenizer("42").peek().value, 42.0);
+    EXPECT_EQ(ExpTokenizer("3.25").peek().value, 3.25);
+    EXPECT_EQ(ExpTokenizer(".5").peek().value, 0.5);
+    EXPECT_EQ(ExpTokenizer("1e3").peek().value, 1000.0);
+}
+
+// Test: * and / bind tighter than + and -, and all group left to right
+// Precondition: Expressions without parentheses.
+// Postcondition: They evaluate by the usual rules.
+TEST(ExpParser, Precedence) {
+    EXPECT_DOUBLE_EQ(evaluateExpression("2+3*4"), 14.0);
+    EXPECT_DOUBLE_EQ(evaluateExpression("2*3+4"), 10.0);
+    EXPECT_DOUBLE_EQ(evaluateExpression("8-3-2"), 3.0);
+    EXPECT_DOUBLE_EQ(evaluateExpression("16/4/2"), 2.0);
+    EXPECT_DOUBLE_EQ(evaluateExpression("1+2*3-4/2"), 5.0);
+    EXPECT_DOUBLE_EQ(evaluateExpression("(2+3)*4"), 20.0);
+}
+
+// Test: The tree has the shape the precedence says
+// Precondition: The text "a-b-c*d".
+// Postcondition: The root is -, its left a-b and its right c*d.
+TEST(ExpParser, TreeShape) {
+    TreeOfExpNodes tree = parseExpTree("a-b-c*d");
+    EXPECT_EQ(tree.root().op, "-");
+    EXPECT_EQ(tree.left().root().op, "-");
+    EXPECT_EQ(tree.left().left().root(), ExpNode(VARIABLE, 0, "a"));
+    EXPECT_EQ(tree.right().root().op, "*");
+    EXPECT_EQ(tree.size(), 7u);
+}
+
+// Test: A leading minus sign negates what follows
+// Precondition: Minus before a number, a name, parentheses and itself.
+// Postcondition: The values come out negated; -2 is a single number.
+TEST(ExpParser, UnaryMinus) {
+    ExpVariables vars{{"x", 5}};
+    EXPECT_DOUBLE_EQ(evaluateExpression("-3*2"), -6.0);
+    EXPECT_DOUBLE_EQ(evaluateExpression("2*-x", vars), -10.0);
+    EXPECT_DOUBLE_EQ(evaluateExpression("-(1-4)"), 3.0);
+    EXPECT_DOUBLE_EQ(evaluateExpression("--2"), 2.0);
+    EXPECT_DOUBLE_EQ(evaluateExpression("4 - -1"), 5.0);
+    EXPECT_EQ(parseExpTree("-2").size(), 1u);
+}
+
+// Test: Variables are looked up while evaluating
+// Precondition: x*y+z with values for all three, then without z.
+// Postcondition: The right value, then out_of_range.
+TEST(ExpParser, Variables) {
+    ExpVariables vars{{"x", 2}, {"y", 3}, {"z", 4}};
+    EXPECT_DOUBLE_EQ(evaluateExpression("x*y+z", vars), 10.0);
+    vars.erase("z");
+    EXPECT_THROW(evaluateExpression("x*y+z", vars), std::out_of_range);
+    EXPECT_THROW(evaluateExpression("x"), std::out_of_range);
+}
+
+// Test: Fully parenthesized input means what it always did
+// Precondition: Random fully parenthesized expressions and their trees.
+// Postcondition: Parsing gives the same tree, and evaluating while
+//                parsing gives what evalExpTree gives for it.
+TEST(ExpParser, FullyParenthesized) {
+    std::mt19937 rng(3);
+    for (int levels = 0; levels <= 6; ++levels) {
+        for (int trial = 0; trial < 10; ++trial) {
+            TreeOfExpNodes expected;
+            std::string text = randomParenthesized(rng, levels, expected);
+            TreeOfExpNodes parsed = parseExpTree(text);
+            std::vector<ExpNode> a, b;
+            expected.preorder([&a](ExpNode n) { a.push_back(n); });
+            parsed.preorder([&b](ExpNode n) { b.push_back(n); });
+            EXPECT_EQ(a, b) << text;
+            double value = evalExpTree(expected);
+            double direct = evaluateExpression(text);
+            if (std::isnan(value)) EXPECT_TRUE(std::isnan(direct));
+            else EXPECT_EQ(direct, value) << text;
+        }
+    }
+}
+
+// Test: Mistakes are reported where they are
+// Precondition: Various bad expressions.
+// Postcondition: ExpSyntaxError at the offending position.
+TEST(ExpParser, Errors) {
+    EXPECT_EQ(errorAt("2 +"), 3);
+    EXPECT_EQ(errorAt("(1+2"), 4);
+    EXPECT_EQ(errorAt("1 2"), 2);
+    EXPECT_EQ(errorAt("3 $ 4"), 2);
+    EXPECT_EQ(errorAt("."), 0);
+    EXPECT_EQ(errorAt(""), 0);
+    EXPECT_EQ(errorAt("*3"), 0);
+    EXPECT_EQ(errorAt("(1))"), 3);
+    EXPECT_EQ(errorAt("2x"), 1);
+    EXPECT_EQ(errorAt("1+2"), -1);
+}
+
+// Test: Very deep nesting is refused instead of overflowing the stack
+// Precondition: 100 and 100000 nested parentheses around a 1.
+// Postcondition: The first parses; the second throws ExpSyntaxError.
+TEST(ExpParser, DeepNesting) {
+    EXPECT_DOUBLE_EQ(evaluateExpression(std::string(100, '(') + "1" + std::string(100, ')')), 1.0);
+    EXPECT_THROW(evaluateExpression(std::string(100000, '(') + "1" + std::string(100000, ')')), ExpSyntaxError);
+    EXPECT_THROW(evaluateExpression(std::string(100000, '-') + "x"), ExpSyntaxError);
+}
@@ -0,0 +1,431 @@
+//
+// File:   gexptreetest.cpp
+// Author: <Your Glorious Instructor>
+// Purpose:
+//  Provide unit tests for the expression tree evaluator, the bytecode
+//  compiler, the optimizer, and the closure and compile-time evaluators
+#include <gtest/gtest.h>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include "ExpBytecode.hpp"
+#include "ExpClosure.hpp"
+#include "ExpCompact.hpp"
+#include "ExpNode.hpp"
+#include "ExpOptimize.hpp"
+#include "ExpParser.hpp"
+#include "ExpStatic.hpp"
+
+TreeOfExpNodes num(double x) {
+    return TreeOfExpNodes(TreeOfExpNodes(), ExpNode(x), TreeOfExpNodes());
+}
+
+TreeOfExpNodes var(const std::string& name) {
+    return TreeOfExpNodes(TreeOfExpNodes(), ExpNode(VARIABLE, 0, name), TreeOfExpNodes());
+}
+
+TreeOfExpNodes bin(const std::string& op, TreeOfExpNodes lhs, TreeOfExpNodes rhs) {
+    return TreeOfExpNodes(lhs, ExpNode(op), rhs);
+}
+
+// A random full expression tree with the given number of operator levels.
+// With withVars, about a third of the leaves are x, y or z.
+TreeOfExpNodes randomTree(std::mt19937& rng, int levels, bool withVars = false) {
+    if (levels == 0) {
+        if (withVars && rng() % 3 == 0) return var(std::string(1, "xyz"[rng() % 3]));
+        return num(std::uniform_int_distribution<int>(1, 9)(rng));
+    }
+    static const char* const ops[] = {"+", "-", "*", "/"};
+    return bin(ops[rng() % 4], randomTree(rng, levels - 1, withVars), randomTree(rng, levels - 1, withVars));
+}
+
+// Test: A single number compiles to one constant
+// Precondition: A tree holding only 2.5.
+// Postcondition: Both evaluators give 2.5, with one instruction.
+TEST(ExpBytecode, SingleNumber) {
+    TreeOfExpNodes tree = num(2.5);
+    ExpProgram program = compileExpTree(tree);
+    EXPECT_DOUBLE_EQ(evalExpTree(tree), 2.5);
+    EXPECT_DOUBLE_EQ(program.run(), 2.5);
+    ASSERT_EQ(program.code().size(), 1u);
+    EXPECT_EQ(program.stackDepth(), 1u);
+}
+
+// Test: The code is the tree in postfix order
+// Precondition: The tree for ((2+3)*4).
+// Postcondition: const, const, add, const, mul with constants 2, 3, 4,
+//                and the result is 20.
+TEST(ExpBytecode, PostfixOrder) {
+    ExpProgram program = compileExpTree(bin("*", bin("+", num(2), num(3)), num(4)));
+    ASSERT_EQ(program.code().size(), 5u);
+    OpCode expected[] = {OpCode::Const, OpCode::Const, OpCode::Add, OpCode::Const, OpCode::Mul};
+    for (int i = 0; i < 5; ++i) EXPECT_EQ(program.code()[i].op, expected[i]);
+    EXPECT_EQ(program.constants(), (std::vector<double>{2, 3, 4}));
+    EXPECT_EQ(program.stackDepth(), 2u);
+    EXPECT_DOUBLE_EQ(program.run(), 20.0);
+}
+
+// Test: Operands keep their order for - and /
+// Precondition: Trees for (8-2) and (8/2).
+// Postcondition: 6 and 4, not -6 and 0.25.
+TEST(ExpBytecode, NonCommutative) {
+    EXPECT_DOUBLE_EQ(compileExpTree(bin("-", num(8), num(2))).run(), 6.0);
+    EXPECT_DOUBLE_EQ(compileExpTree(bin("/", num(8), num(2))).run(), 4.0);
+}
+
+// Test: The stack depth follows the shape of the tree
+// Precondition: A tree that leans right, 1+(2+(3+...)), 100 numbers long,
+//               deeper than run() keeps in its own frame.
+// Postcondition: The depth is 100 and the sum is still right.
+TEST(ExpBytecode, DeepRightLeaningTree) {
+    TreeOfExpNodes tree = num(100);
+    for (int i = 99; i >= 1; --i) tree = bin("+", num(i), tree);
+    ExpProgram program = compileExpTree(tree);
+    EXPECT_EQ(program.stackDepth(), 100u);
+    EXPECT_DOUBLE_EQ(program.run(), 5050.0);
+    EXPECT_DOUBLE_EQ(evalExpTree(tree), 5050.0);
+}
+
+// Test: Compiled code agrees with the tree walker
+// Precondition: Random trees of up to 8 levels of operators.
+// Postcondition: run() gives exactly what evalExpTree does, every time.
+TEST(ExpBytecode, MatchesTreeWalk) {
+    std::mt19937 rng(42);
+    for (int levels = 0; levels <= 8; ++levels) {
+        for (int trial = 0; trial < 20; ++trial) {
+            TreeOfExpNodes tree = randomTree(rng, levels);
+            double expected = evalExpTree(tree);
+            double actual = compileExpTree(tree).run();
+            if (std::isnan(expected)) EXPECT_TRUE(std::isnan(actual));
+            else EXPECT_EQ(actual, expected);
+        }
+    }
+}
+
+// Test: Bad trees are caught when compiling
+// Precondition: An unknown operator, and an operator missing an operand.
+// Postcondition: compileExpTree throws invalid_argument; an empty tree
+//                compiles to 0 like evalExpTree, as does a program that
+//                was never compiled into.
+TEST(ExpBytecode, BadTrees) {
+    EXPECT_THROW(compileExpTree(bin("%", num(1), num(2))), std::invalid_argument);
+    EXPECT_THROW(compileExpTree(TreeOfExpNodes(num(1), ExpNode(std::string("+")), TreeOfExpNodes())),
+                 std::invalid_argument);
+    EXPECT_DOUBLE_EQ(compileExpTree(TreeOfExpNodes()).run(), 0.0);
+    EXPECT_DOUBLE_EQ(ExpProgram().run(), 0.0);
+}
+
+// Test: Variables get slots in the order they first appear
+// Precondition: The tree for ((y*x)+(y/2)).
+// Postcondition: variables() is y, x; y is loaded from the same slot both
+//                times; with x=3, y=4 both evaluators give 14.
+TEST(ExpBytecode, Variables) {
+    TreeOfExpNodes tree = bin("+", bin("*", var("y"), var("x")), bin("/", var("y"), num(2)));
+    ExpProgram program = compileExpTree(tree);
+    EXPECT_EQ(program.variables(), (std::vector<std::string>{"y", "x"}));
+    EXPECT_EQ(program.slot("y"), 0);
+    EXPECT_EQ(program.slot("x"), 1);
+    EXPECT_EQ(program.slot("z"), -1);
+    EXPECT_EQ(program.code()[0].op, OpCode::Load);
+    EXPECT_EQ(program.code()[3].op, OpCode::Load);
+    EXPECT_EQ(program.code()[3].arg, 0u);
+
+    ExpVariables vars{{"x", 3}, {"y", 4}};
+    EXPECT_DOUBLE_EQ(evalExpTree(tree, vars), 14.0);
+    EXPECT_DOUBLE_EQ(program.run(vars), 14.0);
+    double slots[] = {4, 3};
+    EXPECT_DOUBLE_EQ(program.run(slots), 14.0);
+    EXPECT_THROW(program.run(ExpVariables{{"x", 3}}), std::out_of_range);
+}
+
+// Test: Batch evaluation gives the same answers as one row at a time
+// Precondition: Random trees over x, y and z, and columns of 1000 rows
+//               (not a whole number of blocks).
+// Postcondition: runBatch() matches run() on every row.
+TEST(ExpBytecode, BatchMatchesRows) {
+    std::mt19937 rng(7);
+    const std::size_t rows = 1000;
+    std::vector<std::vector<double>> data(3, std::vector<double>(rows));
+    for (auto& column : data)
+        for (double& v : column) v = std::uniform_real_distribution<double>(-10, 10)(rng);
+
+    for (int levels = 0; levels <= 6; ++levels) {
+        TreeOfExpNodes tree = randomTree(rng, levels, true);
+        ExpProgram program = compileExpTree(tree);
+        std::vector<const double*> columns;
+        for (const std::string& name : program.variables()) columns.push_back(data[name[0] - 'x'].data());
+
+        std::vector<double> out(rows);
+        program.runBatch(columns.data(), rows, out.data());
+        for (std::size_t r = 0; r < rows; ++r) {
+            std::vector<double> row;
+            for (const double* column : columns) row.push_back(column[r]);
+            double expected = program.run(row.data());
+            if (std::isnan(expected)) EXPECT_TRUE(std::isnan(out[r]));
+            else EXPECT_EQ(out[r], expected) << "row " << r << " of a " << levels << "-level tree";
+        }
+    }
+}
+
+// Test: A batch of no rows, and a constant expression over a batch
+// Precondition: The tree for (2*3).
+// Postcondition: Zero rows writes nothing; 5 rows are all 6.
+TEST(ExpBytecode, BatchEdgeCases) {
+    ExpProgram program = compileExpTree(bin("*", num(2), num(3)));
+    std::vector<double> out(5, -1.0);
+    program.runBatch(nullptr, 0, out.data());
+    EXPECT_EQ(out, std::vector<double>(5, -1.0));
+    program.runBatch(nullptr, 5, out.data());
+    EXPECT_EQ(out, std::vector<double>(5, 6.0));
+}
+
+// Test: Constant subtrees are folded
+// Precondition: The trees for ((2*3)+x) and ((1+2)*(8/4)).
+// Postcondition: The first becomes 6+x, the second the single number 6.
+TEST(ExpOptimize, FoldsConstants) {
+    TreeOfExpNodes tree = optimizeExpTree(bin("+", bin("*", num(2), num(3)), var("x")));
+    EXPECT_EQ(tree.root().op, "+");
+    EXPECT_EQ(tree.left().root(), ExpNode(6.0));
+    EXPECT_EQ(tree.right().root(), ExpNode(VARIABLE, 0, "x"));
+    EXPECT_EQ(compileExpTree(tree).code().size(), 3u);
+
+    TreeOfExpNodes constant = optimizeExpTree(bin("*", bin("+", num(1), num(2)), bin("/", num(8), num(4))));
+    EXPECT_EQ(constant.size(), 1u);
+    EXPECT_EQ(constant.root(), ExpNode(6.0));
+}
+
+// Test: Identities that hold in floating point are applied, others aren't
+// Precondition: ((x*1)+0), (1*(x/1)), (0-x) and (x*0).
+// Postcondition: The first two become x; the last two are left as they are.
+TEST(ExpOptimize, Identities) {
+    TreeOfExpNodes x = var("x");
+    EXPECT_EQ(optimizeExpTree(bin("+", bin("*", x, num(1)), num(0))).root(), x.root());
+    EXPECT_EQ(optimizeExpTree(bin("*", num(1), bin("/", x, num(1)))).size(), 1u);
+    EXPECT_EQ(optimizeExpTree(bin("-", num(0), x)).size(), 3u);
+    EXPECT_EQ(optimizeExpTree(bin("*", x, num(0))).size(), 3u);
+}
+
+// Test: Identical subtrees are shared and computed once
+// Precondition: The tree for ((x+y)*(x+y)), with the two sums built
+//               separately.
+// Postcondition: The optimized tree's children are the same node, the DAG
+//                has 4 nodes, and the code computes x+y once, saves it and
+//                reuses it.
+TEST(ExpOptimize, SharesCommonSubexpressions) {
+    TreeOfExpNodes tree = bin("*", bin("+", var("x"), var("y")), bin("+", var("x"), var("y")));
+    EXPECT_EQ(expDagSize(tree), 7u);
+    TreeOfExpNodes dag = optimizeExpTree(tree);
+    EXPECT_EQ(dag.left().identity(), dag.right().identity());
+    EXPECT_EQ(dag.size(), 7u);
+    EXPECT_EQ(expDagSize(dag), 4u);
+
+    ExpProgram program = compileExpTree(dag);
+    OpCode expected[] = {OpCode::Load, OpCode::Load, OpCode::Add, OpCode::Save, OpCode::Reuse, OpCode::Mul};
+    ASSERT_EQ(program.code().size(), 6u);
+    for (int i = 0; i < 6; ++i) EXPECT_EQ(program.code()[i].op, expected[i]);
+    EXPECT_EQ(program.temporaries(), 1u);
+    EXPECT_DOUBLE_EQ(program.run(ExpVariables{{"x", 2}, {"y", 5}}), 49.0);
+}
+
+// Test: Optimizing doesn't change the value
+// Precondition: Random trees over x, y and z with small constants, deep
+//               enough to have repeats, evaluated at random points.
+// Postcondition: The optimized, compiled code gives what the tree walker
+//                gives on the original tree, one row at a time and in
+//                batches, and its DAG is never bigger than the tree.
+TEST(ExpOptimize, PreservesValues) {
+    std::mt19937 rng(11);
+    std::vector<std::vector<double>> data(3, std::vector<double>(300));
+    for (auto& column : data)
+        for (double& v : column) v = std::uniform_real_distribution<double>(-4, 4)(rng);
+
+    for (int levels = 1; levels <= 9; ++levels) {
+        TreeOfExpNodes tree = randomTree(rng, levels, true);
+        TreeOfExpNodes dag = optimizeExpTree(tree);
+        EXPECT_LE(expDagSize(dag), tree.size());
+        ExpProgram program = compileExpTree(dag);
+        std::vector<const double*> columns;
+        for (const std::string& name : program.variables()) columns.push_back(data[name[0] - 'x'].data());
+        std::vector<double> out(300);
+        program.runBatch(columns.data(), out.size(), out.data());
+
+        for (std::size_t r = 0; r < out.size(); ++r) {
+            ExpVariables vars{{"x", data[0][r]}, {"y", data[1][r]}, {"z", data[2][r]}};
+            double expected = evalExpTree(tree, vars);
+            if (std::isnan(expected)) {
+                EXPECT_TRUE(std::isnan(program.run(vars)));
+                EXPECT_TRUE(std::isnan(out[r]));
+            } else {
+                EXPECT_EQ(program.run(vars), expected);
+                EXPECT_EQ(out[r], expected);
+            }
+        }
+    }
+}
+
+// Test: The optimizer leaves bad trees for the compiler to reject
+// Precondition: An unknown operator between two numbers.
+// Postcondition: It isn't folded away; compiling still throws.
+TEST(ExpOptimize, KeepsBadOperators) {
+    TreeOfExpNodes tree = optimizeExpTree(bin("%", num(1), num(2)));
+    EXPECT_EQ(tree.size(), 3u);
+    EXPECT_THROW(compileExpTree(tree), std::invalid_argument);
+}
+
+// Test: Closures give what the tree walker gives
+// Precondition: Random trees over x, y and z, evaluated at random points,
+//               one at a time and in a batch.
+// Postcondition: Exactly the same values, NaN for NaN.
+TEST(ExpClosure, MatchesTreeWalk) {
+    std::mt19937 rng(21);
+    for (int levels = 0; levels <= 7; ++levels) {
+        TreeOfExpNodes tree = randomTree(rng, levels, true);
+        ExpClosure closure = compileClosure(tree);
+        std::vector<std::vector<double>> data(3, std::vector<double>(50));
+        for (auto& column : data)
+            for (double& v : column) v = std::uniform_real_distribution<double>(-3, 3)(rng);
+        std::vector<const double*> columns;
+        for (const std::string& name : closure.variables()) columns.push_back(data[name[0] - 'x'].data());
+        std::vector<double> out(50);
+        closure.runBatch(columns.data(), out.size(), out.data());
+
+        for (std::size_t r = 0; r < out.size(); ++r) {
+            ExpVariables vars{{"x", data[0][r]}, {"y", data[1][r]}, {"z", data[2][r]}};
+            double expected = evalExpTree(tree, vars);
+            if (std::isnan(expected)) {
+                EXPECT_TRUE(std::isnan(closure(vars)));
+                EXPECT_TRUE(std::isnan(out[r]));
+            } else {
+                EXPECT_EQ(closure(vars), expected);
+                EXPECT_EQ(out[r], expected);
+            }
+        }
+    }
+}
+
+// Test: Closures keep the sharing of an optimized tree, and check it
+// Precondition: ((x+y)*(x+y)) optimized, a bad operator, an empty tree.
+// Postcondition: Three closure nodes and the right value; the bad tree
+//                throws invalid_argument; the empty one gives 0.
+TEST(ExpClosure, SharingAndErrors) {
+    TreeOfExpNodes dag = optimizeExpTree(bin("*", bin("+", var("x"), var("y")), bin("+", var("x"), var("y"))));
+    ExpClosure closure = compileClosure(dag);
+    EXPECT_EQ(closure.size(), 3u);
+    EXPECT_EQ(closure.variables(), (std::vector<std::string>{"x", "y"}));
+    double vars[] = {2, 5};
+    EXPECT_DOUBLE_EQ(closure(vars), 49.0);
+
+    EXPECT_THROW(compileClosure(bin("%", num(1), var("x"))), std::invalid_argument);
+    EXPECT_DOUBLE_EQ(compileClosure(TreeOfExpNodes())(), 0.0);
+}
+
+// The compiler checks these while building the test.
+static_assert(staticExpression<"2*(3+4)">() == 14);
+static_assert(staticExpression<"1+2*3-4/2">() == 5);
+static_assert(staticExpression<"8-3-2">() == 3);
+static_assert(staticExpression<"-(1-4) * -2">() == -6);
+static_assert(staticExpression<"x*y+x">.variableCount == 2);
+static_assert(staticExpression<"x*y+x">(3, 4) == 15);
+static_assert(staticExpression<"rate * (1 + rate)">.variable(0) == "rate");
+
+// Test: Compile-time expressions agree with the run-time parser
+// Precondition: Formulas with precedence, unary minus, decimals and
+//               exponents, evaluated at a few points.
+// Postcondition: The same values bit for bit as evaluateExpression.
+TEST(ExpStatic, MatchesParser) {
+    constexpr auto f = staticExpression<"(x*2.5 + y) * (x - 1.5) / (y*y + 1) - x/3">;
+    constexpr auto g = staticExpression<"0.1 + 0.2*x - 123456.789e-3 + 1e3*.5 - -y">;
+    static_assert(f.variableCount == 2 && g.variableCount == 2);
+    for (double x : {-2.0, 0.0, 0.3, 7.25}) {
+        for (double y : {-1.0, 0.1, 4.0}) {
+            ExpVariables vars{{"x", x}, {"y", y}};
+            EXPECT_EQ(f(x, y), evaluateExpression("(x*2.5 + y) * (x - 1.5) / (y*y + 1) - x/3", vars));
+            EXPECT_EQ(g(x, y), evaluateExpression("0.1 + 0.2*x - 123456.789e-3 + 1e3*.5 - -y", vars));
+        }
+    }
+}
+
+// Test: Compile-time expressions run in batches too
+// Precondition: x*y - x/4 over 1000 rows, columns in slot order (x, y).
+// Postcondition: Every row matches calling the expression directly.
+TEST(ExpStatic, Batch) {
+    constexpr auto f = staticExpression<"x*y - x/4">;
+    std::vector<double> xs(1000), ys(1000), out(1000);
+    for (int i = 0; i < 1000; ++i) {
+        xs[i] = i * 0.5;
+        ys[i] = 3 - i * 0.25;
+    }
+    const double* columns[] = {xs.data(), ys.data()};
+    f.runBatch(columns, out.size(), out.data());
+    for (int i = 0; i < 1000; ++i) EXPECT_EQ(out[i], f(xs[i], ys[i]));
+}
+
+// Test: The compact form gives what the tree walker gives
+// Precondition: Random trees over x, y and z, copied into a CompactExp and
+//               evaluated at random points, reusing one scratch array.
+// Postcondition: Exactly the same values, NaN for NaN, and never more
+//                nodes than the tree has.
+TEST(ExpCompact, MatchesTreeWalk) {
+    std::mt19937 rng(31);
+    std::vector<double> scratch;
+    for (int levels = 0; levels <= 9; ++levels) {
+        TreeOfExpNodes tree = randomTree(rng, levels, true);
+        CompactExp exp = CompactExp::fromTree(tree);
+        EXPECT_LE(exp.size(), (std::size_t(2) << levels) - 1);
+        for (int trial = 0; trial < 20; ++trial) {
+            ExpVariables vars{{"x", std::uniform_real_distribution<double>(-3, 3)(rng)},
+                              {"y", std::uniform_real_distribution<double>(-3, 3)(rng)},
+                              {"z", std::uniform_real_distribution<double>(-3, 3)(rng)}};
+            std::vector<double> values;
+            for (const std::string& name : exp.variables()) values.push_back(vars[name]);
+            double expected = evalExpTree(tree, vars);
+            if (std::isnan(expected)) {
+                EXPECT_TRUE(std::isnan(exp.evaluate(values.data(), scratch)));
+            } else {
+                EXPECT_EQ(exp.evaluate(values.data(), scratch), expected);
+                EXPECT_EQ(exp.evaluate(vars), expected);
+            }
+        }
+    }
+}
+
+// Test: Repeated subexpressions are stored once
+// Precondition: (x+y)*(x+y) - (x+y), parsed straight into a CompactExp.
+// Postcondition: Four nodes (x, y, x+y, the product) plus the minus, in
+//                operands-first order, giving 42 at x=2, y=5.
+TEST(ExpCompact, SharesRepeats) {
+    CompactExp exp = parseCompactExp("(x+y)*(x+y) - (x+y)");
+    ASSERT_EQ(exp.size(), 5u);
+    EXPECT_EQ(exp.root(), 4u);
+    EXPECT_EQ(exp.variables(), (std::vector<std::string>{"x", "y"}));
+    const auto& nodes = exp.nodeArray();
+    for (std::size_t i = 0; i < nodes.size(); ++i) {
+        if (nodes[i].op != ExpCompactOp::Number && nodes[i].op != ExpCompactOp::Variable) {
+            EXPECT_LT(nodes[i].operands.left, i);
+            EXPECT_LT(nodes[i].operands.right, i);
+        }
+    }
+    double vars[] = {2, 5};
+    EXPECT_DOUBLE_EQ(exp.evaluate(vars), 42.0);
+    // Same numbers share too, but not different ones.
+    EXPECT_EQ(parseCompactExp("1+1").size(), 2u);
+    EXPECT_EQ(parseCompactExp("1+2").size(), 3u);
+}
+
+// Test: The compact form checks what it is given
+// Precondition: A bad operator, a missing operand, an operand that isn't
+//               a node, an empty tree, a syntax error, a missing variable.
+// Postcondition: invalid_argument, out_of_range, 0, ExpSyntaxError and
+//                out_of_range.
+TEST(ExpCompact, Errors) {
+    EXPECT_THROW(CompactExp::fromTree(bin("%", num(1), var("x"))), std::invalid_argument);
+    EXPECT_THROW(CompactExp::fromTree(TreeOfExpNodes(num(1), ExpNode("+"), TreeOfExpNodes())),
+                 std::invalid_argument);
+    CompactExp exp;
+    EXPECT_THROW(exp.binary('+', 0, 0), std::out_of_range);
+    EXPECT_DOUBLE_EQ(CompactExp::fromTree(TreeOfExpNodes()).evaluate(), 0.0);
+    EXPECT_DOUBLE_EQ(exp.evaluate(), 0.0);
+    EXPECT_THROW(parseCompactExp("1 + * 2"), ExpSyntaxError);
+    EXPECT_THROW(parseCompactExp("x + 1").evaluate(ExpVariables{{"y", 1}}), std::out_of_range);
+}
@@ -0,0 +1,113 @@
+//
+// File:   parsebench.cpp
+// Author: <Your Glorious Instructor>
+// Purpose:
+// Time reading a big batch of expressions, one per line: the old way
+// (istream peek/ignore with stacks, as simplecalc used to), parsing and
+// evaluating with ExpEvalBuilder, and parsing into trees.
+//
+// Usage: parsebench [lines]
+// The default is 1M lines.  Build in Release mode or the numbers mean
+// nothing.
+//
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stack>
+#include <string>
+#include <string_view>
+#include "ExpParser.hpp"
+
+// Run a function and return how long it took in milliseconds.
+template <typename Func>
+double timeIt(Func f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+// A random fully parenthesized expression, which both readers accept.
+std::string randomExpression(std::mt19937& rng, int levels) {
+    if (levels == 0) return std::to_string(rng() % 1000) + "." + std::to_string(rng() % 100);
+    char op = "+-*/"[rng() % 4];
+    return "(" + randomExpression(rng, levels - 1) + " " + op + " " + randomExpression(rng, levels - 1) + ")";
+}
+
+// simplecalc's original reader, kept here as the baseline.
+double oldReadAndEvaluate(std::istream& ins) {
+    std::stack<double> numbers;
+    std::stack<char> operations;
+    while (ins && ins.peek() != '\n' && ins.peek() != EOF) {
+        if (std::isdigit(ins.peek()) || ins.peek() == '.') {
+            double number;
+            ins >> number;
+            numbers.push(number);
+        } else if (std::strchr("+-*/", ins.peek()) != nullptr) {
+            char symbol;
+            ins >> symbol;
+            operations.push(symbol);
+        } else if (ins.peek() == ')') {
+            ins.ignore();
+            double op2 = numbers.top();
+            numbers.pop();
+            double op1 = numbers.top();
+            numbers.pop();
+            switch (operations.top()) {
+            case '+': numbers.push(op1 + op2); break;
+            case '-': numbers.push(op1 - op2); break;
+            case '*': numbers.push(op1 * op2); break;
+            case '/': numbers.push(op1 / op2); break;
+            }
+            operations.pop();
+        } else {
+            ins.ignore();
+        }
+    }
+    ins.ignore();   // the newline
+    return numbers.top();
+}
+
+// Call f on each line of text.
+template <typename Func>
+void forEachLine(std::string_view text, Func f) {
+    while (!text.empty()) {
+        std::size_t end = text.find('\n');
+        if (end == std::string_view::npos) end = text.size();
+        f(text.substr(0, end));
+        text.remove_prefix(end == text.size() ? end : end + 1);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    long lines = argc > 1 ? std::atol(argv[1]) : 1000000;
+    std::mt19937 rng(99);
+    std::string text;
+    for (long i = 0; i < lines; ++i) text += randomExpression(rng, 1 + static_cast<int>(rng() % 4)) + "\n";
+    double megabytes = text.size() / 1e6;
+    double sink = 0;
+
+    std::cout << lines << " expressions, " << std::fixed << std::setprecision(1) << megabytes << " MB\n"
+              << std::setw(28) << "reader" << std::setw(12) << "ms" << std::setw(12) << "MB/s" << "\n";
+    auto report = [&](const char* name, double ms) {
+        std::cout << std::setw(28) << name << std::setw(12) << ms << std::setw(12) << megabytes / (ms / 1000)
+                  << "\n";
+    };
+
+    report("istream peek/ignore", timeIt([&] {
+        std::istringstream in(text);
+        for (long i = 0; i < lines; ++i) sink += oldReadAndEvaluate(in);
+    }));
+    report("parse and evaluate", timeIt([&] {
+        forEachLine(text, [&](std::string_view line) { sink += evaluateExpression(line); });
+    }));
+    report("parse to trees", timeIt([&] {
+        forEachLine(text, [&](std::string_view line) { sink += parseExpTree(line).size(); });
+    }));
+    std::cout << "(checksum " << sink << ")\n";
+    return 0;
+}
@@ -8,6 +8,8 @@
 #include <fstream>
 #include <random>
 #include <list>
+#include <algorithm>
+#include <vector>
 #include "Tree.hpp"
 
 // We are violating one of the conventions of unit testing here by 
@@ -386,3 +388,121 @@ TEST(TreeSearch, FindEmptyTree) {
 	EXPECT_TRUE(resultTree.isEmpty()); // resultTree should be empty if not found
 }
 
+
+// The last set of tests covers the Transient builder used for batches of
+// inserts.
+
+// Test: A batch of inserts through a Transient produces the expected tree
+// Precondition: A tree has been constructed with specific values.
+// Postcondition: The new tree holds the old and new values in order, and the
+// original tree is unchanged.
+TEST(TreeTransient, BatchInsert) {
+    Tree<int> t{ 50, 25, 75 };
+    auto builder = t.transient();
+    for (int i = 0; i < 100; i += 10) {
+        builder.insert(i);
+    }
+    Tree<int> result = builder.persistent();
+
+    std::vector<int> inorder;
+    result.inorder([&](int v) { inorder.push_back(v); });
+    std::vector<int> expected{ 0, 10, 20, 25, 30, 40, 50, 60, 70, 75, 80, 90 };
+    EXPECT_EQ(inorder, expected);
+    EXPECT_EQ(t.size(), 3u);
+    EXPECT_FALSE(t.member(10));
+}
+
+// Test: A Transient ignores duplicates just like insert()
+// Precondition: A Transient is created from a tree.
+// Postcondition: Inserting values already present does not change the size.
+TEST(TreeTransient, NoDuplicates) {
+    auto builder = aTree.transient();
+    builder.insert(45).insert(45).insert(100).insert(7).insert(7);
+    Tree<int> result = builder.persistent();
+    EXPECT_EQ(result.size(), aTree.size() + 1);
+    EXPECT_TRUE(result.member(7));
+}
+
+// Test: Versions produced by successive Transients do not affect each other
+// Precondition: A tree is built by one Transient and then used as the
+// starting point for a second one.
+// Postcondition: The first version still holds exactly its own values.
+TEST(TreeTransient, VersionsAreIndependent) {
+    auto first = Tree<int>().transient();
+    first.insert(5).insert(3).insert(8);
+    Tree<int> v1 = first.persistent();
+
+    auto second = v1.transient();
+    second.insert(4).insert(9).insert(1);
+    Tree<int> v2 = second.persistent();
+
+    Tree<int> v3 = v1.insert(6);
+
+    EXPECT_EQ(v1.size(), 3u);
+    EXPECT_FALSE(v1.member(4));
+    EXPECT_EQ(v2.size(), 6u);
+    EXPECT_TRUE(v2.member(4));
+    EXPECT_FALSE(v2.member(6));
+    EXPECT_EQ(v3.size(), 4u);
+    EXPECT_FALSE(v3.member(9));
+}
+
+// Test: A Transient honors a caller-supplied comparison
+// Precondition: A Transient is filled using std::greater.
+// Postcondition: An inorder walk visits the values largest first.
+TEST(TreeTransient, CustomCompare) {
+    auto builder = Tree<int>().transient();
+    for (int v : { 3, 1, 4, 5, 9, 2, 6 }) {
+        builder.insert(v, std::greater<int>());
+    }
+    Tree<int> result = builder.persistent();
+    std::vector<int> inorder;
+    result.inorder([&](int v) { inorder.push_back(v); });
+    std::vector<int> expected{ 9, 6, 5, 4, 3, 2, 1 };
+    EXPECT_EQ(inorder, expected);
+}
+
+
+// These tests cover iterating over a tree in order.
+
+// Test: Iterating visits every value in order
+// Precondition: A tree built from values inserted in random order.
+// Postcondition: begin() to end() gives them sorted, and an empty tree
+// gives nothing.
+TEST(TreeIterator, InOrder) {
+    std::vector<int> values;
+    for (int i = 0; i < 200; ++i) values.push_back(i * 3);
+    std::mt19937 rng(48);
+    std::shuffle(values.begin(), values.end(), rng);
+    Tree<int> t;
+    for (int v : values) t = t.insert(v);
+
+    std::vector<int> seen(t.begin(), t.end());
+    std::sort(values.begin(), values.end());
+    EXPECT_EQ(seen, values);
+
+    Tree<int> empty;
+    EXPECT_TRUE(empty.begin() == empty.end());
+}
+
+// Test: lowerBound and upperBound find the right starting points
+// Precondition: The global tree { 28 32 44 45 74 100 }.
+// Postcondition: Each bound agrees with std::lower_bound/upper_bound on the
+// sorted values, including before the first and after the last.
+TEST(TreeIterator, Bounds) {
+    std::vector<int> sorted(aTree.begin(), aTree.end());
+    for (int key : { 0, 28, 30, 44, 45, 46, 100, 101 }) {
+        auto lower = aTree.lowerBound(key);
+        auto expectLower = std::lower_bound(sorted.begin(), sorted.end(), key);
+        if (expectLower == sorted.end()) {
+            EXPECT_TRUE(lower == aTree.end()) << key;
+        } else {
+            ASSERT_TRUE(lower != aTree.end()) << key;
+            EXPECT_EQ(*lower, *expectLower);
+            EXPECT_EQ(std::distance(lower, aTree.end()), sorted.end() - expectLower);
+        }
+        auto upper = aTree.upperBound(key);
+        auto expectUpper = std::upper_bound(sorted.begin(), sorted.end(), key);
+        EXPECT_EQ(std::distance(upper, aTree.end()), sorted.end() - expectUpper) << key;
+    }
+}
@@ -0,0 +1,140 @@
+//
+// File:   artbench.cpp
+// Author: Your Glorious Instructor
+// Purpose:
+// Compare ArtTree with Dictionary<std::string, int> and
+// std::unordered_map<std::string, int> on a million file paths: building,
+// looking up keys that are there and keys that aren't, and listing
+// everything under a directory.
+//
+// Usage: artbench [keys]
+// The default is 1,000,000 keys such as
+// "/home/user17/projects/parser/src/lexer/token_list.cpp", made from a few
+// dozen words so that they share long prefixes the way real paths do.
+// unordered_map has no order, so a prefix scan there has to look at every
+// key; it is timed over a handful of scans only.  Build in Release mode or
+// the numbers mean nothing.
+//
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "Dictionary.hpp"
+#include "arttree.hpp"
+
+// Run a function and return how long it took in milliseconds.
+template <typename Func>
+double timeIt(Func f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+std::vector<std::string> makePaths(std::size_t count, std::mt19937& rng) {
+    static const char* const projects[] = {"parser", "webapp", "kernel", "docs", "billing", "search",
+                                           "mobile", "infra", "analytics", "compiler"};
+    static const char* const dirs[] = {"src", "include", "test", "build", "assets", "scripts"};
+    static const char* const modules[] = {"lexer", "net", "storage", "ui", "util", "core", "io", "auth"};
+    static const char* const words[] = {"token", "list", "buffer", "cache", "client", "server", "index",
+                                        "query", "node", "tree", "hash", "map", "reader", "writer"};
+    static const char* const extensions[] = {".cpp", ".hpp", ".txt", ".json", ".md"};
+    std::unordered_set<std::string> seen;
+    std::vector<std::string> paths;
+    while (paths.size() < count) {
+        std::string path = "/home/user" + std::to_string(rng() % 200) + "/projects/" + projects[rng() % 10] + "/" +
+                           dirs[rng() % 6] + "/" + modules[rng() % 8] + "/" + words[rng() % 14] + "_" +
+                           words[rng() % 14] + std::to_string(rng() % 20) + extensions[rng() % 5];
+        if (seen.insert(path).second) paths.push_back(path);
+    }
+    return paths;
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    std::mt19937 rng(49);
+    std::vector<std::string> keys = makePaths(count, rng);
+    std::vector<std::string> probes = keys;
+    std::shuffle(probes.begin(), probes.end(), rng);
+    std::vector<std::string> misses;
+    for (std::size_t i = 0; i < count; i += 4) misses.push_back(probes[i] + "~");
+    std::vector<std::string> directories;
+    for (int i = 0; i < 1000; ++i) {
+        const std::string& key = probes[i];
+        directories.push_back(key.substr(0, key.rfind('/') + 1));
+    }
+    const std::size_t fullScans = 5;
+
+    ArtTree<int> art;
+    Dictionary<std::string, int> dict;
+    std::unordered_map<std::string, int> hash;
+    long long sink = 0;
+
+    std::cout << count << " paths, e.g. " << keys[0] << "\n\n"
+              << std::setw(22) << "operation" << std::setw(14) << "ArtTree" << std::setw(14) << "Dictionary"
+              << std::setw(16) << "unordered_map" << "\n";
+    auto row = [](const char* name, double art, double dict, double hash, const char* unit) {
+        std::cout << std::setw(22) << name << std::fixed << std::setprecision(1) << std::setw(14) << art
+                  << std::setw(14) << dict << std::setw(16) << hash << "  " << unit << "\n";
+    };
+
+    double artMs = timeIt([&] {
+        for (std::size_t i = 0; i < count; ++i) art.insert(keys[i], static_cast<int>(i));
+    });
+    double dictMs = timeIt([&] {
+        for (std::size_t i = 0; i < count; ++i) dict.insert(keys[i], static_cast<int>(i));
+    });
+    double hashMs = timeIt([&] {
+        for (std::size_t i = 0; i < count; ++i) hash[keys[i]] = static_cast<int>(i);
+    });
+    row("insert", artMs * 1e6 / count, dictMs * 1e6 / count, hashMs * 1e6 / count, "ns/key");
+
+    artMs = timeIt([&] {
+        for (const std::string& key : probes) sink += art.at(key);
+    });
+    dictMs = timeIt([&] {
+        for (const std::string& key : probes) sink += dict.at(key);
+    });
+    hashMs = timeIt([&] {
+        for (const std::string& key : probes) sink += hash.find(key)->second;
+    });
+    row("lookup, found", artMs * 1e6 / count, dictMs * 1e6 / count, hashMs * 1e6 / count, "ns/key");
+
+    artMs = timeIt([&] {
+        for (const std::string& key : misses) sink += art.contains(key);
+    });
+    dictMs = timeIt([&] {
+        for (const std::string& key : misses) sink += dict.contains(key);
+    });
+    hashMs = timeIt([&] {
+        for (const std::string& key : misses) sink += hash.count(key);
+    });
+    row("lookup, missing", artMs * 1e6 / misses.size(), dictMs * 1e6 / misses.size(), hashMs * 1e6 / misses.size(),
+        "ns/key");
+
+    std::size_t artFound = 0, dictFound = 0, hashFound = 0;
+    artMs = timeIt([&] {
+        for (const std::string& dir : directories)
+            for (const auto& entry : art.prefix(dir)) artFound += entry.second >= 0;
+    });
+    dictMs = timeIt([&] {
+        for (const std::string& dir : directories)
+            for (const auto& entry : dict.prefix(dir)) dictFound += entry.second >= 0;
+    });
+    hashMs = timeIt([&] {
+        for (std::size_t i = 0; i < fullScans; ++i)
+            for (const auto& [key, value] : hash)
+                hashFound += key.compare(0, directories[i].size(), directories[i]) == 0;
+    });
+    row("prefix scan", artMs * 1e3 / directories.size(), dictMs * 1e3 / directories.size(),
+        hashMs * 1e3 / fullScans, "us/scan");
+    std::cout << "(" << artFound / directories.size() << " keys per directory on average, " << dictFound - artFound
+              << " difference; checksum " << sink + static_cast<long long>(hashFound) << ")\n";
+    return 0;
+}
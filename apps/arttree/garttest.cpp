@@ -0,0 +1,201 @@
+//
+// File:   garttest.cpp
+// Author: Your Glorious Instructor
+// Purpose:
+//  Provide unit tests for our ArtTree class
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+#include "arttree.hpp"
+
+// Keys built from a few short pieces, so they share prefixes, some of
+// them long ones, and some keys are the start of others.  A few use bytes
+// 0x00 and 0xff.
+std::vector<std::string> makeKeys(std::mt19937& rng, int count) {
+    static const std::string pieces[] = {"/", "usr", "/usr/share/applications/", "a", "b", "bin",
+                                         "x", "", std::string(1, '\0'), "\xff"};
+    std::vector<std::string> keys;
+    for (int i = 0; i < count; ++i) {
+        std::string key;
+        int parts = static_cast<int>(rng() % 6);
+        for (int p = 0; p < parts; ++p) key += pieces[rng() % 10];
+        if (rng() % 7 == 0) key += std::string(1, '\0');
+        keys.push_back(key);
+    }
+    return keys;
+}
+
+// Check tree against model: the same entries, in the same order.
+void expectSame(const ArtTree<int>& tree, const std::map<std::string, int>& model) {
+    ASSERT_EQ(tree.size(), model.size());
+    auto expected = model.begin();
+    for (const auto& entry : tree) {
+        ASSERT_TRUE(expected != model.end());
+        EXPECT_EQ(entry.first, expected->first);
+        EXPECT_EQ(entry.second, expected->second);
+        ++expected;
+    }
+    EXPECT_TRUE(expected == model.end());
+}
+
+// Test: A new tree is empty
+// Precondition: A default-constructed tree.
+// Postcondition: Size 0, nothing found, begin() == end().
+TEST(ArtTree, Empty) {
+    ArtTree<int> tree;
+    EXPECT_TRUE(tree.empty());
+    EXPECT_FALSE(tree.contains(""));
+    EXPECT_FALSE(tree.find("a").has_value());
+    EXPECT_THROW(tree.at("a"), std::out_of_range);
+    EXPECT_TRUE(tree.begin() == tree.end());
+    EXPECT_TRUE(tree.lower_bound("a") == tree.end());
+    EXPECT_TRUE(tree.prefix("").begin() == tree.end());
+}
+
+// Test: Inserts and lookups agree with std::map
+// Precondition: Thousands of keys with shared prefixes, inserted with
+//               insert, insert_or_assign and try_emplace, some repeated.
+// Postcondition: Same size, same values and the same order as std::map,
+//                and keys that were never inserted aren't found.
+TEST(ArtTree, MatchesMap) {
+    std::mt19937 rng(49);
+    ArtTree<int> tree;
+    std::map<std::string, int> model;
+    std::vector<std::string> keys = makeKeys(rng, 5000);
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        int value = static_cast<int>(i);
+        switch (i % 3) {
+        case 0:
+            tree.insert(keys[i], value);
+            model[keys[i]] = value;
+            break;
+        case 1:
+            EXPECT_EQ(tree.insert_or_assign(keys[i], value), model.count(keys[i]) == 0);
+            model[keys[i]] = value;
+            break;
+        default:
+            EXPECT_EQ(tree.try_emplace(keys[i], value), model.emplace(keys[i], value).second);
+            break;
+        }
+    }
+    expectSame(tree, model);
+    for (const auto& [key, value] : model) EXPECT_EQ(tree.at(key), value);
+    for (const std::string& key : makeKeys(rng, 2000)) {
+        auto found = tree.find(key);
+        auto expected = model.find(key);
+        ASSERT_EQ(found.has_value(), expected != model.end()) << key;
+        if (found) {
+            EXPECT_EQ(found->get(), expected->second);
+        }
+    }
+}
+
+// Test: Every node size is used and searched correctly
+// Precondition: Keys "k" + one byte, for every byte value, added in a
+//               scrambled order so nodes grow 4 -> 16 -> 48 -> 256.
+// Postcondition: After each insert all keys so far are found, and the
+//                order is by unsigned byte.
+TEST(ArtTree, NodeGrowth) {
+    std::vector<int> bytes(256);
+    for (int i = 0; i < 256; ++i) bytes[i] = (i * 77) % 256;
+    ArtTree<int> tree;
+    std::map<std::string, int> model;
+    for (std::size_t i = 0; i < bytes.size(); ++i) {
+        std::string key = "k" + std::string(1, static_cast<char>(bytes[i]));
+        tree.insert(key, bytes[i]);
+        model[key] = bytes[i];
+        for (std::size_t j = 0; j <= i; ++j)
+            EXPECT_EQ(tree.at("k" + std::string(1, static_cast<char>(bytes[j]))), bytes[j]);
+        EXPECT_FALSE(tree.contains("k"));
+    }
+    expectSame(tree, model);
+}
+
+// Test: lower_bound, upper_bound and range agree with std::map
+// Precondition: The random keys, and random probe keys.
+// Postcondition: Each bound starts at the same entry as std::map's, and a
+//                range holds the same entries.
+TEST(ArtTree, Bounds) {
+    std::mt19937 rng(50);
+    ArtTree<int> tree;
+    std::map<std::string, int> model;
+    int i = 0;
+    for (const std::string& key : makeKeys(rng, 3000)) {
+        tree.insert(key, i);
+        model[key] = i++;
+    }
+    std::vector<std::string> probes = makeKeys(rng, 500);
+    probes.push_back("");
+    probes.push_back(std::string(20, '\xff'));
+    for (const std::string& probe : probes) {
+        auto lower = tree.lower_bound(probe);
+        auto expected = model.lower_bound(probe);
+        if (expected == model.end()) {
+            EXPECT_TRUE(lower == tree.end()) << probe;
+        } else {
+            ASSERT_TRUE(lower != tree.end()) << probe;
+            EXPECT_EQ(lower->first, expected->first);
+        }
+        auto upper = tree.upper_bound(probe);
+        auto expectedUpper = model.upper_bound(probe);
+        EXPECT_EQ(upper == tree.end(), expectedUpper == model.end());
+        if (upper != tree.end() && expectedUpper != model.end()) {
+            EXPECT_EQ(upper->first, expectedUpper->first);
+        }
+    }
+    for (int trial = 0; trial < 100; ++trial) {
+        std::string lo = probes[rng() % probes.size()], hi = probes[rng() % probes.size()];
+        auto r = tree.range(lo, hi);
+        std::size_t n = static_cast<std::size_t>(std::distance(r.begin(), r.end()));
+        std::size_t expectedCount = lo < hi ? static_cast<std::size_t>(std::distance(model.lower_bound(lo), model.lower_bound(hi))) : 0;
+        EXPECT_EQ(n, expectedCount) << lo << " " << hi;
+    }
+}
+
+// Test: prefix finds exactly the keys starting with it
+// Precondition: The random keys; prefixes taken from keys, cut short, and
+//               some that match nothing.
+// Postcondition: The same keys, in the same order, as filtering std::map.
+TEST(ArtTree, Prefix) {
+    std::mt19937 rng(51);
+    ArtTree<int> tree;
+    std::map<std::string, int> model;
+    std::vector<std::string> keys = makeKeys(rng, 3000);
+    for (const std::string& key : keys) {
+        tree.insert(key, 1);
+        model[key] = 1;
+    }
+    std::vector<std::string> prefixes = {"", "/", "/usr", "/usr/share/app", "/usr/share/applications/usr", "zzz"};
+    for (int i = 0; i < 300; ++i) {
+        const std::string& key = keys[rng() % keys.size()];
+        prefixes.push_back(key.substr(0, rng() % (key.size() + 1)));
+        prefixes.push_back(key + "q");
+    }
+    for (const std::string& p : prefixes) {
+        std::vector<std::string> found, expected;
+        for (const auto& entry : tree.prefix(p)) found.push_back(entry.first);
+        for (const auto& [key, value] : model)
+            if (key.compare(0, p.size(), p) == 0) expected.push_back(key);
+        EXPECT_EQ(found, expected) << p;
+    }
+}
+
+// Test: Moving a tree hands over its entries
+// Precondition: A tree with a few entries, moved into a new one.
+// Postcondition: The new tree has them and the old one is empty.
+TEST(ArtTree, Move) {
+    ArtTree<std::string> tree;
+    tree.insert("/etc/hosts", "hosts");
+    tree.insert("/etc/passwd", "passwd");
+    const std::string& hosts = tree.at("/etc/hosts");
+    ArtTree<std::string> other(std::move(tree));
+    EXPECT_EQ(other.size(), 2u);
+    EXPECT_EQ(&other.at("/etc/hosts"), &hosts);
+    EXPECT_TRUE(tree.empty());
+    tree = std::move(other);
+    EXPECT_EQ(tree.at("/etc/passwd"), "passwd");
+}
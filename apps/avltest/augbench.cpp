@@ -0,0 +1,107 @@
+//
+// File:   augbench.cpp
+// Author: Your Glorious Instructor
+// Purpose:
+// Compare the augmented trees against a plain linear scan of a vector for
+// interval overlap and range aggregate queries.
+//
+// Usage: augbench [entries] [queries]
+// Defaults to 1M entries and 1000 queries.  Build in Release mode.
+//
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "intervaltree.hpp"
+#include "rangesumtree.hpp"
+
+// Run a function and return how long it took in milliseconds.
+template <typename Func>
+double timeIt(Func f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+void report(const std::string& name, double treeMs, double scanMs) {
+    std::cout << std::setw(18) << name << std::fixed << std::setprecision(2)
+              << std::setw(14) << treeMs << std::setw(14) << scanMs
+              << std::setw(12) << std::setprecision(1) << scanMs / treeMs << "x\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t n = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    std::size_t queries = (argc > 2) ? std::strtoull(argv[2], nullptr, 10) : 1000;
+    const long span = static_cast<long>(n) * 10;
+
+    std::mt19937_64 gen(372);
+    std::uniform_int_distribution<long> startDist(0, span);
+    std::uniform_int_distribution<long> lengthDist(0, 1000);
+    std::uniform_int_distribution<long> valueDist(-1000, 1000);
+
+    IntervalTree<long> intervals;
+    std::vector<Interval<long>> intervalList;
+    RangeSumTree<long, long> sums;
+    std::vector<std::pair<long, long>> sumList;
+    for (std::size_t i = 0; i < n; ++i) {
+        long lo = startDist(gen);
+        Interval<long> iv{ lo, lo + lengthDist(gen) };
+        if (intervals.insert(iv)) intervalList.push_back(iv);
+        long value = valueDist(gen);
+        if (sums.insert(lo, value)) sumList.emplace_back(lo, value);
+    }
+
+    std::vector<std::pair<long, long>> ranges(queries);
+    for (auto& r : ranges) {
+        r.first = startDist(gen);
+        r.second = r.first + lengthDist(gen) * 10;
+    }
+
+    std::cout << n << " entries, " << queries << " queries\n"
+              << std::setw(18) << "query" << std::setw(14) << "tree ms"
+              << std::setw(14) << "scan ms" << std::setw(13) << "speedup\n";
+
+    std::size_t treeHits = 0, scanHits = 0;
+    double t = timeIt([&] {
+        for (auto& r : ranges)
+            intervals.forEachOverlapping(r.first, r.second, [&](const Interval<long>&) { ++treeHits; });
+    });
+    double s = timeIt([&] {
+        for (auto& r : ranges)
+            for (const auto& iv : intervalList)
+                if (iv.overlaps(r.first, r.second)) ++scanHits;
+    });
+    report("interval overlap", t, s);
+    if (treeHits != scanHits) std::cout << "MISMATCH: " << treeHits << " vs " << scanHits << "\n";
+
+    long treeSum = 0, scanSum = 0;
+    t = timeIt([&] {
+        for (auto& r : ranges) {
+            RangeSummary<long> a = sums.aggregate(r.first, r.second);
+            treeSum += a.sum + a.min + a.max;
+        }
+    });
+    s = timeIt([&] {
+        for (auto& r : ranges) {
+            RangeSummary<long> a;
+            for (const auto& e : sumList) {
+                if (e.first < r.first || r.second < e.first) continue;
+                a.min = a.count ? std::min(a.min, e.second) : e.second;
+                a.max = a.count ? std::max(a.max, e.second) : e.second;
+                a.sum += e.second;
+                ++a.count;
+            }
+            scanSum += a.sum + a.min + a.max;
+        }
+    });
+    report("sum/min/max", t, s);
+    if (treeSum != scanSum) std::cout << "MISMATCH: " << treeSum << " vs " << scanSum << "\n";
+
+    std::cout << "(" << treeHits << " overlaps found)\n";
+    return 0;
+}
@@ -0,0 +1,99 @@
+//
+// File:   avlbench.cpp
+// Author: Your Glorious Instructor
+// Purpose:
+// Time our AVLTree, in both storage modes, against std::set for the basic
+// index operations.
+//
+// Usage: avlbench [keys...]
+// Each argument is a number of keys to test with; with no arguments we run
+// 1M and 10M keys.  Build in Release mode or the numbers mean nothing.
+//
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+#include "avltree.hpp"
+
+// Run a function and return how long it took in milliseconds.
+template <typename Func>
+double timeIt(Func f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+void report(const std::string& name, double avlMs, double poolMs, double setMs) {
+    std::cout << std::setw(12) << name << std::fixed << std::setprecision(1)
+              << std::setw(14) << avlMs
+              << std::setw(14) << poolMs
+              << std::setw(14) << setMs << "\n";
+}
+
+// Insert n shuffled keys, look each one up (plus the same number of
+// misses), walk the whole tree in order and finally remove every key.
+void runBenchmark(std::size_t n) {
+    std::vector<long> keys(n);
+    std::iota(keys.begin(), keys.end(), 0L);
+    for (auto& k : keys) k *= 2;                // odd numbers are misses
+    std::mt19937_64 gen(372);
+    std::shuffle(keys.begin(), keys.end(), gen);
+    std::vector<long> probes = keys;
+    std::shuffle(probes.begin(), probes.end(), gen);
+
+    AVLTree<long> avl;
+    PooledAVLTree<long> pool;
+    std::set<long> stdset;
+    std::size_t sink = 0;
+
+    std::cout << "\n" << n << " keys\n"
+              << std::setw(12) << "operation" << std::setw(14) << "AVLTree ms"
+              << std::setw(14) << "pooled ms" << std::setw(14) << "std::set ms\n";
+
+    double a = timeIt([&] { for (long k : keys) avl.insert(k); });
+    double p = timeIt([&] { for (long k : keys) pool.insert(k); });
+    double s = timeIt([&] { for (long k : keys) stdset.insert(k); });
+    report("insert", a, p, s);
+
+    a = timeIt([&] { for (long k : probes) sink += avl.contains(k) + avl.contains(k + 1); });
+    p = timeIt([&] { for (long k : probes) sink += pool.contains(k) + pool.contains(k + 1); });
+    s = timeIt([&] { for (long k : probes) sink += stdset.count(k) + stdset.count(k + 1); });
+    report("lookup", a, p, s);
+
+    a = timeIt([&] { for (long k : avl) sink += k; });
+    p = timeIt([&] { for (long k : pool) sink += k; });
+    s = timeIt([&] { for (long k : stdset) sink += k; });
+    report("iterate", a, p, s);
+
+    // Tear down half of each container by removing keys one at a time and
+    // time dropping the rest in one go.
+    probes.resize(n / 2);
+    a = timeIt([&] { for (long k : probes) avl.remove(k); });
+    p = timeIt([&] { for (long k : probes) pool.remove(k); });
+    s = timeIt([&] { for (long k : probes) stdset.erase(k); });
+    report("remove", a, p, s);
+
+    // The pool goes first: freeing its large chunks makes malloc consolidate
+    // any small blocks freed just before, which would be charged to it.
+    p = timeIt([&] { pool.clear(); });
+    a = timeIt([&] { avl.clear(); });
+    s = timeIt([&] { stdset.clear(); });
+    report("clear", a, p, s);
+
+    std::cout << "(checksum " << sink << ")\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<std::size_t> sizes;
+    for (int i = 1; i < argc; ++i) sizes.push_back(std::strtoull(argv[i], nullptr, 10));
+    if (sizes.empty()) sizes = { 1000000, 10000000 };
+    for (std::size_t n : sizes) runBenchmark(n);
+    return 0;
+}
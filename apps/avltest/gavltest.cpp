@@ -0,0 +1,286 @@
+//
+// File:   gavltest.cpp
+// Author: Your Glorious Instructor
+// Purpose:
+//  Provide unit tests for our AVLTree class
+#include <gtest/gtest.h>
+#include <cmath>
+#include <random>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include "avltree.hpp"
+#include "intervaltree.hpp"
+#include "rangesumtree.hpp"
+
+// Walk the tree with its iterators and collect the keys.
+template <typename Tree>
+std::vector<typename Tree::const_iterator::value_type> keysOf(const Tree& tree) {
+    return { tree.begin(), tree.end() };
+}
+
+// Test: An empty tree has no keys
+// Precondition: An empty tree is created.
+// Postcondition: size() is 0, begin() == end() and nothing is found.
+TEST(AVLTreeBasics, EmptyTree) {
+    AVLTree<int> tree;
+    EXPECT_TRUE(tree.empty());
+    EXPECT_EQ(tree.size(), 0u);
+    EXPECT_TRUE(tree.begin() == tree.end());
+    EXPECT_FALSE(tree.contains(1));
+    EXPECT_TRUE(tree.find(1) == tree.end());
+    EXPECT_TRUE(tree.lower_bound(1) == tree.end());
+}
+
+// Test: Insert keeps the keys sorted and ignores duplicates
+// Precondition: Keys are inserted out of order with a duplicate.
+// Postcondition: Iteration visits each key once, in order.
+TEST(AVLTreeBasics, InsertAndIterate) {
+    AVLTree<int> tree;
+    for (int k : { 10, 20, 30, 40, 50, 25 }) {
+        EXPECT_TRUE(tree.insert(k));
+    }
+    EXPECT_FALSE(tree.insert(30));
+    EXPECT_EQ(tree.size(), 6u);
+    std::vector<int> expected{ 10, 20, 25, 30, 40, 50 };
+    EXPECT_EQ(keysOf(tree), expected);
+}
+
+// Test: Lookup functions find present keys and report absent ones
+// Precondition: A tree holds the even numbers 0..98.
+// Postcondition: find, contains and lower_bound agree with the contents.
+TEST(AVLTreeBasics, Lookup) {
+    AVLTree<int> tree;
+    for (int k = 0; k < 100; k += 2) tree.insert(k);
+
+    EXPECT_TRUE(tree.contains(42));
+    EXPECT_FALSE(tree.contains(43));
+    EXPECT_EQ(*tree.find(42), 42);
+    EXPECT_TRUE(tree.find(43) == tree.end());
+    EXPECT_EQ(*tree.lower_bound(43), 44);
+    EXPECT_EQ(*tree.lower_bound(-5), 0);
+    EXPECT_TRUE(tree.lower_bound(99) == tree.end());
+
+    // Walking on from lower_bound continues in order
+    auto it = tree.lower_bound(95);
+    EXPECT_EQ(*it++, 96);
+    EXPECT_EQ(*it++, 98);
+    EXPECT_TRUE(it == tree.end());
+}
+
+// Test: Remove deletes only the requested key
+// Precondition: A tree has been built with specific values.
+// Postcondition: The removed key is gone and the size drops by one.
+TEST(AVLTreeBasics, Remove) {
+    AVLTree<int> tree;
+    for (int k : { 10, 20, 30, 40, 50, 25 }) tree.insert(k);
+    EXPECT_TRUE(tree.remove(30));
+    EXPECT_FALSE(tree.remove(30));
+    EXPECT_EQ(tree.size(), 5u);
+    std::vector<int> expected{ 10, 20, 25, 40, 50 };
+    EXPECT_EQ(keysOf(tree), expected);
+}
+
+// Test: Keys of other types and custom comparators
+// Precondition: A tree of strings ordered by std::greater.
+// Postcondition: Iteration visits the strings in descending order.
+TEST(AVLTreeBasics, StringsWithComparator) {
+    AVLTree<std::string, std::greater<std::string>> tree;
+    for (const char* s : { "pear", "apple", "fig", "banana" }) tree.insert(s);
+    std::vector<std::string> expected{ "pear", "fig", "banana", "apple" };
+    EXPECT_EQ(keysOf(tree), expected);
+    EXPECT_TRUE(tree.contains("fig"));
+    EXPECT_FALSE(tree.contains("kiwi"));
+}
+
+// Test: Copies are deep and moves leave the source empty
+// Precondition: A tree has been built with specific values.
+// Postcondition: Changing the copy does not change the original.
+TEST(AVLTreeBasics, CopyAndMove) {
+    AVLTree<int> original;
+    for (int k = 1; k <= 5; ++k) original.insert(k);
+
+    AVLTree<int> copy = original;
+    copy.remove(3);
+    EXPECT_TRUE(original.contains(3));
+    EXPECT_EQ(original.size(), 5u);
+    EXPECT_EQ(copy.size(), 4u);
+
+    AVLTree<int> moved = std::move(copy);
+    EXPECT_EQ(moved.size(), 4u);
+    EXPECT_TRUE(copy.empty());
+
+    copy = moved;
+    EXPECT_EQ(copy.size(), 4u);
+}
+
+// Test: Random inserts and removes match std::set
+// Precondition: The same random operations are applied to both containers.
+// Postcondition: Both hold the same keys in the same order.
+TEST(AVLTreeStress, MatchesStdSet) {
+    std::mt19937 gen(372);
+    std::uniform_int_distribution<int> dist(0, 2000);
+    AVLTree<int> tree;
+    std::set<int> reference;
+    for (int i = 0; i < 20000; ++i) {
+        int k = dist(gen);
+        if (i % 3 == 2) {
+            EXPECT_EQ(tree.remove(k), reference.erase(k) == 1);
+        } else {
+            EXPECT_EQ(tree.insert(k), reference.insert(k).second);
+        }
+    }
+    EXPECT_TRUE(tree.isValid());
+    EXPECT_EQ(tree.size(), reference.size());
+    EXPECT_EQ(keysOf(tree), std::vector<int>(reference.begin(), reference.end()));
+}
+
+// Test: Sorted input, the worst case for an unbalanced tree, stays balanced
+// Precondition: 100000 keys are inserted in increasing order, then half are removed.
+// Postcondition: The tree is valid and its height stays within the AVL bound.
+TEST(AVLTreeStress, SortedInsertStaysBalanced) {
+    AVLTree<int> tree;
+    const int n = 100000;
+    for (int k = 0; k < n; ++k) tree.insert(k);
+    EXPECT_TRUE(tree.isValid());
+    EXPECT_LE(tree.height(), 1.45 * std::log2(n + 2.0));
+
+    for (int k = 0; k < n; k += 2) tree.remove(k);
+    EXPECT_TRUE(tree.isValid());
+    EXPECT_EQ(tree.size(), static_cast<std::size_t>(n / 2));
+    EXPECT_LE(tree.height(), 1.45 * std::log2(n / 2 + 2.0));
+}
+
+// Test: The pooled storage mode behaves exactly like the default one
+// Precondition: The same random operations are applied to a PooledAVLTree
+// and a std::set, with enough keys to need several pool chunks.
+// Postcondition: Both hold the same keys in the same order, and copies and
+// clearing work on the pool.
+TEST(AVLTreePool, MatchesStdSet) {
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> dist(0, 50000);
+    PooledAVLTree<int> tree;
+    std::set<int> reference;
+    for (int i = 0; i < 60000; ++i) {
+        int k = dist(gen);
+        if (i % 4 == 3) {
+            EXPECT_EQ(tree.remove(k), reference.erase(k) == 1);
+        } else {
+            EXPECT_EQ(tree.insert(k), reference.insert(k).second);
+        }
+    }
+    EXPECT_TRUE(tree.isValid());
+    EXPECT_EQ(tree.size(), reference.size());
+    EXPECT_EQ(keysOf(tree), std::vector<int>(reference.begin(), reference.end()));
+
+    PooledAVLTree<int> copy = tree;
+    tree.clear();
+    EXPECT_TRUE(tree.empty());
+    EXPECT_EQ(keysOf(copy), std::vector<int>(reference.begin(), reference.end()));
+    tree.insert(7);
+    EXPECT_EQ(keysOf(tree), std::vector<int>{ 7 });
+}
+
+// Test: The pool runs destructors for keys that need them
+// Precondition: A PooledAVLTree of strings has keys inserted and removed.
+// Postcondition: Lookups still work and the tree tears down cleanly.
+TEST(AVLTreePool, StringKeys) {
+    PooledAVLTree<std::string> tree;
+    for (int i = 0; i < 5000; ++i) tree.insert("key-" + std::to_string(i));
+    for (int i = 0; i < 5000; i += 3) tree.remove("key-" + std::to_string(i));
+    EXPECT_TRUE(tree.contains("key-1"));
+    EXPECT_FALSE(tree.contains("key-3"));
+    EXPECT_EQ(tree.size(), 5000u - 1667u);
+    EXPECT_TRUE(tree.isValid());
+}
+
+// Test: Interval queries return exactly the overlapping intervals
+// Precondition: Random intervals are inserted and some removed.
+// Postcondition: Every query agrees with a brute-force scan of a vector.
+TEST(AVLTreeAugmented, IntervalTreeMatchesScan) {
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<int> start(0, 10000);
+    std::uniform_int_distribution<int> length(0, 300);
+    IntervalTree<int> tree;
+    std::set<Interval<int>> reference;
+    for (int i = 0; i < 5000; ++i) {
+        int lo = start(gen);
+        Interval<int> iv{ lo, lo + length(gen) };
+        if (i % 5 == 4 && !reference.empty()) {
+            Interval<int> victim = *reference.begin();
+            EXPECT_TRUE(tree.remove(victim.lo, victim.hi));
+            reference.erase(victim);
+        }
+        EXPECT_EQ(tree.insert(iv), reference.insert(iv).second);
+    }
+    EXPECT_TRUE(tree.isValid());
+
+    for (int q = 0; q < 200; ++q) {
+        int qlo = start(gen);
+        int qhi = qlo + length(gen) / 4;
+        std::vector<Interval<int>> expected;
+        for (const auto& iv : reference)
+            if (iv.overlaps(qlo, qhi)) expected.push_back(iv);
+        EXPECT_EQ(tree.overlapping(qlo, qhi), expected);
+    }
+}
+
+// Test: Stabbing queries on a small hand-built tree
+// Precondition: A few intervals with known overlaps are inserted.
+// Postcondition: Each point finds the intervals that contain it.
+TEST(AVLTreeAugmented, IntervalStabbing) {
+    IntervalTree<int, AVLNodePool> tree;
+    tree.insert(1, 5);
+    tree.insert(3, 8);
+    tree.insert(10, 12);
+    tree.insert(6, 6);
+    std::vector<Interval<int>> at4{ { 1, 5 }, { 3, 8 } };
+    std::vector<Interval<int>> at6{ { 3, 8 }, { 6, 6 } };
+    EXPECT_EQ(tree.stabbing(4), at4);
+    EXPECT_EQ(tree.stabbing(6), at6);
+    EXPECT_TRUE(tree.stabbing(9).empty());
+    EXPECT_EQ(tree.stabbing(12).size(), 1u);
+}
+
+// Test: Range aggregates agree with a brute-force scan
+// Precondition: Random key/value pairs are inserted and some removed.
+// Postcondition: count, sum, min and max over random ranges all match.
+TEST(AVLTreeAugmented, RangeSumMatchesScan) {
+    std::mt19937 gen(11);
+    std::uniform_int_distribution<int> keyDist(0, 20000);
+    std::uniform_int_distribution<long> valueDist(-1000, 1000);
+    RangeSumTree<int, long> tree;
+    std::map<int, long> reference;
+    for (int i = 0; i < 8000; ++i) {
+        int k = keyDist(gen);
+        if (i % 4 == 3) {
+            EXPECT_EQ(tree.remove(k), reference.erase(k) == 1);
+        } else {
+            long v = valueDist(gen);
+            EXPECT_EQ(tree.insert(k, v), reference.emplace(k, v).second);
+        }
+    }
+    EXPECT_TRUE(tree.isValid());
+
+    for (int q = 0; q < 300; ++q) {
+        int lo = keyDist(gen);
+        int hi = lo + keyDist(gen) / 8;
+        RangeSummary<long> expected;
+        for (auto it = reference.lower_bound(lo); it != reference.end() && it->first <= hi; ++it) {
+            expected.min = expected.count ? std::min(expected.min, it->second) : it->second;
+            expected.max = expected.count ? std::max(expected.max, it->second) : it->second;
+            expected.sum += it->second;
+            ++expected.count;
+        }
+        RangeSummary<long> actual = tree.aggregate(lo, hi);
+        EXPECT_EQ(actual.count, expected.count);
+        EXPECT_EQ(actual.sum, expected.sum);
+        EXPECT_EQ(actual.min, expected.min);
+        EXPECT_EQ(actual.max, expected.max);
+
+        std::size_t visited = 0;
+        tree.forEachInRange(lo, hi, [&](int, long) { ++visited; });
+        EXPECT_EQ(visited, expected.count);
+    }
+}
@@ -0,0 +1,118 @@
+//
+// File:   btreebench.cpp
+// Author: Your Glorious Instructor
+// Purpose:
+// Time BTree at a few node sizes against TwoThreeTree, AVLTree and
+// std::set.
+//
+// Usage: btreebench [keys...]
+// Each argument is a number of keys to test with; with no arguments we run
+// 10M keys.  Build in Release mode or the numbers mean nothing.
+//
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+#include "avltree.hpp"
+#include "btree.hpp"
+#include "two_three_tree.hpp"
+
+// Run a function and return how long it took in milliseconds.
+template <typename Func>
+double timeIt(Func f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+struct Keys {
+    std::vector<long> inserts;   // even numbers, shuffled
+    std::vector<long> probes;    // the same keys in another order
+};
+
+void report(const std::string& name, double insertMs, double lookupMs, double eraseMs) {
+    std::cout << std::setw(16) << name << std::fixed << std::setprecision(1)
+              << std::setw(12) << insertMs << std::setw(12) << lookupMs
+              << std::setw(12) << eraseMs << "\n";
+}
+
+// Insert every key, look each one up along with a miss, then erase half.
+// Each container is built and torn down on its own so they don't compete
+// for memory.
+template <typename Container, typename Insert, typename Contains, typename Erase>
+void runOne(const std::string& name, const Keys& keys, Insert insert, Contains contains,
+            Erase erase, std::size_t& sink) {
+    Container c;
+    double ins = timeIt([&] { for (long k : keys.inserts) insert(c, k); });
+    double look = timeIt([&] {
+        for (long k : keys.probes) sink += contains(c, k) + contains(c, k + 1);
+    });
+    double del = timeIt([&] {
+        for (std::size_t i = 0; i < keys.probes.size() / 2; ++i) erase(c, keys.probes[i]);
+    });
+    report(name, ins, look, del);
+}
+
+template <int Order>
+void runBTree(const Keys& keys, std::size_t& sink) {
+    runOne<BTree<long, Order>>(
+        "BTree<" + std::to_string(Order) + ">", keys,
+        [](auto& t, long k) { t.insert(k); },
+        [](const auto& t, long k) { return t.contains(k); },
+        [](auto& t, long k) { t.erase(k); }, sink);
+}
+
+void runBenchmark(std::size_t n) {
+    Keys keys;
+    keys.inserts.resize(n);
+    std::iota(keys.inserts.begin(), keys.inserts.end(), 0L);
+    for (auto& k : keys.inserts) k *= 2;        // odd numbers are misses
+    std::mt19937_64 gen(372);
+    std::shuffle(keys.inserts.begin(), keys.inserts.end(), gen);
+    keys.probes = keys.inserts;
+    std::shuffle(keys.probes.begin(), keys.probes.end(), gen);
+    std::size_t sink = 0;
+
+    std::cout << "\n" << n << " keys (erase removes half of them)\n"
+              << std::setw(16) << "container" << std::setw(12) << "insert ms"
+              << std::setw(12) << "lookup ms" << std::setw(12) << "erase ms" << "\n";
+
+    runBTree<16>(keys, sink);
+    runBTree<32>(keys, sink);
+    runBTree<64>(keys, sink);
+    runBTree<128>(keys, sink);
+
+    runOne<TwoThreeTree<long>>(
+        "TwoThreeTree", keys,
+        [](auto& t, long k) { t.insert(k); },
+        [](const auto& t, long k) { return t.search(k).has_value(); },
+        [](auto& t, long k) { t.erase(k); }, sink);
+
+    runOne<AVLTree<long>>(
+        "AVLTree", keys,
+        [](auto& t, long k) { t.insert(k); },
+        [](const auto& t, long k) { return t.contains(k); },
+        [](auto& t, long k) { t.remove(k); }, sink);
+    runOne<std::set<long>>(
+        "std::set", keys,
+        [](auto& t, long k) { t.insert(k); },
+        [](const auto& t, long k) { return t.count(k) == 1; },
+        [](auto& t, long k) { t.erase(k); }, sink);
+
+    std::cout << "(checksum " << sink << ")\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<std::size_t> sizes;
+    for (int i = 1; i < argc; ++i) sizes.push_back(std::strtoull(argv[i], nullptr, 10));
+    if (sizes.empty()) sizes = { 10000000 };
+    for (std::size_t n : sizes) runBenchmark(n);
+    return 0;
+}
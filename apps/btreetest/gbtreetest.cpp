@@ -0,0 +1,254 @@
+//
+// File:   gbtreetest.cpp
+// Author: Your Glorious Instructor
+// Purpose:
+//  Provide unit tests for our BTree and BPlusTree classes
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+#include "bplustree.hpp"
+#include "btree.hpp"
+
+template <typename Tree>
+std::vector<typename std::decay<decltype(*Tree().search(0))>::type> keysOf(const Tree& tree) {
+    std::vector<typename std::decay<decltype(*Tree().search(0))>::type> keys;
+    tree.forEach([&keys](const auto& k) { keys.push_back(k); });
+    return keys;
+}
+
+// Test: An empty tree has no keys
+// Precondition: An empty tree is created.
+// Postcondition: size() is 0, height() is 0 and nothing is found.
+TEST(BTreeBasics, EmptyTree) {
+    BTree<int> tree;
+    EXPECT_TRUE(tree.empty());
+    EXPECT_EQ(tree.size(), 0u);
+    EXPECT_EQ(tree.height(), 0);
+    EXPECT_FALSE(tree.contains(1));
+    EXPECT_FALSE(tree.search(1).has_value());
+    EXPECT_FALSE(tree.erase(1));
+    EXPECT_TRUE(tree.isValid());
+}
+
+// Test: Insert keeps keys sorted, ignores duplicates and splits nodes
+// Precondition: A small-order tree gets enough keys to grow several levels.
+// Postcondition: All keys are found once, in order, and the tree is valid.
+TEST(BTreeBasics, InsertSplitsAndStaysSorted) {
+    BTree<int, 4> tree;
+    for (int k : { 10, 20, 30, 5, 15, 25, 35, 40, 1, 12 }) EXPECT_TRUE(tree.insert(k));
+    EXPECT_FALSE(tree.insert(25));
+    EXPECT_EQ(tree.size(), 10u);
+    EXPECT_GE(tree.height(), 2);
+    EXPECT_TRUE(tree.isValid());
+    EXPECT_EQ(keysOf(tree), (std::vector<int>{ 1, 5, 10, 12, 15, 20, 25, 30, 35, 40 }));
+    EXPECT_EQ(tree.search(15).value(), 15);
+    EXPECT_FALSE(tree.contains(16));
+}
+
+// Test: Erase covers leaves, internal keys, borrowing and merging
+// Precondition: A small-order tree holds 1..200.
+// Postcondition: Each erase removes exactly one key and leaves a valid tree.
+TEST(BTreeBasics, EraseKeepsTreeBalanced) {
+    BTree<int, 4> tree;
+    for (int k = 1; k <= 200; ++k) tree.insert(k);
+    for (int k = 2; k <= 200; k += 2) {
+        EXPECT_TRUE(tree.erase(k));
+        EXPECT_FALSE(tree.contains(k));
+        ASSERT_TRUE(tree.isValid()) << "after erasing " << k;
+    }
+    EXPECT_FALSE(tree.erase(2));
+    EXPECT_EQ(tree.size(), 100u);
+    for (int k = 199; k >= 1; k -= 2) {
+        EXPECT_TRUE(tree.erase(k));
+        ASSERT_TRUE(tree.isValid()) << "after erasing " << k;
+    }
+    EXPECT_TRUE(tree.empty());
+    EXPECT_EQ(tree.height(), 0);
+    EXPECT_TRUE(tree.insert(7));
+    EXPECT_TRUE(tree.contains(7));
+}
+
+// Test: Non-int keys and a custom ordering
+// Precondition: Strings are stored in descending order.
+// Postcondition: Iteration follows the comparator.
+TEST(BTreeBasics, CustomCompare) {
+    BTree<std::string, 6, std::greater<std::string>> tree;
+    for (const char* w : { "pear", "apple", "fig", "kiwi", "plum", "date", "lime" }) tree.insert(w);
+    std::vector<std::string> words;
+    tree.forEach([&words](const std::string& w) { words.push_back(w); });
+    EXPECT_EQ(words, (std::vector<std::string>{ "plum", "pear", "lime", "kiwi", "fig", "date", "apple" }));
+    EXPECT_TRUE(tree.erase("kiwi"));
+    EXPECT_FALSE(tree.contains("kiwi"));
+    EXPECT_TRUE(tree.isValid());
+}
+
+// Test: Random inserts and erases match std::set
+// Precondition: Trees of several orders see the same random operations as
+//               a std::set.
+// Postcondition: Contents, sizes and return values always agree.
+template <int Order>
+void checkAgainstSet() {
+    BTree<int, Order> tree;
+    std::set<int> expected;
+    std::mt19937 gen(Order);
+    std::uniform_int_distribution<int> keyDist(0, 5000);
+    for (int i = 0; i < 40000; ++i) {
+        int k = keyDist(gen);
+        if (gen() % 3 == 0) {
+            ASSERT_EQ(tree.erase(k), expected.erase(k) == 1);
+        } else {
+            ASSERT_EQ(tree.insert(k), expected.insert(k).second);
+        }
+    }
+    EXPECT_EQ(tree.size(), expected.size());
+    EXPECT_TRUE(tree.isValid());
+    EXPECT_EQ(keysOf(tree), std::vector<int>(expected.begin(), expected.end()));
+}
+
+TEST(BTreeStress, MatchesStdSet) {
+    checkAgainstSet<4>();
+    checkAgainstSet<8>();
+    checkAgainstSet<32>();
+    checkAgainstSet<64>();
+}
+
+// Test: Moving a tree hands over its nodes
+// Precondition: A tree with keys is moved into another.
+// Postcondition: The target has the keys and the source is empty.
+TEST(BTreeBasics, Move) {
+    BTree<int> a;
+    for (int k = 0; k < 1000; ++k) a.insert(k);
+    BTree<int> b(std::move(a));
+    EXPECT_EQ(b.size(), 1000u);
+    EXPECT_TRUE(b.contains(999));
+    EXPECT_TRUE(a.empty());
+    a = std::move(b);
+    EXPECT_EQ(a.size(), 1000u);
+}
+
+// Collect a B+tree's entries by walking its leaves.
+template <typename Tree>
+std::vector<std::pair<int, std::string>> entriesOf(const Tree& tree) {
+    std::vector<std::pair<int, std::string>> entries;
+    for (auto it = tree.begin(); it != tree.end(); ++it) entries.emplace_back(it.key(), it.value());
+    return entries;
+}
+
+// Test: Inserting into a B+tree keeps every entry in the leaf chain
+// Precondition: A small-order tree gets keys in a scrambled order and one
+//               key twice.
+// Postcondition: The leaves hold every entry once, in key order, and the
+//                repeated key has its newer value.
+TEST(BPlusTreeBasics, InsertFindAndIterate) {
+    BPlusTree<int, std::string, 4> tree;
+    EXPECT_TRUE(tree.begin() == tree.end());
+    EXPECT_FALSE(tree.contains(3));
+    for (int i = 0; i < 100; ++i) {
+        int k = (i * 37) % 100;
+        EXPECT_TRUE(tree.insert(k, "v" + std::to_string(k)));
+    }
+    EXPECT_FALSE(tree.insert(42, "answer"));
+    EXPECT_EQ(tree.size(), 100u);
+    EXPECT_TRUE(tree.isValid());
+    EXPECT_GE(tree.height(), 3);
+
+    auto entries = entriesOf(tree);
+    ASSERT_EQ(entries.size(), 100u);
+    for (int k = 0; k < 100; ++k) EXPECT_EQ(entries[k].first, k);
+    EXPECT_EQ(*tree.find(42), "answer");
+    EXPECT_EQ(*tree.find(7), "v7");
+    EXPECT_EQ(tree.find(100), nullptr);
+}
+
+// Test: Range scans and lower_bound
+// Precondition: A tree holds the even keys 0..998.
+// Postcondition: range(lo, hi) gives the keys in [lo, hi), in order.
+TEST(BPlusTreeBasics, RangeScan) {
+    BPlusTree<int, int, 8> tree;
+    for (int k = 998; k >= 0; k -= 2) tree.insert(k, k * 10);
+
+    std::vector<int> keys;
+    for (auto [k, v] : tree.range(101, 120)) {
+        keys.push_back(k);
+        EXPECT_EQ(v, k * 10);
+    }
+    EXPECT_EQ(keys, (std::vector<int>{ 102, 104, 106, 108, 110, 112, 114, 116, 118 }));
+    EXPECT_TRUE(tree.range(120, 120).empty());
+    EXPECT_TRUE(tree.range(130, 110).empty());
+    EXPECT_TRUE(tree.range(2000, 3000).empty());
+
+    keys.clear();
+    for (auto [k, v] : tree.range(-50, 5)) keys.push_back(k);
+    EXPECT_EQ(keys, (std::vector<int>{ 0, 2, 4 }));
+
+    EXPECT_EQ(tree.lower_bound(501).key(), 502);
+    EXPECT_EQ(tree.lower_bound(500).key(), 500);
+    EXPECT_TRUE(tree.lower_bound(999) == tree.end());
+}
+
+// Test: Bulk loading packs the leaves to the fill factor
+// Precondition: Sorted entries are bulk loaded at several fill factors,
+//               and the loaded trees are then inserted into.
+// Postcondition: The trees are valid, hold the same entries, and the
+//                leaves are about as full as asked.
+TEST(BPlusTreeBasics, BulkLoad) {
+    std::vector<std::pair<int, int>> sorted;
+    for (int k = 0; k < 10000; ++k) sorted.emplace_back(k * 3, k);
+
+    for (double fill : { 1.0, 0.75, 0.5 }) {
+        BPlusTree<int, int, 64> tree;
+        tree.bulk_load(sorted.begin(), sorted.end(), fill);
+        EXPECT_TRUE(tree.isValid()) << "fill " << fill;
+        EXPECT_EQ(tree.size(), sorted.size());
+        EXPECT_NEAR(tree.leafStats().second, fill, 0.02);
+        EXPECT_EQ(*tree.find(2997), 999);
+        EXPECT_TRUE(std::equal(tree.begin(), tree.end(), sorted.begin(),
+                               [](auto lhs, const auto& rhs) { return lhs.first == rhs.first && lhs.second == rhs.second; }));
+
+        for (int k = 1; k < 30000; k += 3) tree.insert(k, -k);
+        EXPECT_TRUE(tree.isValid());
+        EXPECT_EQ(tree.size(), 20000u);
+    }
+
+    // Small inputs, including ones that leave a short last leaf
+    for (int n : { 0, 1, 2, 3, 4, 5, 7, 64, 65, 127 }) {
+        BPlusTree<int, int, 4> tree;
+        tree.bulk_load(sorted.begin(), sorted.begin() + n, 0.5);
+        EXPECT_TRUE(tree.isValid()) << n << " entries";
+        EXPECT_EQ(tree.size(), static_cast<std::size_t>(n));
+    }
+
+    // Unsorted input is refused
+    std::vector<std::pair<int, int>> unsorted{ { 1, 1 }, { 3, 3 }, { 2, 2 } };
+    BPlusTree<int, int> tree;
+    EXPECT_THROW(tree.bulk_load(unsorted.begin(), unsorted.end()), std::invalid_argument);
+    EXPECT_TRUE(tree.empty());
+}
+
+// Test: Random inserts match std::map
+// Precondition: A tree and a std::map see the same random inserts.
+// Postcondition: Both hold the same entries in the same order.
+TEST(BPlusTreeStress, MatchesStdMap) {
+    BPlusTree<int, int, 6> tree;
+    std::map<int, int> expected;
+    std::mt19937 gen(36);
+    for (int i = 0; i < 30000; ++i) {
+        int k = static_cast<int>(gen() % 10000);
+        ASSERT_EQ(tree.insert(k, i), expected.find(k) == expected.end());
+        expected[k] = i;
+    }
+    EXPECT_TRUE(tree.isValid());
+    auto it = tree.begin();
+    for (const auto& [k, v] : expected) {
+        ASSERT_TRUE(it != tree.end());
+        EXPECT_EQ(it.key(), k);
+        EXPECT_EQ(it.value(), v);
+        ++it;
+    }
+    EXPECT_TRUE(it == tree.end());
+}
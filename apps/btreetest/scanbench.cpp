@@ -0,0 +1,96 @@
+//
+// File:   scanbench.cpp
+// Author: Your Glorious Instructor
+// Purpose:
+// Time the reporting-style access pattern on BPlusTree against std::map:
+// build an index, scan all of it in order, and run many short range scans.
+//
+// Usage: scanbench [keys]      (default 10,000,000)
+// Build in Release mode or the numbers mean nothing.
+//
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "bplustree.hpp"
+
+// Run a function and return how long it took in milliseconds.
+template <typename Func>
+double timeIt(Func f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+void report(const std::string& name, double buildMs, double scanMs, double rangeMs) {
+    std::cout << std::setw(22) << name << std::fixed << std::setprecision(1)
+              << std::setw(12) << buildMs << std::setw(12) << scanMs
+              << std::setw(12) << rangeMs << "\n";
+}
+
+int main(int argc, char* argv[]) {
+    long n = (argc > 1) ? std::atol(argv[1]) : 10000000;
+    const int Queries = 10000;
+    const long Width = 1000;   // keys per range query
+
+    std::vector<std::pair<long, long>> sorted(n);
+    for (long i = 0; i < n; ++i) sorted[i] = { i * 2, i };
+    std::vector<long> shuffled(n);
+    for (long i = 0; i < n; ++i) shuffled[i] = i * 2;
+    std::mt19937_64 gen(372);
+    std::shuffle(shuffled.begin(), shuffled.end(), gen);
+    std::vector<long> starts(Queries);
+    for (auto& s : starts) s = static_cast<long>(gen() % (2 * n));
+
+    long sink = 0;
+    std::cout << n << " entries; " << Queries << " range scans of " << Width / 2 << " entries\n"
+              << std::setw(22) << "index" << std::setw(12) << "build ms"
+              << std::setw(12) << "scan ms" << std::setw(12) << "ranges ms" << "\n";
+
+    auto measure = [&](const std::string& name, double buildMs, const auto& index) {
+        double scan = timeIt([&] { for (auto [k, v] : index) sink += v; });
+        double ranges = timeIt([&] {
+            for (long lo : starts)
+                for (auto [k, v] : index.range(lo, lo + Width)) sink += v;
+        });
+        report(name, buildMs, scan, ranges);
+    };
+
+    for (double fill : { 1.0, 0.7 }) {
+        BPlusTree<long, long> tree;
+        double build = timeIt([&] { tree.bulk_load(sorted.begin(), sorted.end(), fill); });
+        measure("B+tree bulk load " + std::to_string(fill).substr(0, 3), build, tree);
+    }
+    {
+        BPlusTree<long, long> tree;
+        double build = timeIt([&] { for (long k : shuffled) tree.insert(k, k / 2); });
+        measure("B+tree inserts", build, tree);
+        std::cout << std::setw(22) << "" << "  (leaves " << std::setprecision(0)
+                  << tree.leafStats().second * 100 << "% full)\n";
+    }
+
+    // std::map has no range(), so give it one with the same meaning.
+    struct MapIndex {
+        std::map<long, long> map;
+        auto begin() const { return map.begin(); }
+        auto end() const { return map.end(); }
+        struct Range {
+            std::map<long, long>::const_iterator b, e;
+            auto begin() const { return b; }
+            auto end() const { return e; }
+        };
+        Range range(long lo, long hi) const { return { map.lower_bound(lo), map.lower_bound(hi) }; }
+    } index;
+    double build = timeIt([&] { for (long k : shuffled) index.map.emplace(k, k / 2); });
+    measure("std::map", build, index);
+
+    std::cout << "(checksum " << sink << ")\n";
+    return 0;
+}
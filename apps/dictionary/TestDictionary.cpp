@@ -1,9 +1,18 @@
 #include <vector>
 #include <string>
 #include <exception>
+#include <thread>
+#include <atomic>
+#include <string_view>
+#include <cstdint>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
 #include <gtest/gtest.h>
 #include "Pair.hpp"
 #include "Dictionary.hpp"
+#include "DictionaryFile.hpp"
+#include "CountAllocations.hpp"
 
 // TEST: Confirm default constructor behaves correctly
 
@@ -79,3 +88,275 @@ TEST(DictUnitTests, InsertDuplicateKeyDoesNotIncreaseSize) {
     // Depending on Tree, value may or may not update; check if value is updated
     EXPECT_EQ(dict.at(1), "uno");
 }
+
+// TEST: A snapshot keeps the version it was taken from
+TEST(DictUnitTests, SnapshotIsUnaffectedByLaterWrites) {
+    Dictionary<int, std::string> dict;
+    dict.insert(1, "one");
+    auto before = dict.snapshot();
+    dict.insert(1, "uno");
+    dict.insert(2, "two");
+    EXPECT_EQ(before.size(), 1);
+    EXPECT_EQ(before.at(1), "one");
+    EXPECT_THROW(before.at(2), std::out_of_range);
+    EXPECT_EQ(dict.snapshot().at(1), "uno");
+    EXPECT_EQ(dict.snapshot().size(), 2);
+    EXPECT_TRUE((Dictionary<int, std::string>().snapshot().empty()));
+}
+
+// TEST: Readers on other threads always see a whole version
+// The writer adds keys 0, 1, 2, ... in order, so a consistent snapshot of
+// size n holds exactly the keys 0 to n-1, each with value 2*key.
+TEST(DictUnitTests, SnapshotsFromOtherThreads) {
+    const int count = 2000;
+    Dictionary<int, int> dict;
+    std::atomic<bool> done{false};
+    std::atomic<int> bad{0};
+    auto read = [&] {
+        while (!done) {
+            auto view = dict.snapshot();
+            int n = static_cast<int>(view.size());
+            for (int key = 0; key < n; key += 97) {
+                if (view.at(key) != 2 * key) ++bad;
+            }
+            if (n > 0 && view.at(n - 1) != 2 * (n - 1)) ++bad;
+            try {
+                view.at(n);
+                ++bad;
+            } catch (const std::out_of_range&) {
+            }
+        }
+    };
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 3; ++i) readers.emplace_back(read);
+    for (int key = 0; key < count; ++key) dict.insert(key, 2 * key);
+    done = true;
+    for (auto& reader : readers) reader.join();
+    EXPECT_EQ(bad, 0);
+    EXPECT_EQ(dict.snapshot().size(), count);
+}
+
+// TEST: string keys can be looked up by string_view or literal, without allocating
+TEST(DictUnitTests, HeterogeneousLookupDoesNotAllocate) {
+    Dictionary<std::string, std::string> dict;
+    dict.insert("/usr/local/share/applications/a-long-file-name.desktop", "a");
+    dict.insert("/usr/local/share/applications/another-long-name.desktop", "b");
+    std::string_view key = "/usr/local/share/applications/another-long-name.desktop";
+    AllocationCounter counter;
+    EXPECT_EQ(dict.at(key), "b");
+    EXPECT_EQ(dict[key], "b");
+    EXPECT_TRUE(dict.contains(key));
+    EXPECT_FALSE(dict.contains(std::string_view("/usr/local/share/applications/missing.desktop")));
+    EXPECT_TRUE(dict.find("/usr/local/share/applications/a-long-file-name.desktop").has_value());
+    EXPECT_EQ(counter.count(), 0);
+}
+
+// TEST: find() returns a reference to the stored value, or nothing
+TEST(DictUnitTests, FindReturnsOptionalReference) {
+    Dictionary<int, std::string> dict;
+    dict.insert(7, "seven");
+    auto found = dict.find(7);
+    ASSERT_TRUE(found.has_value());
+    EXPECT_EQ(found->get(), "seven");
+    EXPECT_EQ(&found->get(), &dict.at(7));
+    EXPECT_FALSE(dict.find(8).has_value());
+    EXPECT_TRUE(dict.contains(7));
+    EXPECT_FALSE(dict.contains(8));
+}
+
+// TEST: insert_or_assign overwrites, try_emplace doesn't
+TEST(DictUnitTests, InsertOrAssignAndTryEmplace) {
+    Dictionary<int, std::string> dict;
+    EXPECT_TRUE(dict.insert_or_assign(1, "one"));
+    EXPECT_FALSE(dict.insert_or_assign(1, "uno"));
+    EXPECT_EQ(dict.at(1), "uno");
+    EXPECT_FALSE(dict.try_emplace(1, "ein"));
+    EXPECT_EQ(dict.at(1), "uno");
+    EXPECT_TRUE(dict.try_emplace(2, 3, 'x'));
+    EXPECT_EQ(dict.at(2), "xxx");
+    EXPECT_EQ(dict.size(), 2);
+}
+
+// TEST: a non-transparent comparator still works, converting the key
+TEST(DictUnitTests, CustomComparator) {
+    Dictionary<std::string, int, std::greater<std::string>> dict;
+    dict.insert("a", 1);
+    dict.insert("b", 2);
+    EXPECT_EQ(dict.at("a"), 1);
+    EXPECT_EQ(dict.at(std::string("b")), 2);
+    EXPECT_FALSE(dict.contains("c"));
+    EXPECT_EQ(dict.snapshot().size(), 2);
+}
+
+// TEST: iterating visits every entry in key order
+TEST(DictUnitTests, IteratesInKeyOrder) {
+    Dictionary<int, std::string> dict;
+    for (int key : {5, 1, 9, 3, 7}) dict.insert(key, std::to_string(key * 10));
+    std::vector<int> keys;
+    for (const auto& entry : dict) {
+        keys.push_back(entry.first);
+        EXPECT_EQ(entry.second, std::to_string(entry.first * 10));
+    }
+    EXPECT_EQ(keys, (std::vector<int>{1, 3, 5, 7, 9}));
+    Dictionary<int, int> empty;
+    EXPECT_TRUE(empty.begin() == empty.end());
+}
+
+// TEST: lower_bound, upper_bound and range pick out the right entries
+TEST(DictUnitTests, BoundsAndRanges) {
+    Dictionary<int, int> dict;
+    for (int key = 0; key < 100; key += 10) dict.insert(key, key);
+    EXPECT_EQ(dict.lower_bound(30)->first, 30);
+    EXPECT_EQ(dict.lower_bound(31)->first, 40);
+    EXPECT_EQ(dict.upper_bound(30)->first, 40);
+    EXPECT_TRUE(dict.lower_bound(91) == dict.end());
+
+    std::vector<int> keys;
+    for (const auto& entry : dict.range(25, 60)) keys.push_back(entry.first);
+    EXPECT_EQ(keys, (std::vector<int>{30, 40, 50}));
+    keys.clear();
+    for (const auto& entry : dict.range(60, 25)) keys.push_back(entry.first);
+    EXPECT_TRUE(keys.empty());
+    keys.clear();
+    for (const auto& entry : dict.snapshot().range(-5, 1000)) keys.push_back(entry.first);
+    EXPECT_EQ(keys.size(), 10u);
+}
+
+// TEST: prefix finds exactly the keys that start with it
+TEST(DictUnitTests, PrefixScan) {
+    Dictionary<std::string, int> dict;
+    const char* paths[] = {"/usr/bin/cc", "/usr/bin/c++", "/usr/lib/libc.so", "/usr/binary",
+                           "/var/log", "/usr/bin", "/usr/bio", "/usr/bim"};
+    for (int i = 0; i < 8; ++i) dict.insert(paths[i], i);
+    dict.insert(std::string("a\xff\xff"), 8);
+    dict.insert(std::string("b"), 9);
+
+    std::vector<std::string> found;
+    for (const auto& entry : dict.prefix("/usr/bin/")) found.push_back(entry.first);
+    EXPECT_EQ(found, (std::vector<std::string>{"/usr/bin/c++", "/usr/bin/cc"}));
+    found.clear();
+    for (const auto& entry : dict.prefix("/usr/bin")) found.push_back(entry.first);
+    EXPECT_EQ(found.size(), 4u);
+    found.clear();
+    for (const auto& entry : dict.prefix("a\xff")) found.push_back(entry.first);
+    EXPECT_EQ(found, (std::vector<std::string>{"a\xff\xff"}));
+    EXPECT_EQ(std::distance(dict.prefix("").begin(), dict.prefix("").end()), 10);
+    EXPECT_TRUE(dict.prefix("/zzz").begin() == dict.prefix("/zzz").end());
+}
+
+// TEST: saveDictionary and loadDictionary give back the same entries, in order
+TEST(DictUnitTests, SaveAndLoad) {
+    std::string path = testing::TempDir() + "dict_save_load.bin";
+    Dictionary<std::string, int> dict;
+    for (int i = 0; i < 1000; ++i) dict.insert("key" + std::to_string(i * 7 % 1000), i);
+    dict.insert("", -1);
+    saveDictionary(dict, path);
+
+    auto loaded = loadDictionary<std::string, int>(path);
+    EXPECT_EQ(loaded.size(), dict.size());
+    auto it = dict.begin();
+    for (const auto& entry : loaded) {
+        ASSERT_TRUE(it != dict.end());
+        EXPECT_EQ(entry.first, it->first);
+        EXPECT_EQ(entry.second, it->second);
+        ++it;
+    }
+    EXPECT_EQ(loaded.at("key693"), dict.at("key693"));
+    EXPECT_EQ(loaded.at(""), -1);
+
+    Dictionary<int, double> empty;
+    saveDictionary(empty, path);
+    EXPECT_TRUE((loadDictionary<int, double>(path).empty()));
+    std::remove(path.c_str());
+}
+
+// Exposes the height of a dictionary's tree, for tests of its shape.
+template <typename KeyType, typename ValueType>
+class TreeShape : public DictionaryView<KeyType, ValueType> {
+public:
+    explicit TreeShape(const DictionaryView<KeyType, ValueType>& view) : DictionaryView<KeyType, ValueType>(view) {}
+
+    int height() const { return heightOf(this->dictTree); }
+
+private:
+    template <typename T>
+    static int heightOf(const Tree<T>& tree) {
+        if (tree.isEmpty()) return 0;
+        return 1 + std::max(heightOf(tree.left()), heightOf(tree.right()));
+    }
+};
+
+// TEST: loadDictionary builds a balanced tree, even though the entries are sorted
+TEST(DictUnitTests, LoadedTreeIsBalanced) {
+    std::string path = testing::TempDir() + "dict_balanced.bin";
+    Dictionary<int, int> dict;
+    for (int i = 0; i < 1023; ++i) dict.insert(i, i);
+    EXPECT_EQ((TreeShape<int, int>(dict.snapshot()).height()), 1023);   // one long spine
+    saveDictionary(dict, path);
+    Dictionary<int, int> loaded = loadDictionary<int, int>(path);
+    std::vector<int> keys;
+    for (const auto& entry : loaded) keys.push_back(entry.first);
+    EXPECT_EQ(keys.size(), 1023u);
+    EXPECT_TRUE(std::is_sorted(keys.begin(), keys.end()));
+    // A perfectly balanced tree of 1023 nodes has 10 levels.
+    EXPECT_EQ((TreeShape<int, int>(loaded.snapshot()).height()), 10);
+    std::remove(path.c_str());
+}
+
+// TEST: a mapped file answers lookups in place
+TEST(DictUnitTests, MappedDictionaryLookups) {
+    std::string path = testing::TempDir() + "dict_mapped.bin";
+    Dictionary<std::string, std::string> dict;
+    for (int i = 0; i < 500; ++i) dict.insert("/srv/app/" + std::to_string(i), std::string(i % 13, 'v'));
+    saveDictionary(dict, path);
+
+    MappedDictionary<std::string, std::string> mapped(path);
+    EXPECT_EQ(mapped.size(), 500u);
+    for (int i = 0; i < 500; ++i) {
+        auto value = mapped.find("/srv/app/" + std::to_string(i));
+        ASSERT_TRUE(value.has_value()) << i;
+        EXPECT_EQ(*value, std::string(i % 13, 'v'));
+    }
+    EXPECT_FALSE(mapped.contains("/srv/app/500"));
+    EXPECT_FALSE(mapped.contains(""));
+    EXPECT_FALSE(mapped.contains("~"));
+    EXPECT_THROW(mapped.at("/srv/app/x"), std::out_of_range);
+    std::size_t n = 0;
+    std::string previous;
+    for (const auto& [key, value] : mapped) {
+        if (n++) {
+            EXPECT_LT(previous, key);
+        }
+        previous = std::string(key);
+    }
+    EXPECT_EQ(n, 500u);
+    std::remove(path.c_str());
+}
+
+// TEST: files that aren't dictionaries, or hold other types, are refused
+TEST(DictUnitTests, MappedDictionaryRejectsBadFiles) {
+    std::string path = testing::TempDir() + "dict_bad.bin";
+    Dictionary<int, int> dict;
+    dict.insert(1, 2);
+    saveDictionary(dict, path);
+    EXPECT_THROW((MappedDictionary<std::string, int>(path)), std::runtime_error);
+    EXPECT_THROW((loadDictionary<int, double>(path)), std::runtime_error);
+    // Types of the same size are told apart too.
+    EXPECT_THROW((loadDictionary<int, float>(path)), std::runtime_error);
+    EXPECT_THROW((MappedDictionary<float, int>(path)), std::runtime_error);
+    EXPECT_THROW((MappedDictionary<unsigned, int>(path)), std::runtime_error);
+    Dictionary<std::int64_t, std::uint64_t> wide;
+    wide.insert(-1, 1);
+    saveDictionary(wide, path);
+    EXPECT_EQ((MappedDictionary<std::int64_t, std::uint64_t>(path).at(-1)), 1u);
+    EXPECT_THROW((MappedDictionary<double, std::uint64_t>(path)), std::runtime_error);
+    EXPECT_THROW((MappedDictionary<std::uint64_t, std::uint64_t>(path)), std::runtime_error);
+    EXPECT_THROW((MappedDictionary<std::int64_t, std::int64_t>(path)), std::runtime_error);
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << "not a dictionary file at all, but long enough to have a header";
+    }
+    EXPECT_THROW((MappedDictionary<int, int>(path)), std::runtime_error);
+    std::remove(path.c_str());
+    EXPECT_THROW((MappedDictionary<int, int>(path)), std::system_error);
+}
@@ -0,0 +1,112 @@
+//
+// File:   dictbench.cpp
+// Author: Your Glorious Instructor
+// Purpose:
+// Time the ways a program can get its Dictionary at startup: parsing a
+// text file and inserting every entry, loading a file written by
+// saveDictionary, and opening that file as a MappedDictionary.
+//
+// Usage: dictbench [entries] [directory]
+// Defaults: 10,000,000 entries of 64-bit keys and values, with the files
+// in /tmp.  Build in Release mode or the numbers mean nothing.
+//
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "Dictionary.hpp"
+#include "DictionaryFile.hpp"
+
+// Run a function and return how long it took in milliseconds.
+template <typename Func>
+double timeIt(Func f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+using Dict = Dictionary<std::uint64_t, std::uint64_t>;
+
+int main(int argc, char* argv[]) {
+    std::size_t count = 10000000;
+    if (argc > 1) {
+        // A positive whole number; strtoull would quietly wrap "-5".
+        char* end = nullptr;
+        errno = 0;
+        unsigned long long asked = std::strtoull(argv[1], &end, 10);
+        if (end == argv[1] || *end != '\0' || errno == ERANGE || argv[1][0] == '-' || asked == 0) {
+            std::cerr << "usage: dictbench [entries] [directory]  (entries is a number above 0)\n";
+            return 1;
+        }
+        count = static_cast<std::size_t>(asked);
+    }
+    std::string directory = argc > 2 ? argv[2] : "/tmp";
+    std::string textPath = directory + "/dictbench.txt";
+    std::string binaryPath = directory + "/dictbench.bin";
+
+    // Distinct keys in scrambled order: i times an odd constant is a
+    // permutation of the 64-bit numbers.
+    std::vector<std::uint64_t> keys(count);
+    for (std::size_t i = 0; i < count; ++i) keys[i] = (i + 1) * 0x9e3779b97f4a7c15ULL;
+    {
+        std::ofstream text(textPath);
+        for (std::size_t i = 0; i < count; ++i) text << keys[i] << ' ' << i << '\n';
+    }
+    std::mt19937_64 rng(50);
+    std::vector<std::uint64_t> probes(1000000);
+    for (auto& probe : probes) probe = keys[rng() % count];
+
+    std::cout << count << " entries\n\n"
+              << std::setw(34) << "startup" << std::setw(14) << "ms" << "\n";
+    auto row = [](const char* name, double ms) {
+        std::cout << std::setw(34) << name << std::fixed << std::setprecision(1) << std::setw(14) << ms << "\n";
+    };
+    std::uint64_t sink = 0;
+
+    {
+        Dict dict;
+        row("parse text and insert", timeIt([&] {
+            std::ifstream text(textPath);
+            std::uint64_t key, value;
+            while (text >> key >> value) dict.insert(key, value);
+        }));
+        row("saveDictionary", timeIt([&] { saveDictionary(dict, binaryPath); }));
+        double ms = timeIt([&] {
+            for (std::uint64_t probe : probes) sink += dict.at(probe);
+        });
+        std::cout << "  (inserted tree: " << std::setprecision(0) << ms * 1e6 / probes.size() << " ns/lookup)\n";
+    }
+    {
+        Dict dict;
+        row("loadDictionary", timeIt([&] { dict = loadDictionary<std::uint64_t, std::uint64_t>(binaryPath); }));
+        double ms = timeIt([&] {
+            for (std::uint64_t probe : probes) sink += dict.at(probe);
+        });
+        std::cout << "  (loaded tree: " << std::setprecision(0) << ms * 1e6 / probes.size() << " ns/lookup)\n";
+    }
+    {
+        std::uint64_t first = 0;
+        row("MappedDictionary, open + 1 lookup", timeIt([&] {
+            MappedDictionary<std::uint64_t, std::uint64_t> mapped(binaryPath);
+            first = mapped.at(probes[0]);
+        }));
+        MappedDictionary<std::uint64_t, std::uint64_t> mapped(binaryPath);
+        double ms = timeIt([&] {
+            for (std::uint64_t probe : probes) sink += mapped.at(probe);
+        });
+        std::cout << "  (mapped file: " << std::setprecision(0) << ms * 1e6 / probes.size() << " ns/lookup)\n";
+        sink += first;
+    }
+    std::cout << "(checksum " << sink << ")\n";
+    std::remove(textPath.c_str());
+    std::remove(binaryPath.c_str());
+    return 0;
+}
@@ -0,0 +1,33 @@
+//
+// File:   CountAllocations.hpp
+// Author: Your Glorious Instructor
+// Purpose:
+// Count the heap allocations a piece of code makes, so tests can check
+// that something doesn't allocate.
+//
+//     AllocationCounter counter;
+//     dict.at(key);
+//     EXPECT_EQ(counter.count(), 0);
+//
+// Only allocations made by the counter's own thread while it is alive are
+// counted.  CountAllocations.cpp replaces every form of the global
+// operator new and operator delete to do this, which is why it is its own
+// translation unit in the test program and not part of a library.
+//
+#pragma once
+
+class AllocationCounter {
+public:
+    AllocationCounter();
+    ~AllocationCounter();
+
+    AllocationCounter(const AllocationCounter&) = delete;
+    AllocationCounter& operator=(const AllocationCounter&) = delete;
+
+    // Allocations made by this thread since the counter was made.
+    long count() const;
+
+private:
+    long start;
+    bool wasCounting;
+};
@@ -0,0 +1,77 @@
+//
+// File:   CountAllocations.cpp
+// Author: Your Glorious Instructor
+// Purpose:
+// Replace the global operator new and operator delete, in all their forms,
+// with versions that count allocations for AllocationCounter.
+//
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include "CountAllocations.hpp"
+
+namespace {
+
+thread_local bool counting = false;
+thread_local long counted = 0;
+
+void* allocate(std::size_t size) {
+    if (counting) ++counted;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void* allocate(std::size_t size, std::align_val_t alignment) {
+    if (counting) ++counted;
+    // aligned_alloc wants a size that is a multiple of the alignment.
+    std::size_t align = static_cast<std::size_t>(alignment);
+    std::size_t rounded = size ? (size + align - 1) / align * align : align;
+    if (void* p = std::aligned_alloc(align, rounded)) return p;
+    throw std::bad_alloc();
+}
+
+} // namespace
+
+AllocationCounter::AllocationCounter() : start(counted), wasCounting(counting) {
+    counting = true;
+}
+
+AllocationCounter::~AllocationCounter() {
+    counting = wasCounting;
+}
+
+long AllocationCounter::count() const {
+    return counted - start;
+}
+
+void* operator new(std::size_t size) { return allocate(size); }
+void* operator new[](std::size_t size) { return allocate(size); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return allocate(size, alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return allocate(size, alignment); }
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try { return allocate(size); } catch (const std::bad_alloc&) { return nullptr; }
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    try { return allocate(size); } catch (const std::bad_alloc&) { return nullptr; }
+}
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    try { return allocate(size, alignment); } catch (const std::bad_alloc&) { return nullptr; }
+}
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    try { return allocate(size, alignment); } catch (const std::bad_alloc&) { return nullptr; }
+}
+
+// malloc and aligned_alloc memory are both released with free.
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
@@ -0,0 +1,84 @@
+//
+// File:   diskbench.cpp
+// Author: Your Glorious Instructor
+// Purpose:
+// Build a DiskBTree much bigger than its page cache and time random and
+// sequential lookups starting from a cold cache.
+//
+// Usage: diskbench [file] [entries] [cachePages]
+// Defaults: /tmp/diskbench.db, 10,000,000 entries, 4096 cached pages
+// (16MB).  Entries are 16 bytes, so a 10GB tree is about 600,000,000
+// entries.  If the file already holds at least that many entries it is
+// reused rather than rebuilt.
+//
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include "diskbtree.hpp"
+
+using Tree = DiskBTree<std::uint64_t, std::uint64_t>;
+
+// Run a function and return how long it took in milliseconds.
+template <typename Func>
+double timeIt(Func f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+// Look up each key produced by nextKey, starting cold, and report the time
+// and pages read per lookup.
+template <typename NextKey>
+void lookups(Tree& tree, const std::string& name, int count, NextKey nextKey) {
+    tree.dropCaches();
+    tree.resetCacheStatistics();
+    std::uint64_t found = 0;
+    double ms = timeIt([&] {
+        for (int i = 0; i < count; ++i) found += tree.find(nextKey()).has_value();
+    });
+    const auto& stats = tree.cacheStatistics();
+    std::cout << std::setw(12) << name << std::fixed << std::setprecision(2)
+              << std::setw(10) << count << std::setw(12) << ms * 1000.0 / count
+              << std::setw(14) << double(stats.reads) / count
+              << std::setw(10) << found << "\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::string path = (argc > 1) ? argv[1] : "/tmp/diskbench.db";
+    std::uint64_t entries = (argc > 2) ? std::strtoull(argv[2], nullptr, 10) : 10000000;
+    std::size_t cachePages = (argc > 3) ? std::strtoull(argv[3], nullptr, 10) : 4096;
+
+    Tree tree(path, cachePages);
+    if (tree.size() < entries) {
+        // Keys are the even numbers, inserted in order, so building mostly
+        // touches the right-hand edge of the tree.
+        std::uint64_t start = tree.size();
+        double ms = timeIt([&] {
+            for (std::uint64_t i = start; i < entries; ++i) tree.insert(2 * i, i);
+            tree.flush();
+        });
+        std::cout << "built " << entries - start << " entries in " << std::fixed
+                  << std::setprecision(1) << ms / 1000.0 << " s\n";
+    }
+    entries = tree.size();
+    std::cout << path << ": " << entries << " entries, " << tree.pages() << " pages of 4KB ("
+              << std::setprecision(1) << tree.pages() * 4096.0 / (1 << 20) << " MB), height "
+              << tree.height() << ", cache " << cachePages << " pages\n\n"
+              << std::setw(12) << "lookups" << std::setw(10) << "count" << std::setw(12) << "us each"
+              << std::setw(14) << "pages read" << std::setw(10) << "found" << "\n";
+
+    std::mt19937_64 gen(372);
+    lookups(tree, "random", 100000, [&] { return gen() % (2 * entries); });
+    std::uint64_t next = (gen() % entries) * 2;
+    lookups(tree, "sequential", 100000, [&] {
+        std::uint64_t k = next;
+        next = (next + 2) % (2 * entries);
+        return k;
+    });
+    return 0;
+}
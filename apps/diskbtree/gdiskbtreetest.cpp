@@ -0,0 +1,140 @@
+//
+// File:   gdiskbtreetest.cpp
+// Author: Your Glorious Instructor
+// Purpose:
+//  Provide unit tests for our DiskBTree class
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+#include "diskbtree.hpp"
+
+// A scratch file that is removed when the test ends.
+class TempFile {
+public:
+    explicit TempFile(const std::string& name) : path(testing::TempDir() + name) { std::remove(path.c_str()); }
+    ~TempFile() { std::remove(path.c_str()); }
+    std::string path;
+};
+
+// Small pages make trees several levels deep with only a few thousand
+// entries.
+using SmallTree = DiskBTree<std::int64_t, std::int64_t, 128>;
+
+// Test: A new file holds an empty tree
+// Precondition: The file doesn't exist.
+// Postcondition: The tree is empty and finds nothing.
+TEST(DiskBTree, NewFileIsEmpty) {
+    TempFile file("diskbtree_empty.db");
+    DiskBTree<int, int> tree(file.path);
+    EXPECT_TRUE(tree.empty());
+    EXPECT_EQ(tree.height(), 1);
+    EXPECT_FALSE(tree.find(1).has_value());
+}
+
+// Test: Inserts split pages and everything can be found again
+// Precondition: A small-page tree gets shuffled keys, one of them twice.
+// Postcondition: Every key has its latest value and the tree grew levels.
+TEST(DiskBTree, InsertAndFind) {
+    TempFile file("diskbtree_insert.db");
+    SmallTree tree(file.path, 16);
+    std::vector<std::int64_t> keys;
+    for (std::int64_t k = 0; k < 5000; ++k) keys.push_back(k * 3);
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(38));
+    for (auto k : keys) EXPECT_TRUE(tree.insert(k, k * 10));
+    EXPECT_FALSE(tree.insert(300, -1));
+
+    EXPECT_EQ(tree.size(), 5000u);
+    EXPECT_GE(tree.height(), 3);
+    for (std::int64_t k = 0; k < 15000; ++k) {
+        auto v = tree.find(k);
+        if (k % 3 != 0) {
+            EXPECT_FALSE(v.has_value());
+        } else {
+            ASSERT_TRUE(v.has_value()) << k;
+            EXPECT_EQ(*v, k == 300 ? -1 : k * 10);
+        }
+    }
+}
+
+// Test: The tree survives closing and reopening the file
+// Precondition: A tree is filled through a tiny cache, closed and reopened.
+// Postcondition: The reopened tree has the same size, height and entries.
+TEST(DiskBTree, Reopen) {
+    TempFile file("diskbtree_reopen.db");
+    int height;
+    {
+        SmallTree tree(file.path, 16);
+        for (std::int64_t k = 0; k < 3000; ++k) tree.insert(k, -k);
+        height = tree.height();
+    }
+    SmallTree tree(file.path, 16);
+    EXPECT_EQ(tree.size(), 3000u);
+    EXPECT_EQ(tree.height(), height);
+    for (std::int64_t k = 0; k < 3000; ++k) EXPECT_EQ(tree.find(k).value_or(1), -k);
+    tree.insert(3000, 0);
+    EXPECT_EQ(tree.size(), 3001u);
+}
+
+// Test: A file holding a different kind of tree is refused
+// Precondition: A tree with 8-byte values is created, then opened with
+//               4-byte values.
+// Postcondition: Opening throws std::runtime_error.
+TEST(DiskBTree, RejectsMismatchedFile) {
+    TempFile file("diskbtree_mismatch.db");
+    { DiskBTree<std::int64_t, std::int64_t> tree(file.path); }
+    EXPECT_THROW((DiskBTree<std::int64_t, std::int32_t>(file.path)), std::runtime_error);
+}
+
+// Test: Range scans follow the leaf links
+// Precondition: A small-page tree holds the even keys 0..9998.
+// Postcondition: forEachInRange visits exactly the keys in [lo, hi).
+TEST(DiskBTree, RangeScan) {
+    TempFile file("diskbtree_range.db");
+    SmallTree tree(file.path, 16);
+    for (std::int64_t k = 9998; k >= 0; k -= 2) tree.insert(k, k + 1);
+    std::vector<std::int64_t> seen;
+    tree.forEachInRange(1001, 1400, [&seen](std::int64_t k, std::int64_t v) {
+        EXPECT_EQ(v, k + 1);
+        seen.push_back(k);
+    });
+    ASSERT_EQ(seen.size(), 199u);
+    EXPECT_EQ(seen.front(), 1002);
+    EXPECT_EQ(seen.back(), 1398);
+    EXPECT_TRUE(std::is_sorted(seen.begin(), seen.end()));
+    int visited = 0;
+    tree.forEachInRange(1400, 1400, [&visited](std::int64_t, std::int64_t) { ++visited; });
+    tree.forEachInRange(2000, 1000, [&visited](std::int64_t, std::int64_t) { ++visited; });
+    EXPECT_EQ(visited, 0);
+}
+
+// Test: Random inserts through a cache much smaller than the tree
+// Precondition: Random keys go into a tree and a std::map; the cache holds
+//               16 of the tree's pages.
+// Postcondition: After a cold restart both hold the same entries, and a
+//                lookup reads no more pages than the tree has levels.
+TEST(DiskBTree, MatchesStdMapWithEvictions) {
+    TempFile file("diskbtree_stress.db");
+    SmallTree tree(file.path, 16);
+    std::map<std::int64_t, std::int64_t> expected;
+    std::mt19937_64 gen(372);
+    for (int i = 0; i < 20000; ++i) {
+        std::int64_t k = static_cast<std::int64_t>(gen() % 50000);
+        ASSERT_EQ(tree.insert(k, i), expected.find(k) == expected.end());
+        expected[k] = i;
+    }
+    EXPECT_GT(tree.pages(), 16u * 10);
+    EXPECT_EQ(tree.size(), expected.size());
+
+    tree.dropCaches();
+    tree.resetCacheStatistics();
+    std::int64_t probe = expected.begin()->first;
+    EXPECT_EQ(tree.find(probe).value(), expected.begin()->second);
+    EXPECT_EQ(tree.cacheStatistics().reads, static_cast<std::uint64_t>(tree.height()));
+
+    for (const auto& [k, v] : expected) ASSERT_EQ(tree.find(k).value_or(-1), v) << k;
+}
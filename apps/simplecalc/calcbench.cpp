@@ -0,0 +1,103 @@
+//
+// File:   calcbench.cpp
+// Author: <Your Glorious Instructor>
+// Purpose:
+// Measure how many expressions a second simplecalc's batch mode gets
+// through.  Writes a file of random expressions (if it isn't there
+// already), then evaluates it with evaluateBatch on different numbers of
+// threads, throwing the output away.
+//
+// Usage: calcbench [lines] [file]
+// The default is 100M lines (a few GB) in calcbench.txt.  Build in
+// Release mode or the numbers mean nothing.
+//
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <sys/stat.h>
+#include "ExpBatch.hpp"
+
+// A stream buffer that drops everything, so we time evaluating and
+// formatting, not the disk.
+class NullBuffer : public std::streambuf {
+protected:
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+    int overflow(int c) override { return c; }
+};
+
+// A random expression with a mix of precedence, parentheses and unary
+// minus, like the ones we get from generated reports.
+void randomExpression(std::mt19937& rng, int levels, std::string& out) {
+    if (levels == 0) {
+        out += std::to_string(rng() % 1000);
+        if (rng() % 2) {
+            out += '.';
+            out += std::to_string(rng() % 100);
+        }
+        return;
+    }
+    bool parens = rng() % 3 == 0;
+    if (parens) out += '(';
+    if (rng() % 8 == 0) out += '-';
+    randomExpression(rng, levels - 1, out);
+    out += " +-*/"[1 + rng() % 4];
+    randomExpression(rng, levels - 1, out);
+    if (parens) out += ')';
+}
+
+void generate(const std::string& path, long lines) {
+    std::cout << "writing " << lines << " lines to " << path << "..." << std::flush;
+    std::ofstream file(path, std::ios::binary);
+    std::mt19937 rng(1);
+    std::string buffer;
+    for (long i = 0; i < lines; ++i) {
+        randomExpression(rng, 1 + static_cast<int>(rng() % 3), buffer);
+        buffer += '\n';
+        if (buffer.size() > (1 << 20)) {
+            file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            buffer.clear();
+        }
+    }
+    file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    if (!file) {
+        std::cerr << "\ncan't write " << path << "\n";
+        std::exit(1);
+    }
+    std::cout << " done\n";
+}
+
+int main(int argc, char* argv[]) {
+    long lines = argc > 1 ? std::atol(argv[1]) : 100000000;
+    std::string path = argc > 2 ? argv[2] : "calcbench.txt";
+
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0) generate(path, lines);
+    MappedFile file(path);
+    double megabytes = file.text().size() / 1e6;
+    std::cout << path << ": " << std::fixed << std::setprecision(1) << megabytes << " MB, "
+              << std::thread::hardware_concurrency() << " cores\n"
+              << std::setw(8) << "threads" << std::setw(12) << "seconds" << std::setw(16) << "expr/s"
+              << std::setw(10) << "MB/s" << "\n";
+
+    unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned threads = 1;; threads *= 2) {
+        threads = std::min(threads, cores);
+        NullBuffer null;
+        std::ostream out(&null);
+        auto start = std::chrono::steady_clock::now();
+        BatchStats stats = evaluateBatch(file.text(), threads, out);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << std::setw(8) << threads << std::setw(12) << std::setprecision(2) << seconds
+                  << std::setw(16) << std::setprecision(0) << stats.lines / seconds << std::setw(10)
+                  << std::setprecision(1) << megabytes / seconds << "\n";
+        if (threads == cores) break;
+    }
+    return 0;
+}
@@ -0,0 +1,97 @@
+//
+// File:   gbatchtest.cpp
+// Author: <Your Glorious Instructor>
+// Purpose:
+//  Provide unit tests for batch evaluation of expression files
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+#include "ExpBatch.hpp"
+
+// Test: Chunks end at line ends and cover the text exactly
+// Precondition: Lines of different lengths, split with several chunk
+//               sizes, including one smaller than a line.
+// Postcondition: Joined back together the chunks are the text, and each
+//                one but the last ends in a newline.
+TEST(ExpBatch, SplitLines) {
+    std::string text = "1+2\n33*4\n\n5/6/7\n8";
+    for (std::size_t size : {1, 3, 4, 5, 9, 100}) {
+        std::vector<std::string_view> chunks = splitLines(text, size);
+        std::string joined;
+        for (std::size_t i = 0; i < chunks.size(); ++i) {
+            joined += chunks[i];
+            if (i + 1 < chunks.size()) {
+                EXPECT_EQ(chunks[i].back(), '\n');
+            }
+        }
+        EXPECT_EQ(joined, text);
+    }
+    EXPECT_TRUE(splitLines("", 10).empty());
+}
+
+// Test: Every line gets a result line, bad and empty ones included
+// Precondition: A chunk with good, empty and bad lines, no final newline.
+// Postcondition: One output line per input line; errors are counted.
+TEST(ExpBatch, EvaluateChunk) {
+    std::string out;
+    BatchStats stats = evaluateChunk("1+2*3\n\n(1/4\n0.1+0.2\r\nx", out);
+    EXPECT_EQ(stats.lines, 5u);
+    EXPECT_EQ(stats.errors, 2u);
+    std::istringstream lines(out);
+    std::string line;
+    std::vector<std::string> got;
+    while (std::getline(lines, line)) got.push_back(line);
+    ASSERT_EQ(got.size(), 5u);
+    EXPECT_EQ(got[0], "7");
+    EXPECT_EQ(got[1], "");
+    EXPECT_EQ(got[2].rfind("error: ", 0), 0u);
+    EXPECT_EQ(std::stod(got[3]), 0.1 + 0.2);
+    EXPECT_EQ(got[4].rfind("error: ", 0), 0u);
+}
+
+// Test: The output is in input order however the work is split up
+// Precondition: 20000 expressions, evaluated with tiny chunks on 1, 3 and
+//               8 threads.
+// Postcondition: Always the same as evaluating the whole text in one go.
+TEST(ExpBatch, OrderedOutput) {
+    std::mt19937 rng(5);
+    std::string text;
+    for (int i = 0; i < 20000; ++i)
+        text += std::to_string(rng() % 100) + "*(" + std::to_string(i) + "+0.5)/" + std::to_string(1 + rng() % 7) + "\n";
+    std::string expected;
+    evaluateChunk(text, expected);
+
+    for (unsigned threads : {1u, 3u, 8u}) {
+        std::ostringstream out;
+        BatchStats stats = evaluateBatch(text, threads, out, 64);
+        EXPECT_EQ(stats.lines, 20000u);
+        EXPECT_EQ(stats.errors, 0u);
+        EXPECT_EQ(out.str(), expected) << threads << " threads";
+    }
+}
+
+// Test: A mapped file reads back what was written
+// Precondition: A small file, an empty file and a missing file.
+// Postcondition: The text matches, the empty one is empty, and the
+//                missing one throws system_error.
+TEST(ExpBatch, MappedFile) {
+    std::string path = ::testing::TempDir() + "gbatchtest.txt";
+    std::ofstream(path) << "1+1\n2*2\n";
+    {
+        MappedFile file(path);
+        EXPECT_EQ(file.text(), "1+1\n2*2\n");
+        std::ostringstream out;
+        evaluateBatch(file.text(), 2, out);
+        EXPECT_EQ(out.str(), "2\n4\n");
+    }
+    std::ofstream(path, std::ios::trunc).close();
+    EXPECT_TRUE(MappedFile{path}.text().empty());
+    std::remove(path.c_str());
+    EXPECT_THROW(MappedFile{path}, std::system_error);
+}
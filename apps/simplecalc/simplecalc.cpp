@@ -1,63 +1,74 @@
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
 #include <iostream>
-#include <cctype>     // Provides isdigit()
-#include <cstring>    // For strchr()
-#include <stack>      // Let's use the STL stack
+#include <string>
+#include "ExpParser.hpp"   // The tokenizer and parser shared with ExpTree
+#include "ExpBatch.hpp"    // Evaluating a whole file at once
 
 using namespace std;
 double readAndEvaluate(istream &ins);
-void evaluateStackTops(stack<double> &numbers,
-                       stack<char>  &ops);
-int main() {
+int runBatch(const string &path, unsigned threads);
+
+// With no arguments, ask for one expression and evaluate it.  Given a
+// file (and optionally how many threads to use), evaluate every line in
+// it and print the results, one per line, in the same order.
+int main(int argc, char *argv[]) {
+  if (argc > 1) {
+    unsigned threads = 0;
+    if (argc > 2) {
+      // A whole, non-negative number; more threads than MaxThreads only
+      // wait on each other.
+      const long MaxThreads = 256;
+      char *end = nullptr;
+      errno = 0;
+      long asked = strtol(argv[2], &end, 10);
+      if (end == argv[2] || *end != '\0' || errno == ERANGE || asked < 0) {
+        cerr << "usage: simplecalc [file [threads]]  (threads is a number, 0 for one per core)" << endl;
+        return 1;
+      }
+      threads = static_cast<unsigned>(asked > MaxThreads ? MaxThreads : asked);
+    }
+    return runBatch(argv[1], threads);
+  }
   double answer = 0;
-    cout << "Type a fully parenthsized expression" << endl;
-    answer = readAndEvaluate(cin);
+    cout << "Type an expression" << endl;
+    try {
+      answer = readAndEvaluate(cin);
+    }
+    catch (const exception &e) {
+      cout << "That isn't an expression: " << e.what() << endl;
+      return 1;
+    }
     cout << "That evaluates to " << answer << endl;
     return 0;
 }
 
+// Read one line and work out its value.  The parser does the arithmetic
+// as it goes (ExpEvalBuilder), so no tree is built and nothing is
+// allocated beyond the line itself.  Operators follow the usual
+// precedence; fully parenthesized input works as it always did.
 double readAndEvaluate(istream &ins) {
- const char DECIMAL = '.';
- const char RIGHTPAREN = ')';
- stack<double> numbers;
- stack<char> operations;
- double number;
- char symbol;
- while (ins && ins.peek() != '\n') {
-  if (isdigit(ins.peek()) || (ins.peek() == DECIMAL)) {
-    ins >> number;
-    numbers.push(number);
-  }
-  else if (strchr("+-*/", ins.peek()) != NULL) {
-    ins >> symbol;
-    operations.push(symbol);
-  }
-  else if (ins.peek() == RIGHTPAREN) {
-    ins.ignore();
-    evaluateStackTops(numbers, operations);
-  }
-  else {
-    ins.ignore();
-  }
- }
- return numbers.top();
+ string line;
+ getline(ins, line);
+ return evaluateExpression(line);
 }
 
-void evaluateStackTops(stack<double>& numbers, 
-                       stack<char>& operations) {
-  double op1, op2;
-  op2 = numbers.top();
-  numbers.pop();
-  op1 = numbers.top();
-  numbers.pop();
-  switch (operations.top()) {
-      case '+': numbers.push(op1 + op2);
-                break;
-      case '-': numbers.push(op1 - op2);
-                break;
-      case '*': numbers.push(op1 * op2);
-                break;
-      case '/': numbers.push(op1 / op2);
-                break;
+// Batch mode: results go to standard output, a summary to standard error.
+int runBatch(const string &path, unsigned threads) {
+  ios::sync_with_stdio(false);
+  try {
+    auto start = chrono::steady_clock::now();
+    MappedFile file(path);
+    BatchStats stats = evaluateBatch(file.text(), threads, cout);
+    cout.flush();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cerr << stats.lines << " expressions (" << stats.errors << " errors) in " << seconds << " s, "
+         << stats.lines / seconds << " per second" << endl;
+    return stats.errors == 0 ? 0 : 2;
+  }
+  catch (const exception &e) {
+    cerr << "simplecalc: " << e.what() << endl;
+    return 1;
   }
-  operations.pop();
 }
@@ -0,0 +1,104 @@
+//
+// File:   concurrentskiplist.cpp
+// Author: Your Glorious Instructor
+// Purpose:
+// Exercise the lock-free ConcurrentSkipList from several threads at once.
+
+// The checks below are the test, so keep them in release builds too.
+#undef NDEBUG
+#include <iostream>
+#include <cassert>
+#include <thread>
+#include <vector>
+#include "concurrent_skiplist.hpp"
+
+// The same checks as the SkipList demo, from a single thread.
+void runSingleThreadTests() {
+    ConcurrentSkipList<int> sl;
+    for (int k : { 3, 6, 7, 9, 12, 19, 17, 26, 21, 25 }) {
+        bool added = sl.insert(k);
+        assert(added);
+    }
+    bool again = sl.insert(7);    // already present
+    assert(!again);
+    assert(sl.size() == 10);
+    assert(sl.contains(3) && sl.contains(26) && sl.contains(21));
+    assert(!sl.contains(15));
+
+    bool erased = sl.erase(6);
+    assert(erased);
+    erased = sl.erase(6);
+    assert(!erased);
+    assert(!sl.contains(6));
+    erased = sl.erase(19);
+    assert(erased);
+    erased = sl.erase(3);
+    assert(erased);
+    assert(sl.size() == 7);
+
+    std::vector<int> keys;
+    sl.forEach([&keys](int k) { keys.push_back(k); });
+    assert((keys == std::vector<int>{ 7, 9, 12, 17, 21, 25, 26 }));
+}
+
+// Writers insert disjoint ranges and then erase the even keys of their own
+// range while readers keep probing keys that must always be present.
+void runMultiThreadTests(int threads, int perThread) {
+    ConcurrentSkipList<int> sl;
+    // Keys below zero are present for the whole test.
+    for (int k = -1000; k < 0; ++k) sl.insert(k);
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&sl, t, perThread] {
+            int base = t * perThread;
+            for (int k = base; k < base + perThread; ++k) {
+                bool added = sl.insert(k);
+                assert(added);
+            }
+            for (int k = base; k < base + perThread; k += 2) {
+                bool erased = sl.erase(k);
+                assert(erased);
+            }
+        });
+        workers.emplace_back([&sl] {
+            for (int round = 0; round < 20; ++round)
+                for (int k = -1000; k < 0; k += 7) assert(sl.contains(k));
+        });
+    }
+    for (auto& w : workers) w.join();
+
+    assert(sl.size() == 1000 + static_cast<std::size_t>(threads) * perThread / 2);
+    for (int k = 0; k < threads * perThread; ++k) assert(sl.contains(k) == (k % 2 == 1));
+
+    // Everyone fights over the same small set of keys; each key must end up
+    // inserted exactly as often as it was erased, plus at most one.
+    ConcurrentSkipList<int> hot;
+    std::vector<int> net(threads * 64, 0);
+    std::vector<std::thread> fighters;
+    for (int t = 0; t < threads; ++t) {
+        fighters.emplace_back([&hot, &net, t] {
+            for (int i = 0; i < 20000; ++i) {
+                int k = (i * 7 + t) % 64;
+                if (i % 2 == 0) {
+                    if (hot.insert(k)) ++net[t * 64 + k];
+                } else {
+                    if (hot.erase(k)) --net[t * 64 + k];
+                }
+            }
+        });
+    }
+    for (auto& f : fighters) f.join();
+    for (int k = 0; k < 64; ++k) {
+        int total = 0;
+        for (int t = 0; t < threads; ++t) total += net[t * 64 + k];
+        assert(total == (hot.contains(k) ? 1 : 0));
+    }
+}
+
+int main() {
+    runSingleThreadTests();
+    runMultiThreadTests(4, 20000);
+    std::cout << "All tests passed successfully!\n";
+    return 0;
+}
@@ -0,0 +1,66 @@
+//
+// File:   ingestbench.cpp
+// Author: Your Glorious Instructor
+// Purpose:
+// Compare SkipList::insert one key at a time with insert_sorted_batch on
+// sorted, nearly sorted (timestamps arriving a little out of order) and
+// random input.
+//
+// Usage: ingestbench [n]      (default 1,000,000 keys)
+//
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "skiplist.hpp"
+
+template <typename Work>
+double timeIt(Work work) {
+    auto start = std::chrono::steady_clock::now();
+    work();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void compare(const std::string& name, const std::vector<long>& keys) {
+    double single = timeIt([&keys] {
+        SkipList<long> sl(DuplicatePolicy::Reject, 24);
+        for (long k : keys) sl.insert(k);
+    });
+    double batch = timeIt([&keys] {
+        SkipList<long> sl(DuplicatePolicy::Reject, 24);
+        sl.insert_sorted_batch(keys.begin(), keys.end());
+    });
+    std::cout << std::left << std::setw(14) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(12) << single << std::setw(12) << batch
+              << std::setw(9) << single / batch << "x\n";
+}
+
+int main(int argc, char* argv[]) {
+    long n = (argc > 1) ? std::atol(argv[1]) : 1000000;
+    std::mt19937_64 gen(372);
+
+    std::vector<long> sorted(n);
+    for (long i = 0; i < n; ++i) sorted[i] = i * 10;
+
+    // Each timestamp arrives up to 64 positions late
+    std::vector<long> nearly = sorted;
+    for (long i = 0; i + 1 < n; i += 2) {
+        long j = std::min(n - 1, i + static_cast<long>(gen() % 64));
+        std::swap(nearly[i], nearly[j]);
+    }
+
+    std::vector<long> shuffled = sorted;
+    std::shuffle(shuffled.begin(), shuffled.end(), gen);
+
+    std::cout << n << " keys, times in ms\n"
+              << std::left << std::setw(14) << "input" << std::right
+              << std::setw(12) << "insert" << std::setw(12) << "batch" << std::setw(10) << "speedup\n";
+    compare("sorted", sorted);
+    compare("nearly sorted", nearly);
+    compare("random", shuffled);
+    return 0;
+}
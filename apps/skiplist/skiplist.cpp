@@ -4,10 +4,125 @@
 // Purpose:
 // Demonstrate the use of Skip lists
 
+// The checks below are the test, so keep them in release builds too.
+#undef NDEBUG
 #include <iostream>
+#include <algorithm>
 #include <cassert>
+#include <string>
+#include <vector>
 #include "skiplist.hpp"
 
+// Ordered map behaviour: iteration, bounds, ranges and duplicate keys
+void runMapTests() {
+    SkipList<int, std::string> memtable(DuplicatePolicy::Overwrite);
+    assert(memtable.empty());
+    for (int k : { 40, 10, 30, 20, 50 }) {
+        bool added = memtable.insert(k, "v" + std::to_string(k));
+        assert(added);
+    }
+    assert(memtable.size() == 5);
+
+    // Overwrite replaces the value and doesn't add an entry
+    bool added = memtable.insert(30, "thirty");
+    assert(added == false);
+    assert(memtable.size() == 5);
+    assert(memtable.find(30)->second == "thirty");
+    assert(memtable.find(35) == memtable.end());
+
+    // Iteration is in key order
+    std::vector<int> keys;
+    for (const auto& entry : memtable) keys.push_back(entry.first);
+    assert((keys == std::vector<int>{ 10, 20, 30, 40, 50 }));
+
+    assert(memtable.lower_bound(25)->first == 30);
+    assert(memtable.lower_bound(30)->first == 30);
+    assert(memtable.upper_bound(30)->first == 40);
+    assert(memtable.lower_bound(60) == memtable.end());
+
+    // range(lo, hi) includes lo but not hi; values can be changed through it
+    keys.clear();
+    for (auto& entry : memtable.range(15, 40)) {
+        keys.push_back(entry.first);
+        entry.second += "*";
+    }
+    assert((keys == std::vector<int>{ 20, 30 }));
+    assert(memtable.find(30)->second == "thirty*");
+    assert(memtable.find(40)->second == "v40");
+    assert(memtable.range(41, 49).empty());
+    assert(memtable.range(40, 40).empty());
+    assert(memtable.range(50, 10).empty());
+
+    bool erased = memtable.erase(20);
+    assert(erased);
+    assert(memtable.size() == 4);
+
+    // Reject keeps the first value
+    SkipList<int, int> firstWins(DuplicatePolicy::Reject);
+    added = firstWins.insert(1, 100);
+    assert(added);
+    added = firstWins.insert(1, 200);
+    assert(added == false);
+    assert(firstWins.find(1)->second == 100);
+
+    // Allow keeps every copy, in insertion order
+    SkipList<int, int> log(DuplicatePolicy::Allow);
+    log.insert(5, 1);
+    log.insert(3, 0);
+    log.insert(5, 2);
+    log.insert(5, 3);
+    assert(log.size() == 4);
+    std::vector<int> values;
+    for (const auto& entry : log.range(5, 6)) values.push_back(entry.second);
+    assert((values == std::vector<int>{ 1, 2, 3 }));
+    erased = log.erase(5);
+    assert(erased);
+    assert(log.find(5)->second == 2);
+
+    memtable.clear();
+    assert(memtable.empty() && memtable.begin() == memtable.end());
+}
+
+// Finger searches and batched inserts
+void runFingerTests() {
+    SkipList<int> sl(DuplicatePolicy::Reject);
+
+    // Nearly sorted input, with a few keys arriving late
+    std::vector<int> batch;
+    for (int i = 0; i < 1000; ++i) batch.push_back(i % 10 == 9 ? i - 5 : i);
+    std::size_t added = sl.insert_sorted_batch(batch.begin(), batch.end());
+    assert(added == 900);
+    assert(sl.size() == 900);
+    std::vector<int> keys(sl.begin(), sl.end());
+    assert(std::is_sorted(keys.begin(), keys.end()));
+
+    // Out of order batches still work, just without the speedup
+    std::vector<int> backwards{ 2009, 2005, 2001, 5, 2009 };
+    added = sl.insert_sorted_batch(backwards.begin(), backwards.end());
+    assert(added == 3);
+    assert(sl.search(2001) && sl.search(2005) && sl.search(2009));
+
+    // A finger can move forwards or backwards
+    SkipList<int>::Finger finger;
+    assert(*sl.lower_bound(500, finger) == 500);
+    assert(*sl.lower_bound(509, finger) == 510);
+    assert(sl.find(509, finger) == sl.end());
+    assert(*sl.find(100, finger) == 100);
+    assert(*sl.lower_bound(1500, finger) == 2001);
+
+    // Erasing behind the finger's back makes it start over, not crash
+    bool erased = sl.erase(100);
+    assert(erased);
+    assert(sl.find(100, finger) == sl.end());
+    assert(*sl.lower_bound(99, finger) == 101);
+
+    SkipList<int, std::string> map(DuplicatePolicy::Overwrite);
+    std::vector<std::pair<int, std::string>> entries{ { 1, "a" }, { 2, "b" }, { 2, "c" } };
+    added = map.insert_sorted_batch(entries.begin(), entries.end());
+    assert(added == 2);
+    assert(map.find(2)->second == "c");
+}
+
 // Test Cases
 void runTests() {
     SkipList<int> sl;
@@ -37,14 +152,52 @@ void runTests() {
     assert(sl.search(15) == false); // 15 is not in the list
 
     // Deletion test
-    sl.erase(6);
+    bool erased = sl.erase(6);
+    assert(erased == true);
     assert(sl.search(6) == false);
 
-    sl.erase(19);
+    erased = sl.erase(19);
+    assert(erased == true);
     assert(sl.search(19) == false);
 
-    sl.erase(3);
+    erased = sl.erase(3);
+    assert(erased == true);
     assert(sl.search(3) == false);
+    erased = sl.erase(3);
+    assert(erased == false);  // already gone
+
+    // Duplicates are kept; each erase removes one copy
+    sl.insert(7);
+    erased = sl.erase(7);
+    assert(erased == true);
+    assert(sl.search(7) == true);
+    erased = sl.erase(7);
+    assert(erased == true);
+    assert(sl.search(7) == false);
+
+    // Erased nodes are recycled by later inserts
+    for (int i = 100; i < 1100; ++i) sl.insert(i);
+    for (int i = 100; i < 1100; i += 2) {
+        erased = sl.erase(i);
+        assert(erased);
+    }
+    for (int i = 100; i < 1100; ++i) sl.insert(i);
+    for (int i = 100; i < 1100; ++i) assert(sl.search(i));
+
+    // Keys don't have to be ints, or default constructible
+    SkipList<std::string> words;
+    words.insert("skip");
+    words.insert("list");
+    words.insert("node");
+    assert(words.search("list") == true);
+    assert(words.search("tree") == false);
+    erased = words.erase("skip");
+    assert(erased == true);
+    assert(words.search("skip") == false);
+    assert(words.size() == 2);
+
+    runMapTests();
+    runFingerTests();
 
     std::cout << "All tests passed successfully!\n";
 }
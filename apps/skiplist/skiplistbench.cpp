@@ -0,0 +1,89 @@
+//
+// File:   skiplistbench.cpp
+// Author: Your Glorious Instructor
+// Purpose:
+// Measure how ConcurrentSkipList scales with threads on a mixed workload,
+// next to a std::set protected by a single mutex.
+//
+// Usage: skiplistbench [maxThreads] [keys] [opsPerThread] [readPercent]
+// Defaults: hardware threads, 1M keys, 1M operations per thread, 90% reads
+// with the rest split evenly between inserts and erases.
+//
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+#include "concurrent_skiplist.hpp"
+
+// Run `threads` copies of work(threadIndex) together; return seconds taken.
+template <typename Work>
+double runThreads(int threads, Work work) {
+    std::vector<std::thread> pool;
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < threads; ++t) pool.emplace_back(work, t);
+    for (auto& th : pool) th.join();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char* argv[]) {
+    int maxThreads = (argc > 1) ? std::atoi(argv[1])
+                                : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    long keys = (argc > 2) ? std::atol(argv[2]) : 1000000;
+    long ops = (argc > 3) ? std::atol(argv[3]) : 1000000;
+    int readPercent = (argc > 4) ? std::atoi(argv[4]) : 90;
+
+    std::cout << "keys in [0, " << 2 * keys << "), " << ops << " ops/thread, "
+              << readPercent << "% reads\n"
+              << std::setw(8) << "threads" << std::setw(20) << "skiplist Mops/s"
+              << std::setw(20) << "locked set Mops/s" << "\n";
+
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        ConcurrentSkipList<long> skiplist;
+        std::set<long> lockedSet;
+        std::mutex setLock;
+        std::atomic<long> sink{ 0 };
+        for (long k = 0; k < 2 * keys; k += 2) {
+            skiplist.insert(k);
+            lockedSet.insert(k);
+        }
+
+        auto mixed = [&](auto contains, auto insert, auto erase) {
+            return [&, contains, insert, erase](int t) {
+                std::mt19937_64 gen(372 + t);
+                std::uniform_int_distribution<long> keyDist(0, 2 * keys - 1);
+                std::uniform_int_distribution<int> opDist(0, 99);
+                long hits = 0;
+                for (long i = 0; i < ops; ++i) {
+                    long k = keyDist(gen);
+                    int op = opDist(gen);
+                    if (op < readPercent) hits += contains(k);
+                    else if ((op - readPercent) % 2 == 0) hits += insert(k);
+                    else hits += erase(k);
+                }
+                // Keep the compiler from throwing away lookups nobody reads
+                sink.fetch_add(hits, std::memory_order_relaxed);
+            };
+        };
+
+        double skipSecs = runThreads(threads, mixed(
+            [&](long k) { return skiplist.contains(k); },
+            [&](long k) { return skiplist.insert(k); },
+            [&](long k) { return skiplist.erase(k); }));
+        double setSecs = runThreads(threads, mixed(
+            [&](long k) { std::lock_guard<std::mutex> g(setLock); return lockedSet.count(k) == 1; },
+            [&](long k) { std::lock_guard<std::mutex> g(setLock); return lockedSet.insert(k).second; },
+            [&](long k) { std::lock_guard<std::mutex> g(setLock); return lockedSet.erase(k) == 1; }));
+
+        double total = static_cast<double>(ops) * threads / 1e6;
+        std::cout << std::setw(8) << threads << std::fixed << std::setprecision(2)
+                  << std::setw(20) << total / skipSecs << std::setw(20) << total / setSecs << "\n";
+    }
+    return 0;
+}
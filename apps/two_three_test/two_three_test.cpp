@@ -5,6 +5,9 @@
 //   This file is used to test the TwoThreeTree class.
 //
 #include <iostream>
+#include <random>
+#include <set>
+#include <string>
 #include <gtest/gtest.h>
 #include "two_three_tree.hpp"
 
@@ -44,3 +47,84 @@ TEST(TwoThreeTreeTest, EmptyTreeSearch) {
     TwoThreeTree<int> tree;
     EXPECT_FALSE(tree.search(1).has_value());
 }
+
+TEST(TwoThreeTreeTest, InsertKeepsTreeValid) {
+    TwoThreeTree<int> tree;
+    for (int i = 0; i < 1000; ++i) {
+        tree.insert((i * 389) % 1000);
+        ASSERT_TRUE(tree.isValid()) << "after inserting " << (i * 389) % 1000;
+    }
+    for (int k = 0; k < 1000; ++k) EXPECT_TRUE(tree.search(k).has_value());
+    EXPECT_FALSE(tree.search(1000).has_value());
+}
+
+TEST(TwoThreeTreeTest, DuplicateInsertIsIgnored) {
+    TwoThreeTree<int> tree;
+    tree.insert(10);
+    tree.insert(10);
+    EXPECT_TRUE(tree.erase(10));
+    EXPECT_FALSE(tree.search(10).has_value());
+    EXPECT_FALSE(tree.erase(10));
+}
+
+TEST(TwoThreeTreeTest, EraseLeafAndInternalKeys) {
+    TwoThreeTree<int> tree;
+    for (int k : { 10, 20, 30, 5, 15, 25, 35 }) tree.insert(k);
+
+    EXPECT_TRUE(tree.erase(5));     // leaf
+    EXPECT_TRUE(tree.erase(20));    // internal
+    EXPECT_FALSE(tree.erase(40));   // not there
+    EXPECT_TRUE(tree.isValid());
+    EXPECT_FALSE(tree.search(5).has_value());
+    EXPECT_FALSE(tree.search(20).has_value());
+    for (int k : { 10, 15, 25, 30, 35 }) EXPECT_TRUE(tree.search(k).has_value());
+}
+
+TEST(TwoThreeTreeTest, EraseEverythingShrinksTree) {
+    TwoThreeTree<int> tree;
+    for (int k = 1; k <= 500; ++k) tree.insert(k);
+    for (int k = 1; k <= 500; k += 2) {
+        EXPECT_TRUE(tree.erase(k));
+        ASSERT_TRUE(tree.isValid()) << "after erasing " << k;
+    }
+    for (int k = 500; k >= 2; k -= 2) {
+        EXPECT_TRUE(tree.erase(k));
+        ASSERT_TRUE(tree.isValid()) << "after erasing " << k;
+    }
+    EXPECT_FALSE(tree.search(250).has_value());
+    EXPECT_FALSE(tree.erase(1));
+    tree.insert(42);
+    EXPECT_TRUE(tree.search(42).has_value());
+}
+
+TEST(TwoThreeTreeTest, ChurnMatchesStdSet) {
+    TwoThreeTree<int> tree;
+    std::set<int> expected;
+    std::mt19937 gen(23);
+    for (int i = 0; i < 20000; ++i) {
+        int k = static_cast<int>(gen() % 2000);
+        if (gen() % 2 == 0) {
+            tree.insert(k);
+            expected.insert(k);
+        } else {
+            ASSERT_EQ(tree.erase(k), expected.erase(k) == 1);
+        }
+    }
+    EXPECT_TRUE(tree.isValid());
+    for (int k = 0; k < 2000; ++k) EXPECT_EQ(tree.search(k).has_value(), expected.count(k) == 1);
+}
+
+TEST(TwoThreeTreeTest, NonIntKeys) {
+    TwoThreeTree<std::string> tree;
+    for (const char* w : { "pear", "apple", "fig", "kiwi", "plum", "date" }) tree.insert(w);
+    EXPECT_EQ(tree.search("kiwi").value(), "kiwi");
+    EXPECT_FALSE(tree.search("lime").has_value());
+    EXPECT_TRUE(tree.erase("apple"));
+    EXPECT_FALSE(tree.search("apple").has_value());
+
+    TwoThreeTree<double> reals;
+    reals.insert(1.25);
+    reals.insert(1.75);
+    EXPECT_TRUE(reals.search(1.75).has_value());   // would match 1 if truncated
+    EXPECT_FALSE(reals.search(1.0).has_value());
+}
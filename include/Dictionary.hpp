@@ -4,28 +4,128 @@
 // Purpose:
 // A simplified implementation of the Dictionary ADT
 //
+// The entries live in an immutable Tree, so every change makes a new
+// version of the tree that shares most of its nodes with the old one, and
+// old versions stay intact for as long as someone holds them.  That makes
+// versions cheap:
+//
+//     Dictionary<std::string, int> config;      // owned by one writer
+//     config.insert("timeout", 30);
+//
+//     auto view = config.snapshot();            // any thread, O(1)
+//     int t = view.at("timeout");               // no locks, ever
+//
+// snapshot() hands back a DictionaryView, a read-only copy of the current
+// version.  Later writes make new versions and never touch the one a view
+// holds, so a thread can read its view for as long as it likes and always
+// sees one consistent state.
+//
+// A Dictionary has a single writer.  Writes publish the new version with
+// Tree::atomicStore, and snapshot() picks it up with Tree::atomicLoad, so
+// other threads may call snapshot() while the writer is busy.  Everything
+// else on the Dictionary itself (at, size, ...) belongs to the writer's
+// thread; other threads read through their snapshots.
+//
+// Keys are ordered by Compare, std::less<> unless you say otherwise.  That
+// comparator is transparent, so lookups take anything that compares with
+// a KeyType: a Dictionary<std::string, V> can be searched with a
+// std::string_view or a string literal without building a std::string.
+// Lookups walk the tree without copying or allocating anything, and hand
+// back references into it.
+//
+// Iterating visits the entries (Pairs, with the key in first and the value
+// in second) in key order, reading them in place.  lower_bound, upper_bound,
+// range(lo, hi) and, for string keys, prefix(p) start and stop the walk
+// where a query needs.  Iterators and references from a view are good for
+// as long as the view; from the Dictionary itself, only until its next
+// write, so long scans belong on a snapshot.
+//
+// fromSorted builds a Dictionary straight from entries that are already
+// in key order, balanced and in O(n).  DictionaryFile.hpp uses it to load
+// dictionaries saved to a binary file, and keeps the file code (and its
+// POSIX headers) out of here.
+//
 #pragma once
 #include <iostream>
 #include <stdexcept>
 #include <functional>
 #include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
 #include "Tree.hpp"
 #include "Pair.hpp"
 
-template <typename KeyType, typename ValueType>
-class Dictionary {
-private:
+template <typename KeyType, typename ValueType, typename Compare = std::less<>>
+class Dictionary;
+
+//
+// A read-only version of a Dictionary.  Copying one is O(1), and
+// references it hands out stay good for as long as it (or a copy) lives.
+//
+template <typename KeyType, typename ValueType, typename Compare = std::less<>>
+class DictionaryView {
+protected:
 	using KeyValueType = Pair<KeyType, ValueType>;
 	Tree<KeyValueType> dictTree;
 
+	friend class Dictionary<KeyType, ValueType, Compare>;
+	explicit DictionaryView(Tree<KeyValueType> tree) : dictTree(std::move(tree)) {}
+
+	// Orders entries by key, and compares a lone key with an entry.
+	struct EntryLess {
+		template <typename K>
+		static const K& keyOf(const K& key) { return key; }
+		static const KeyType& keyOf(const KeyValueType& entry) { return entry.first; }
+
+		template <typename A, typename B>
+		bool operator()(const A& lhs, const B& rhs) const {
+			return Compare()(keyOf(lhs), keyOf(rhs));
+		}
+	};
+
+	template <typename K, typename = void>
+	struct IsTransparent : std::false_type {};
+	template <typename K>
+	struct IsTransparent<K, std::void_t<typename K::is_transparent>> : std::true_type {};
+
+	//
+	// What lookups accept: with a transparent Compare, anything it can
+	// compare with a KeyType; otherwise, anything that converts to one.
+	//
+	template <typename K>
+	using LookupKey = std::enable_if_t<IsTransparent<Compare>::value || std::is_convertible_v<const K&, const KeyType&>>;
+
+	// The entry for key, or nullptr.
+	template <typename K>
+	const KeyValueType* locate(const K& key) const {
+		if constexpr (IsTransparent<Compare>::value) {
+			return dictTree.search(key, EntryLess());
+		} else {
+			const KeyType& converted = key;
+			return dictTree.search(converted, EntryLess());
+		}
+	}
+
 public:
-	// Always be explicit about taking the defaults for special member functions.
-	Dictionary() = default;
-	Dictionary(const Dictionary<KeyType, ValueType>& other) = default;
-	Dictionary(Dictionary<KeyType, ValueType>&& other) = default;
-	Dictionary<KeyType, ValueType>& operator=(const Dictionary<KeyType, ValueType>& other) = default;
-	Dictionary<KeyType, ValueType>& operator=(Dictionary<KeyType, ValueType>&& other) = default;
-	~Dictionary() = default;
+	using const_iterator = typename Tree<KeyValueType>::const_iterator;
+	using iterator = const_iterator;
+
+	// A pair of iterators to use in a range-based for.
+	struct Range {
+		const_iterator first;
+		const_iterator last;
+		const_iterator begin() const { return first; }
+		const_iterator end() const { return last; }
+	};
+
+	DictionaryView() = default;
+	DictionaryView(const DictionaryView<KeyType, ValueType, Compare>& other) = default;
+	DictionaryView(DictionaryView<KeyType, ValueType, Compare>&& other) = default;
+	DictionaryView<KeyType, ValueType, Compare>& operator=(const DictionaryView<KeyType, ValueType, Compare>& other) = default;
+	DictionaryView<KeyType, ValueType, Compare>& operator=(DictionaryView<KeyType, ValueType, Compare>&& other) = default;
+	~DictionaryView() = default;
 
 	bool empty() const {
 		return dictTree.isEmpty();
@@ -35,25 +135,170 @@ public:
 		return dictTree.size();
 	}
 
-	void insert(KeyType key, ValueType value) {
-		Pair<KeyType, ValueType> newEntry = MakePair(key, value);
-		dictTree = dictTree.insert(newEntry);
-	}
-	
-	ValueType& at(const KeyType& item) {
-		auto compareFirst = [](const KeyValueType& lhs, const KeyValueType& rhs) {
-			return lhs.first < rhs.first;
-			};
-		Tree<KeyValueType> resultTree;
-		bool wasFound = dictTree.find(KeyValueType(item, ValueType()), resultTree, compareFirst);
-		if (!wasFound) {
+	// The value for key, or nothing if key isn't there.
+	template <typename K, typename = LookupKey<K>>
+	std::optional<std::reference_wrapper<const ValueType>> find(const K& key) const {
+		const KeyValueType* entry = locate(key);
+		if (!entry) {
+			return std::nullopt;
+		}
+		return std::cref(entry->second);
+	}
+
+	template <typename K, typename = LookupKey<K>>
+	bool contains(const K& key) const {
+		return locate(key) != nullptr;
+	}
+
+	template <typename K, typename = LookupKey<K>>
+	const ValueType& at(const K& key) const {
+		const KeyValueType* entry = locate(key);
+		if (!entry) {
 			throw std::out_of_range("Key not found in dictionary");
 		}
-		return resultTree.root().second;
+		return entry->second;
 	}
-		
-	ValueType& operator[](const KeyType& item) {
-		return at(item);
+
+	template <typename K, typename = LookupKey<K>>
+	const ValueType& operator[](const K& key) const {
+		return at(key);
+	}
+
+	const_iterator begin() const {
+		return dictTree.begin();
+	}
+
+	const_iterator end() const {
+		return dictTree.end();
 	}
 
+	// The first entry whose key is not less than key.
+	template <typename K, typename = LookupKey<K>>
+	const_iterator lower_bound(const K& key) const {
+		if constexpr (IsTransparent<Compare>::value) {
+			return dictTree.lowerBound(key, EntryLess());
+		} else {
+			const KeyType& converted = key;
+			return dictTree.lowerBound(converted, EntryLess());
+		}
+	}
+
+	// The first entry whose key is greater than key.
+	template <typename K, typename = LookupKey<K>>
+	const_iterator upper_bound(const K& key) const {
+		if constexpr (IsTransparent<Compare>::value) {
+			return dictTree.upperBound(key, EntryLess());
+		} else {
+			const KeyType& converted = key;
+			return dictTree.upperBound(converted, EntryLess());
+		}
+	}
+
+	// The entries with lo <= key < hi, in order.
+	template <typename K1, typename K2, typename = LookupKey<K1>, typename = LookupKey<K2>>
+	Range range(const K1& lo, const K2& hi) const {
+		if (!Compare()(lo, hi)) {
+			return Range{end(), end()};
+		}
+		return Range{lower_bound(lo), lower_bound(hi)};
+	}
+
+	//
+	// The entries whose keys start with p, in order.  Keys have to be
+	// strings in their usual order, so the matches sit together between p
+	// and the first string after all of them: p with its last character
+	// bumped up by one (dropping trailing '\xff's, which can't be).
+	//
+	Range prefix(std::string_view p) const {
+		static_assert(std::is_same_v<KeyType, std::string> &&
+		              (std::is_same_v<Compare, std::less<>> || std::is_same_v<Compare, std::less<std::string>>),
+		              "prefix() needs std::string keys in the usual order");
+		std::string after(p);
+		while (!after.empty() && static_cast<unsigned char>(after.back()) == 0xff) {
+			after.pop_back();
+		}
+		if (after.empty()) {
+			return Range{lower_bound(std::string(p)), end()};
+		}
+		after.back() = static_cast<char>(static_cast<unsigned char>(after.back()) + 1);
+		return Range{lower_bound(std::string(p)), lower_bound(after)};
+	}
+};
+
+template <typename KeyType, typename ValueType, typename Compare>
+class Dictionary : public DictionaryView<KeyType, ValueType, Compare> {
+private:
+	using View = DictionaryView<KeyType, ValueType, Compare>;
+	using typename View::KeyValueType;
+	using typename View::EntryLess;
+	using View::dictTree;
+	using View::locate;
+
+	// Make tree the current version, where snapshot() can see it.
+	void publish(Tree<KeyValueType> tree) {
+		Tree<KeyValueType>::atomicStore(&dictTree, std::move(tree));
+	}
+
+public:
+	// Always be explicit about taking the defaults for special member functions.
+	// Assignment replaces the whole version, so it publishes like any write.
+	Dictionary() = default;
+	Dictionary(const Dictionary<KeyType, ValueType, Compare>& other) = default;
+	Dictionary(Dictionary<KeyType, ValueType, Compare>&& other) = default;
+	Dictionary<KeyType, ValueType, Compare>& operator=(const Dictionary<KeyType, ValueType, Compare>& other) {
+		publish(other.dictTree);
+		return *this;
+	}
+	Dictionary<KeyType, ValueType, Compare>& operator=(Dictionary<KeyType, ValueType, Compare>&& other) {
+		publish(std::move(other.dictTree));
+		return *this;
+	}
+	~Dictionary() = default;
+
+	// Add key, or give it a new value if it is already there.
+	void insert(KeyType key, ValueType value) {
+		publish(dictTree.assign(MakePair(std::move(key), std::move(value)), EntryLess()));
+	}
+
+	// The same as insert, but says whether key is new.
+	bool insert_or_assign(KeyType key, ValueType value) {
+		bool added = locate(key) == nullptr;
+		insert(std::move(key), std::move(value));
+		return added;
+	}
+
+	//
+	// Add key with the value made from args, unless key is already there,
+	// in which case nothing is built and nothing changes.  Says whether
+	// key was added.
+	//
+	template <typename... Args>
+	bool try_emplace(KeyType key, Args&&... args) {
+		if (locate(key)) {
+			return false;
+		}
+		publish(dictTree.assign(KeyValueType(std::move(key), ValueType(std::forward<Args>(args)...)), EntryLess()));
+		return true;
+	}
+
+	//
+	// A dictionary of count entries, one Pair from each call to next(),
+	// which has to hand them over in increasing key order.  The tree is
+	// built balanced in one pass rather than by inserting them one at a
+	// time.
+	//
+	template <typename Next>
+	static Dictionary<KeyType, ValueType, Compare> fromSorted(size_t count, Next next) {
+		Dictionary<KeyType, ValueType, Compare> dict;
+		dict.publish(Tree<KeyValueType>::fromSorted(count, next));
+		return dict;
+	}
+
+	//
+	// The current version, to read from any thread.  Taking one is O(1)
+	// and copies nothing; later inserts don't change it.
+	//
+	View snapshot() const {
+		return View(Tree<KeyValueType>::atomicLoad(&dictTree));
+	}
 };
@@ -0,0 +1,405 @@
+//
+// File:   DictionaryFile.hpp
+// Author: Your Glorious Instructor
+// Purpose:
+// Store a dictionary in a binary file that can be used where it lies,
+// without reading it back into a tree first.
+//
+// Rebuilding a Dictionary from text at every start means parsing every
+// line and inserting every entry, one tree path at a time.  A dictionary
+// file already holds the entries in key order, in a form that can be
+// searched as it is:
+//
+//     header    "DICTBIN1", what the keys and values are, the number of
+//               entries, the number of blocks, where the index is
+//     blocks    the entries in key order, BlockEntries to a block, each
+//               one its key and then its value
+//     index     where each block starts, as 64-bit file offsets
+//
+// A number or enum is stored as its bytes and a std::string as a 32-bit
+// length and then its characters, so entries vary in size.  The index
+// makes up for that: MappedDictionary maps the file into memory, binary
+// searches the index by the first key of each block, and reads through
+// the one block that can hold the key, all in place.  Opening one costs a
+// header check however big the file is, and a lookup touches the pages of
+// the index and of one block.  Strings are looked at as string_views into
+// the mapping, so nothing is copied until a value is handed back.
+//
+// DictionaryWriter writes the format.  saveDictionary and loadDictionary
+// go between it and a Dictionary (Dictionary.hpp):
+//
+//     saveDictionary(dict, "words.dict");
+//     auto again = loadDictionary<std::string, int>("words.dict");
+//
+// This uses POSIX mmap, through MappedFile, which is why it is a header of
+// its own rather than part of Dictionary.hpp.
+//
+#pragma once
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "Dictionary.hpp"
+#include "MappedFile.hpp"
+
+namespace dictionaryfile_detail {
+
+constexpr char Magic[8] = {'D', 'I', 'C', 'T', 'B', 'I', 'N', '1'};
+
+// Entries per block: small enough that scanning one is quick, big enough
+// that the index is a small fraction of the file.
+constexpr std::uint32_t BlockEntries = 64;
+
+struct Header {
+    char magic[8];
+    std::uint32_t keyTag;
+    std::uint32_t valueTag;
+    std::uint64_t count;
+    std::uint64_t blockCount;
+    std::uint64_t indexOffset;
+    std::uint32_t blockEntries;
+    std::uint32_t reserved;
+};
+
+static_assert(sizeof(Header) == 48, "the header is 48 bytes on disk");
+
+template <typename T>
+struct AlwaysFalse : std::false_type {};
+
+// Numbers whose bytes are the whole value.  long double has padding bytes,
+// so it can't be written this way.
+template <typename T>
+constexpr bool IsPlainNumber = std::is_arithmetic_v<T> && !std::is_same_v<T, long double>;
+
+//
+// The tag for a number type: its kind (bool, signed, unsigned or floating
+// point) and its size, so ints aren't read as floats or int64s as doubles
+// or uint64s.  An enum is tagged as its underlying type with EnumFlag set.
+//
+constexpr std::uint32_t EnumFlag = 0x10000;
+
+template <typename T>
+constexpr std::uint32_t numberTag() {
+    if constexpr (std::is_enum_v<T>) {
+        return EnumFlag | numberTag<std::underlying_type_t<T>>();
+    } else {
+        std::uint32_t kind = std::is_same_v<T, bool> ? 1 : std::is_floating_point_v<T> ? 4 : std::is_signed_v<T> ? 2 : 3;
+        return kind << 8 | static_cast<std::uint32_t>(sizeof(T));
+    }
+}
+
+} // namespace dictionaryfile_detail
+
+//
+// How one key or value is written and read.  View is what reading in
+// place gives: the value itself for a number, a string_view into the file
+// for a string.  tag goes in the header, so a file isn't read as the
+// wrong types.  Numbers, enums and std::string are supported; anything
+// else (a pointer, a string_view, a struct) doesn't compile, since its
+// bytes wouldn't mean the same thing when read back.
+//
+template <typename T, typename = void>
+struct DictionaryCodec {
+    static_assert(dictionaryfile_detail::AlwaysFalse<T>::value,
+                  "dictionary files hold numbers, enums and std::strings only");
+};
+
+template <typename T>
+struct DictionaryCodec<T, std::enable_if_t<dictionaryfile_detail::IsPlainNumber<T> || std::is_enum_v<T>>> {
+    using View = T;
+    static constexpr std::uint32_t tag = dictionaryfile_detail::numberTag<T>();
+
+    static void write(std::string& out, const T& value) {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    static T read(const char*& at, const char* end) {
+        if (static_cast<std::size_t>(end - at) < sizeof(T)) throw std::runtime_error("DictionaryFile: truncated entry");
+        T value;
+        std::memcpy(&value, at, sizeof(T));
+        at += sizeof(T);
+        return value;
+    }
+
+    static View view(const T& value) { return value; }
+    static T own(View value) { return value; }
+};
+
+template <>
+struct DictionaryCodec<std::string> {
+    using View = std::string_view;
+    static constexpr std::uint32_t tag = 0xffffffff;
+
+    static void write(std::string& out, const std::string& value) {
+        if (value.size() > std::numeric_limits<std::uint32_t>::max())
+            throw std::length_error("DictionaryFile: a string of 4GB or more can't be stored");
+        std::uint32_t length = static_cast<std::uint32_t>(value.size());
+        out.append(reinterpret_cast<const char*>(&length), sizeof length);
+        out.append(value);
+    }
+
+    static std::string_view read(const char*& at, const char* end) {
+        std::uint32_t length = DictionaryCodec<std::uint32_t>::read(at, end);
+        if (static_cast<std::size_t>(end - at) < length) throw std::runtime_error("DictionaryFile: truncated entry");
+        std::string_view value(at, length);
+        at += length;
+        return value;
+    }
+
+    static View view(const std::string& value) { return value; }
+    static std::string own(View value) { return std::string(value); }
+};
+
+//
+// Writes a dictionary file.  add() the entries in increasing key order,
+// then finish().  The file is written under a temporary name and renamed
+// into place by finish(), so a reader never sees half of one; if finish()
+// isn't reached, the temporary file is removed.
+//
+template <typename KeyType, typename ValueType>
+class DictionaryWriter {
+public:
+    explicit DictionaryWriter(const std::string& path) : path(path), temporary(path + ".tmp") {
+        out.open(temporary, std::ios::binary | std::ios::trunc);
+        if (!out) throw std::system_error(errno, std::generic_category(), "DictionaryWriter: can't create " + temporary);
+        dictionaryfile_detail::Header header{};
+        out.write(reinterpret_cast<const char*>(&header), sizeof header);
+        offset = sizeof header;
+    }
+
+    DictionaryWriter(const DictionaryWriter&) = delete;
+    DictionaryWriter& operator=(const DictionaryWriter&) = delete;
+
+    ~DictionaryWriter() {
+        if (!finished) {
+            out.close();
+            std::remove(temporary.c_str());
+        }
+    }
+
+    void add(const KeyType& key, const ValueType& value) {
+        if (count % dictionaryfile_detail::BlockEntries == 0) {
+            flushBlock();
+            blockOffsets.push_back(offset);
+        }
+        DictionaryCodec<KeyType>::write(block, key);
+        DictionaryCodec<ValueType>::write(block, value);
+        ++count;
+    }
+
+    void finish() {
+        flushBlock();
+        // The index is 8-byte aligned.
+        static const char zeros[8] = {};
+        std::uint64_t padding = (8 - offset % 8) % 8;
+        out.write(zeros, static_cast<std::streamsize>(padding));
+        dictionaryfile_detail::Header header{};
+        std::memcpy(header.magic, dictionaryfile_detail::Magic, sizeof header.magic);
+        header.keyTag = DictionaryCodec<KeyType>::tag;
+        header.valueTag = DictionaryCodec<ValueType>::tag;
+        header.count = count;
+        header.blockCount = blockOffsets.size();
+        header.indexOffset = offset + padding;
+        header.blockEntries = dictionaryfile_detail::BlockEntries;
+        out.write(reinterpret_cast<const char*>(blockOffsets.data()),
+                  static_cast<std::streamsize>(blockOffsets.size() * sizeof(std::uint64_t)));
+        out.seekp(0);
+        out.write(reinterpret_cast<const char*>(&header), sizeof header);
+        out.close();
+        if (!out) throw std::runtime_error("DictionaryWriter: writing " + temporary + " failed");
+        if (std::rename(temporary.c_str(), path.c_str()) != 0)
+            throw std::system_error(errno, std::generic_category(), "DictionaryWriter: can't rename to " + path);
+        finished = true;
+    }
+
+private:
+    void flushBlock() {
+        out.write(block.data(), static_cast<std::streamsize>(block.size()));
+        offset += block.size();
+        block.clear();
+    }
+
+    std::string path;
+    std::string temporary;
+    std::ofstream out;
+    std::string block;
+    std::vector<std::uint64_t> blockOffsets;
+    std::uint64_t offset = 0;
+    std::uint64_t count = 0;
+    bool finished = false;
+};
+
+//
+// A dictionary file, mapped into memory and searched where it lies.
+// Compare has to be the order the file was written in.  Keys are passed
+// and handed back as Views, so a MappedDictionary<std::string, V> takes
+// a std::string_view (or a std::string, or a literal).
+//
+template <typename KeyType, typename ValueType, typename Compare = std::less<>>
+class MappedDictionary {
+public:
+    using KeyView = typename DictionaryCodec<KeyType>::View;
+    using ValueView = typename DictionaryCodec<ValueType>::View;
+    using Entry = std::pair<KeyView, ValueView>;
+
+    // Visits the entries in key order, reading them one after another.
+    class const_iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = Entry;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Entry*;
+        using reference = const Entry&;
+
+        const_iterator() = default;
+
+        reference operator*() const { return entry; }
+        pointer operator->() const { return &entry; }
+
+        const_iterator& operator++() {
+            if (--remaining > 0) read();
+            return *this;
+        }
+
+        bool operator==(const const_iterator& other) const { return remaining == other.remaining; }
+        bool operator!=(const const_iterator& other) const { return remaining != other.remaining; }
+
+    private:
+        friend class MappedDictionary;
+
+        const_iterator(const char* at, const char* end, std::uint64_t remaining)
+            : at(at), end(end), remaining(remaining) {
+            if (remaining > 0) read();
+        }
+
+        void read() {
+            entry.first = DictionaryCodec<KeyType>::read(at, end);
+            entry.second = DictionaryCodec<ValueType>::read(at, end);
+        }
+
+        const char* at = nullptr;
+        const char* end = nullptr;
+        std::uint64_t remaining = 0;
+        Entry entry{};
+    };
+
+    explicit MappedDictionary(const std::string& path) : file(path, MappedFile::Access::Random) {
+        std::string_view bytes = file.text();
+        if (bytes.size() < sizeof header) throw std::runtime_error("MappedDictionary: " + path + " is too short");
+        std::memcpy(&header, bytes.data(), sizeof header);
+        if (std::memcmp(header.magic, dictionaryfile_detail::Magic, sizeof header.magic) != 0)
+            throw std::runtime_error("MappedDictionary: " + path + " is not a dictionary file");
+        if (header.keyTag != DictionaryCodec<KeyType>::tag || header.valueTag != DictionaryCodec<ValueType>::tag)
+            throw std::runtime_error("MappedDictionary: " + path + " holds different key or value types");
+        if (header.blockEntries == 0 || header.indexOffset > bytes.size() ||
+            (bytes.size() - header.indexOffset) / sizeof(std::uint64_t) < header.blockCount ||
+            header.blockCount != (header.count + header.blockEntries - 1) / header.blockEntries)
+            throw std::runtime_error("MappedDictionary: " + path + " is damaged");
+        data = bytes.data();
+        blocksEnd = data + header.indexOffset;
+    }
+
+    bool empty() const { return header.count == 0; }
+    std::size_t size() const { return static_cast<std::size_t>(header.count); }
+
+    // The value for key, or nothing if key isn't there.
+    std::optional<ValueView> find(KeyView key) const {
+        if (header.blockCount == 0) return std::nullopt;
+        // The last block whose first key is <= key.
+        std::uint64_t lo = 0, hi = header.blockCount;
+        while (hi - lo > 1) {
+            std::uint64_t mid = lo + (hi - lo) / 2;
+            const char* at = blockStart(mid);
+            if (less(key, DictionaryCodec<KeyType>::read(at, blocksEnd))) hi = mid;
+            else lo = mid;
+        }
+        const char* at = blockStart(lo);
+        for (std::uint64_t i = 0; i < entriesIn(lo); ++i) {
+            KeyView stored = DictionaryCodec<KeyType>::read(at, blocksEnd);
+            ValueView value = DictionaryCodec<ValueType>::read(at, blocksEnd);
+            if (less(key, stored)) break;
+            if (!less(stored, key)) return value;
+        }
+        return std::nullopt;
+    }
+
+    bool contains(KeyView key) const { return find(key).has_value(); }
+
+    ValueView at(KeyView key) const {
+        std::optional<ValueView> value = find(key);
+        if (!value) throw std::out_of_range("Key not found in dictionary");
+        return *value;
+    }
+
+    const_iterator begin() const {
+        return header.count ? const_iterator(blockStart(0), blocksEnd, header.count) : const_iterator();
+    }
+    const_iterator end() const { return const_iterator(); }
+
+private:
+    // Compare the views directly if Compare can, otherwise as KeyTypes.
+    static bool less(const KeyView& lhs, const KeyView& rhs) {
+        if constexpr (std::is_invocable_r_v<bool, Compare, const KeyView&, const KeyView&>) {
+            return Compare()(lhs, rhs);
+        } else {
+            return Compare()(DictionaryCodec<KeyType>::own(lhs), DictionaryCodec<KeyType>::own(rhs));
+        }
+    }
+
+    const char* blockStart(std::uint64_t block) const {
+        std::uint64_t offset;
+        std::memcpy(&offset, data + header.indexOffset + block * sizeof offset, sizeof offset);
+        if (offset < sizeof header || offset > header.indexOffset)
+            throw std::runtime_error("MappedDictionary: damaged index");
+        return data + offset;
+    }
+
+    std::uint64_t entriesIn(std::uint64_t block) const {
+        return std::min<std::uint64_t>(header.blockEntries, header.count - block * header.blockEntries);
+    }
+
+    MappedFile file;
+    dictionaryfile_detail::Header header{};
+    const char* data = nullptr;
+    const char* blocksEnd = nullptr;
+};
+
+// Write every entry of dict (a Dictionary or a snapshot of one) to path as
+// a dictionary file, replacing whatever was there.
+template <typename KeyType, typename ValueType, typename Compare>
+void saveDictionary(const DictionaryView<KeyType, ValueType, Compare>& dict, const std::string& path) {
+    DictionaryWriter<KeyType, ValueType> writer(path);
+    for (const auto& entry : dict) {
+        writer.add(entry.first, entry.second);
+    }
+    writer.finish();
+}
+
+//
+// Read a dictionary file written by saveDictionary back into a Dictionary.
+// The entries are already in order, so the tree is built balanced in O(n).
+//
+template <typename KeyType, typename ValueType, typename Compare = std::less<>>
+Dictionary<KeyType, ValueType, Compare> loadDictionary(const std::string& path) {
+    MappedDictionary<KeyType, ValueType, Compare> file(path);
+    auto entry = file.begin();
+    return Dictionary<KeyType, ValueType, Compare>::fromSorted(file.size(), [&] {
+        Pair<KeyType, ValueType> pair(DictionaryCodec<KeyType>::own(entry->first),
+                                      DictionaryCodec<ValueType>::own(entry->second));
+        ++entry;
+        return pair;
+    });
+}
@@ -0,0 +1,161 @@
+//
+// File:   ExpBatch.hpp
+// Author: <Your Glorious Instructor>
+// Purpose:
+// Evaluate a whole file of expressions, one per line, using every core.
+//
+// The file is mapped into memory (MappedFile) rather than read, so the
+// parser works straight on the operating system's copy of it and lines
+// are just string_views.  evaluateBatch cuts the text into chunks of about
+// a megabyte, each ending at the end of a line, and a handful of worker
+// threads take chunks one after another, parse and evaluate each line
+// (ExpParser.hpp, with no tree and no allocation), and format the results
+// into a string per chunk.  The calling thread writes those strings out in
+// chunk order, so the output has one line per input line, in input order,
+// no matter which thread finished first.
+//
+// A line that isn't an expression gets "error: ..." as its result, and an
+// empty line gets an empty one, so the lines still match up.  Workers are
+// kept at most a few chunks ahead of the writer, which bounds the memory
+// held by finished results that haven't been written yet.
+//
+// This uses POSIX mmap, through MappedFile.
+//
+#pragma once
+#include <algorithm>
+#include <charconv>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "ExpParser.hpp"
+#include "MappedFile.hpp"
+
+struct BatchStats {
+    std::size_t lines = 0;    // expressions read, including bad ones
+    std::size_t errors = 0;   // lines that weren't expressions
+};
+
+//
+// Cut text into pieces of about chunkBytes each, every one ending just
+// after a newline (or at the end of the text).
+//
+inline std::vector<std::string_view> splitLines(std::string_view text, std::size_t chunkBytes) {
+    std::vector<std::string_view> chunks;
+    chunkBytes = std::max<std::size_t>(chunkBytes, 1);
+    while (!text.empty()) {
+        std::size_t end = text.size();
+        if (chunkBytes < text.size()) {
+            std::size_t newline = text.find('\n', chunkBytes - 1);
+            if (newline != std::string_view::npos) end = newline + 1;
+        }
+        chunks.push_back(text.substr(0, end));
+        text.remove_prefix(end);
+    }
+    return chunks;
+}
+
+//
+// Evaluate each line of chunk and append its result, and a newline, to
+// out.  Results are written in the shortest form that reads back as the
+// same double.
+//
+inline BatchStats evaluateChunk(std::string_view chunk, std::string& out) {
+    BatchStats stats;
+    while (!chunk.empty()) {
+        std::size_t end = chunk.find('\n');
+        std::string_view line = chunk.substr(0, end);
+        chunk.remove_prefix(end == std::string_view::npos ? chunk.size() : end + 1);
+        ++stats.lines;
+
+        if (line.find_first_not_of(" \t\r") == std::string_view::npos) {
+            out += '\n';
+            continue;
+        }
+        try {
+            ExpEvalBuilder builder;
+            double value = parseExpression(line, builder);
+            char buffer[32];
+            auto result = std::to_chars(buffer, buffer + sizeof buffer, value);
+            out.append(buffer, result.ptr);
+        } catch (const std::exception& e) {
+            ++stats.errors;
+            out += "error: ";
+            out += e.what();
+        }
+        out += '\n';
+    }
+    return stats;
+}
+
+//
+// Evaluate every line of text on threads worker threads (0 means one per
+// core) and write the results to out in input order.
+//
+inline BatchStats evaluateBatch(std::string_view text, unsigned threads, std::ostream& out,
+                                std::size_t chunkBytes = 1 << 20) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::string_view> chunks = splitLines(text, chunkBytes);
+    // A worker per chunk is as many as can ever be busy.
+    threads = static_cast<unsigned>(std::max<std::size_t>(1, std::min<std::size_t>(threads, chunks.size())));
+
+    // How far ahead of the writer the workers may get.
+    const std::size_t window = 4 * static_cast<std::size_t>(threads);
+
+    std::vector<std::string> results(chunks.size());
+    std::vector<BatchStats> counts(chunks.size());
+    std::vector<char> ready(chunks.size(), 0);
+    std::size_t nextChunk = 0;   // the next one a worker should take
+    std::size_t written = 0;     // chunks the writer is finished with
+    std::mutex lock;
+    std::condition_variable changed;
+
+    auto work = [&] {
+        std::unique_lock<std::mutex> guard(lock);
+        while (true) {
+            changed.wait(guard, [&] { return nextChunk >= chunks.size() || nextChunk < written + window; });
+            if (nextChunk >= chunks.size()) return;
+            std::size_t mine = nextChunk++;
+            guard.unlock();
+
+            std::string result;
+            result.reserve(chunks[mine].size());
+            BatchStats stats = evaluateChunk(chunks[mine], result);
+
+            guard.lock();
+            results[mine] = std::move(result);
+            counts[mine] = stats;
+            ready[mine] = 1;
+            changed.notify_all();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i < threads; ++i) workers.emplace_back(work);
+
+    BatchStats total;
+    for (std::size_t i = 0; i < chunks.size(); ++i) {
+        std::string result;
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            changed.wait(guard, [&] { return ready[i] != 0; });
+            result = std::move(results[i]);
+        }
+        out.write(result.data(), static_cast<std::streamsize>(result.size()));
+        total.lines += counts[i].lines;
+        total.errors += counts[i].errors;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            written = i + 1;
+        }
+        changed.notify_all();
+    }
+
+    for (auto& worker : workers) worker.join();
+    return total;
+}
@@ -0,0 +1,300 @@
+//
+// File:   ExpBytecode.hpp
+// Author: <Your Glorious Instructor>
+// Purpose:
+// Compile an expression tree into bytecode for a small stack machine, so
+// an expression that is evaluated many times only pays for walking the
+// tree once.
+//
+// evalExpTree (ExpNode.hpp) copies a Tree handle and an ExpNode, string and
+// all, at every node, and works out which operator it has by comparing
+// strings.  compileExpTree does that walk a single time and writes out the
+// tree in postfix order: a number becomes "push this constant", a variable
+// becomes "push the value in this slot", and an operator becomes one
+// opcode that pops two values and pushes the result.  For example
+// ((x+3)*4) compiles to
+//
+//     load 0       variables: [x]
+//     const 0      constants: [3, 4]
+//     add
+//     const 1
+//     mul
+//
+// ExpProgram::run() then just loops over that array with a switch.  The
+// compiler also works out how deep the stack can get, so run() never has
+// to check for overflow or grow anything.
+//
+// A tree from optimizeExpTree (ExpOptimize.hpp) can have subtrees with
+// more than one parent.  The first time such a subtree is reached its
+// code is emitted as usual followed by "save" into a temporary; after
+// that it is just "reuse" of the temporary, so each common subexpression
+// is computed once per run.
+//
+// runBatch() evaluates the expression for many rows of input at once,
+// with one array (column) per variable.  It runs the same code, but every
+// stack entry is a block of BatchRows values rather than one, so each
+// instruction becomes a simple loop over a block that the compiler turns
+// into SIMD arithmetic, and the cost of decoding the instruction is spread
+// over the whole block.
+//
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "ExpNode.hpp"
+
+enum class OpCode : std::uint8_t { Const, Load, Add, Sub, Mul, Div, Save, Reuse };
+
+struct Instruction {
+    OpCode op;
+    // Index into the constant pool for Const, the slot for Load, the
+    // temporary for Save (copy the top of the stack there) and Reuse
+    // (push it).
+    std::uint32_t arg;
+};
+
+class ExpProgram {
+public:
+    // Rows evaluated together by runBatch().
+    static constexpr std::size_t BatchRows = 256;
+
+    // Evaluate the expression.  vars holds the value of each variable, in
+    // the order of variables(); it may be null if there are none.
+    double run(const double* vars = nullptr) const {
+        double local[InlineStack];
+        std::vector<double> big;
+        double* stack = local;
+        if (depth + temps > InlineStack) {
+            big.resize(depth + temps);
+            stack = big.data();
+        }
+        double* temp = stack + depth;
+        stack[0] = 0;
+
+        // top points just past the value on top of the stack.
+        double* top = stack;
+        const double* pool = pool_.data();
+        for (const Instruction& ins : code_) {
+            switch (ins.op) {
+            case OpCode::Const: *top++ = pool[ins.arg]; break;
+            case OpCode::Load: *top++ = vars[ins.arg]; break;
+            case OpCode::Add: --top; top[-1] += *top; break;
+            case OpCode::Sub: --top; top[-1] -= *top; break;
+            case OpCode::Mul: --top; top[-1] *= *top; break;
+            case OpCode::Div: --top; top[-1] /= *top; break;
+            case OpCode::Save: temp[ins.arg] = top[-1]; break;
+            case OpCode::Reuse: *top++ = temp[ins.arg]; break;
+            }
+        }
+        return stack[0];
+    }
+
+    // Look the variables up by name; missing ones throw out_of_range.
+    double run(const ExpVariables& vars) const {
+        std::vector<double> values;
+        for (const std::string& name : names) values.push_back(vars.at(name));
+        return run(values.data());
+    }
+
+    //
+    // Evaluate the expression for rows rows: out[r] gets the result with
+    // each variable i set to columns[i][r].  columns is in the order of
+    // variables(), and out must have room for rows values.
+    //
+    void runBatch(const double* const* columns, std::size_t rows, double* out) const {
+        std::vector<double> space((depth + temps) * BatchRows);
+        double* temp = space.data() + depth * BatchRows;
+        const double* pool = pool_.data();
+        for (std::size_t first = 0; first < rows; first += BatchRows) {
+            std::size_t n = std::min(BatchRows, rows - first);
+
+            // top points just past the block on top of the stack.
+            double* top = space.data();
+            for (const Instruction& ins : code_) {
+                switch (ins.op) {
+                case OpCode::Const:
+                    std::fill(top, top + n, pool[ins.arg]);
+                    top += BatchRows;
+                    break;
+                case OpCode::Load:
+                    std::copy(columns[ins.arg] + first, columns[ins.arg] + first + n, top);
+                    top += BatchRows;
+                    break;
+                case OpCode::Add:
+                    top -= BatchRows;
+                    combine(top - BatchRows, top, n, [](double a, double b) { return a + b; });
+                    break;
+                case OpCode::Sub:
+                    top -= BatchRows;
+                    combine(top - BatchRows, top, n, [](double a, double b) { return a - b; });
+                    break;
+                case OpCode::Mul:
+                    top -= BatchRows;
+                    combine(top - BatchRows, top, n, [](double a, double b) { return a * b; });
+                    break;
+                case OpCode::Div:
+                    top -= BatchRows;
+                    combine(top - BatchRows, top, n, [](double a, double b) { return a / b; });
+                    break;
+                case OpCode::Save:
+                    std::copy(top - BatchRows, top - BatchRows + n, temp + ins.arg * BatchRows);
+                    break;
+                case OpCode::Reuse:
+                    std::copy(temp + ins.arg * BatchRows, temp + ins.arg * BatchRows + n, top);
+                    top += BatchRows;
+                    break;
+                }
+            }
+            std::copy(space.data(), space.data() + n, out + first);
+        }
+    }
+
+    const std::vector<Instruction>& code() const { return code_; }
+    const std::vector<double>& constants() const { return pool_; }
+
+    // The names of the variables, in slot order (the order they first
+    // appear in the expression).
+    const std::vector<std::string>& variables() const { return names; }
+
+    // The slot for the variable called name, or -1 if the expression
+    // doesn't use it.
+    int slot(const std::string& name) const {
+        auto found = std::find(names.begin(), names.end(), name);
+        return found == names.end() ? -1 : static_cast<int>(found - names.begin());
+    }
+
+    // The most values run() ever has on its stack at once.
+    std::size_t stackDepth() const { return depth; }
+
+    // The number of common subexpressions kept in temporaries.
+    std::size_t temporaries() const { return temps; }
+
+private:
+    friend ExpProgram compileExpTree(const TreeOfExpNodes& tree);
+
+    // Expressions shallower than this run on a stack in run()'s own frame.
+    static constexpr std::size_t InlineStack = 64;
+
+    // lhs[i] = f(lhs[i], rhs[i]) for a block.  The two blocks never
+    // overlap, and saying so lets the compiler vectorize the loop without
+    // checking.
+    template <typename Func>
+    static void combine(double* __restrict lhs, const double* __restrict rhs, std::size_t n, Func f) {
+        for (std::size_t i = 0; i < n; ++i) lhs[i] = f(lhs[i], rhs[i]);
+    }
+
+    // A program that hasn't been compiled into is "const 0", which is what
+    // an empty tree compiles to, so run() always has a value to return.
+    std::vector<Instruction> code_{{OpCode::Const, 0}};
+    std::vector<double> pool_{0.0};
+    std::vector<std::string> names;
+    std::size_t depth = 1;
+    std::size_t temps = 0;
+};
+
+namespace expbytecode_detail {
+
+inline OpCode opcodeFor(const std::string& op) {
+    if (op == "+") return OpCode::Add;
+    if (op == "-") return OpCode::Sub;
+    if (op == "*") return OpCode::Mul;
+    if (op == "/") return OpCode::Div;
+    throw std::invalid_argument("compileExpTree: bad operator \"" + op + "\"");
+}
+
+struct Emitter {
+    std::vector<Instruction>& code;
+    std::vector<double>& pool;
+    std::vector<std::string>& names;
+    std::size_t& temps;
+
+    // How many parents each operator node has, and the temporary holding
+    // the value of each shared one that has been computed already.
+    std::unordered_map<const void*, int> parents;
+    std::unordered_map<const void*, std::uint32_t> saved;
+
+    void countParents(const TreeOfExpNodes& tree) {
+        if (tree.isEmpty() || tree.root().nodetype != OPERATOR) return;
+        if (parents[tree.identity()]++ > 0) return;
+        countParents(tree.left());
+        countParents(tree.right());
+    }
+
+    std::uint32_t slotFor(const std::string& name) {
+        auto found = std::find(names.begin(), names.end(), name);
+        if (found != names.end()) return static_cast<std::uint32_t>(found - names.begin());
+        names.push_back(name);
+        return static_cast<std::uint32_t>(names.size() - 1);
+    }
+
+    // Append the code for tree, which starts running with height values
+    // already on the stack.  Returns the deepest the stack gets.
+    std::size_t emit(const TreeOfExpNodes& tree, std::size_t height) {
+        ExpNode node = tree.root();
+        if (node.nodetype == NUMBER) {
+            code.push_back({OpCode::Const, static_cast<std::uint32_t>(pool.size())});
+            pool.push_back(node.operand);
+            return height + 1;
+        }
+        if (node.nodetype == VARIABLE) {
+            code.push_back({OpCode::Load, slotFor(node.op)});
+            return height + 1;
+        }
+        if (node.nodetype != OPERATOR) throw std::invalid_argument("compileExpTree: bad node in expression tree");
+        auto done = saved.find(tree.identity());
+        if (done != saved.end()) {
+            code.push_back({OpCode::Reuse, done->second});
+            return height + 1;
+        }
+        TreeOfExpNodes left = tree.left();
+        TreeOfExpNodes right = tree.right();
+        if (left.isEmpty() || right.isEmpty())
+            throw std::invalid_argument("compileExpTree: operator " + node.op + " is missing an operand");
+        OpCode op = opcodeFor(node.op);
+        std::size_t leftDepth = emit(left, height);
+        std::size_t rightDepth = emit(right, height + 1);
+        code.push_back({op, 0});
+        if (parents[tree.identity()] > 1) {
+            auto temp = static_cast<std::uint32_t>(temps++);
+            code.push_back({OpCode::Save, temp});
+            saved.emplace(tree.identity(), temp);
+        }
+        return std::max(leftDepth, rightDepth);
+    }
+};
+
+} // namespace expbytecode_detail
+
+//
+// Compile tree.  Like evalExpTree, an empty tree evaluates to 0.  Throws
+// invalid_argument if an operator is unknown or lacks an operand, rather
+// than finding out on every evaluation.
+//
+inline ExpProgram compileExpTree(const TreeOfExpNodes& tree) {
+    ExpProgram program;
+    if (tree.isEmpty()) return program;
+    program.code_.clear();
+    program.pool_.clear();
+    expbytecode_detail::Emitter emitter{program.code_, program.pool_, program.names, program.temps, {}, {}};
+    emitter.countParents(tree);
+    program.depth = emitter.emit(tree, 0);
+    return program;
+}
+
+// List the instructions one per line, as in the example at the top.
+inline std::ostream& operator<<(std::ostream& os, const ExpProgram& program) {
+    static const char* const names[] = {"const", "load", "add", "sub", "mul", "div", "save", "reuse"};
+    for (const Instruction& ins : program.code()) {
+        os << names[static_cast<int>(ins.op)];
+        if (ins.op == OpCode::Const) os << ' ' << ins.arg << "\t; " << program.constants()[ins.arg];
+        if (ins.op == OpCode::Load) os << ' ' << ins.arg << "\t; " << program.variables()[ins.arg];
+        if (ins.op == OpCode::Save || ins.op == OpCode::Reuse) os << ' ' << ins.arg;
+        os << '\n';
+    }
+    return os;
+}
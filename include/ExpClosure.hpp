@@ -0,0 +1,205 @@
+//
+// File:   ExpClosure.hpp
+// Author: <Your Glorious Instructor>
+// Purpose:
+// Compile an expression tree into a tree of closures: small nodes that
+// each carry a pointer to the one function that evaluates them, with
+// their operands already bound in.
+//
+// evalExpTree looks at every node's type and compares its operator string
+// on every evaluation.  compileClosure makes those decisions once.  A +
+// node becomes a node whose function is "add my left and my right", a
+// variable becomes "read slot 2", and so on.  Calling the result is just
+// following function pointers, one per node, with no switch and no
+// strings.  Common shapes get their own functions, so x*2 is one call
+// (left operand times a constant kept in the node) rather than three.
+//
+// That sits between the bytecode in ExpBytecode.hpp, which has one loop
+// and a switch but no calls, and the compile-time expressions in
+// ExpStatic.hpp, where the compiler sees the whole formula.  It works on
+// trees built at run time, and a tree from optimizeExpTree keeps its
+// sharing: a shared subtree is one closure node with several parents.
+//
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "ExpNode.hpp"
+
+class ExpClosure {
+public:
+    ExpClosure(ExpClosure&&) = default;
+    ExpClosure& operator=(ExpClosure&&) = default;
+    ExpClosure(const ExpClosure&) = delete;
+    ExpClosure& operator=(const ExpClosure&) = delete;
+
+    // Evaluate with vars holding the variables in slot order; it may be
+    // null if there are none.
+    double operator()(const double* vars = nullptr) const { return root->call(vars); }
+
+    // Look the variables up by name; missing ones throw out_of_range.
+    double operator()(const ExpVariables& vars) const {
+        std::vector<double> values;
+        for (const std::string& name : names) values.push_back(vars.at(name));
+        return root->call(values.data());
+    }
+
+    // Like ExpProgram::runBatch: out[r] gets the value with variable i set
+    // to columns[i][r].
+    void runBatch(const double* const* columns, std::size_t rows, double* out) const {
+        std::vector<double> vars(names.size());
+        for (std::size_t r = 0; r < rows; ++r) {
+            for (std::size_t i = 0; i < vars.size(); ++i) vars[i] = columns[i][r];
+            out[r] = root->call(vars.data());
+        }
+    }
+
+    // The names of the variables, in slot order (the order they first
+    // appear in the expression), as for compileExpTree.
+    const std::vector<std::string>& variables() const { return names; }
+
+    // The number of closure nodes.
+    std::size_t size() const { return nodes.size(); }
+
+private:
+    friend ExpClosure compileClosure(const TreeOfExpNodes& tree);
+
+    ExpClosure() = default;
+
+    struct Node {
+        double (*fn)(const Node*, const double*);
+        const Node* left = nullptr;
+        const Node* right = nullptr;
+        double value = 0;         // a constant operand
+        std::uint32_t slot = 0;   // a variable
+
+        double call(const double* vars) const { return fn(this, vars); }
+    };
+
+    // The functions a node can have.  Op is std::plus<> and friends.
+    static double constant(const Node* n, const double*) { return n->value; }
+    static double variable(const Node* n, const double* vars) { return vars[n->slot]; }
+    template <typename Op>
+    static double both(const Node* n, const double* vars) {
+        return Op()(n->left->call(vars), n->right->call(vars));
+    }
+    template <typename Op>
+    static double constantLeft(const Node* n, const double* vars) {
+        return Op()(n->value, n->right->call(vars));
+    }
+    template <typename Op>
+    static double constantRight(const Node* n, const double* vars) {
+        return Op()(n->left->call(vars), n->value);
+    }
+    template <typename Op>
+    static double variableRight(const Node* n, const double* vars) {
+        return Op()(n->left->call(vars), vars[n->slot]);
+    }
+
+    class Builder {
+    public:
+        explicit Builder(ExpClosure& closure) : closure(closure) {}
+
+        const Node* build(const TreeOfExpNodes& tree) {
+            auto done = built.find(tree.identity());
+            if (done != built.end()) return done->second;
+            const Node* node = make(tree);
+            built.emplace(tree.identity(), node);
+            return node;
+        }
+
+    private:
+        const Node* make(const TreeOfExpNodes& tree) {
+            ExpNode exp = tree.root();
+            Node node;
+            if (exp.nodetype == NUMBER) {
+                node.fn = constant;
+                node.value = exp.operand;
+                return add(node);
+            }
+            if (exp.nodetype == VARIABLE) {
+                node.fn = variable;
+                node.slot = slotFor(exp.op);
+                return add(node);
+            }
+            if (exp.nodetype != OPERATOR) throw std::invalid_argument("compileClosure: bad node in expression tree");
+            if (tree.left().isEmpty() || tree.right().isEmpty())
+                throw std::invalid_argument("compileClosure: operator " + exp.op + " is missing an operand");
+            if (exp.op == "+") return binary<std::plus<>>(tree);
+            if (exp.op == "-") return binary<std::minus<>>(tree);
+            if (exp.op == "*") return binary<std::multiplies<>>(tree);
+            if (exp.op == "/") return binary<std::divides<>>(tree);
+            throw std::invalid_argument("compileClosure: bad operator \"" + exp.op + "\"");
+        }
+
+        // Pick the function for an operator node from the shapes of its
+        // operands.  The left one is built first so variables get their
+        // slots in order.
+        template <typename Op>
+        const Node* binary(const TreeOfExpNodes& tree) {
+            TreeOfExpNodes left = tree.left();
+            TreeOfExpNodes right = tree.right();
+            Node node;
+            if (left.root().nodetype == NUMBER && right.root().nodetype != NUMBER) {
+                node.fn = constantLeft<Op>;
+                node.value = left.root().operand;
+                node.right = build(right);
+            } else if (right.root().nodetype == NUMBER) {
+                node.fn = constantRight<Op>;
+                node.left = build(left);
+                node.value = right.root().operand;
+            } else if (right.root().nodetype == VARIABLE) {
+                node.fn = variableRight<Op>;
+                node.left = build(left);
+                node.slot = slotFor(right.root().op);
+            } else {
+                node.fn = both<Op>;
+                node.left = build(left);
+                node.right = build(right);
+            }
+            return add(node);
+        }
+
+        std::uint32_t slotFor(const std::string& name) {
+            auto& names = closure.names;
+            auto found = std::find(names.begin(), names.end(), name);
+            if (found != names.end()) return static_cast<std::uint32_t>(found - names.begin());
+            names.push_back(name);
+            return static_cast<std::uint32_t>(names.size() - 1);
+        }
+
+        // A deque never moves what it holds, so nodes can point at each
+        // other.
+        const Node* add(const Node& node) {
+            closure.nodes.push_back(node);
+            return &closure.nodes.back();
+        }
+
+        ExpClosure& closure;
+        std::unordered_map<const void*, const Node*> built;
+    };
+
+    std::deque<Node> nodes;
+    const Node* root = nullptr;
+    std::vector<std::string> names;
+};
+
+//
+// Compile tree into closures.  Like evalExpTree, an empty tree evaluates
+// to 0.  Throws invalid_argument if an operator is unknown or lacks an
+// operand.  The result can be moved but not copied, since its nodes point
+// at each other.
+//
+inline ExpClosure compileClosure(const TreeOfExpNodes& tree) {
+    ExpClosure closure;
+    ExpClosure::Builder builder(closure);
+    closure.root = tree.isEmpty() ? builder.build(TreeOfExpNodes(TreeOfExpNodes(), ExpNode(0.0), TreeOfExpNodes()))
+                                  : builder.build(tree);
+    return closure;
+}
@@ -0,0 +1,250 @@
+//
+// File:   ExpCompact.hpp
+// Author: <Your Glorious Instructor>
+// Purpose:
+// Store an expression in one array of 16-byte nodes instead of a Tree of
+// ExpNodes.
+//
+// An ExpNode holds a type tag, a double and a std::string, 48 bytes even
+// for a number, and each one sits in its own Tree node next to two
+// shared_ptrs and an edit stamp, allocated separately with a reference
+// count, well over 100 bytes in all.  A CompactExp node is
+//
+//     1 byte   what it is: a number, a variable or one of + - * /
+//     8 bytes  the number, the variable's slot, or for an operator the
+//              array positions of its two operands (32 bits each)
+//
+// padded to 16 bytes, and all the nodes of an expression are in one
+// std::vector.  Operands always come before the operators that use them,
+// so evaluating is a single loop from the front of the array to the root,
+// each node's value going into the matching place of a scratch array of
+// doubles.  There is no recursion, and no pointer to chase.
+//
+// Nodes are hash-consed as they are added: asking for a node that is
+// already there (same kind, same number or same operands) gives back the
+// existing one, so repeated subexpressions are stored once, and being in
+// the array once, are also evaluated once.
+//
+// CompactExp is also a Builder for parseExpression (ExpParser.hpp), so
+// text can go straight into the array without building a Tree first.
+//
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "ExpNode.hpp"
+#include "ExpParser.hpp"
+
+enum class ExpCompactOp : std::uint8_t { Number, Variable, Add, Sub, Mul, Div };
+
+struct ExpCompactNode {
+    ExpCompactOp op;
+    union {
+        double value;          // Number
+        std::uint32_t slot;    // Variable
+        struct {
+            std::uint32_t left, right;
+        } operands;            // the operators
+    };
+};
+
+static_assert(sizeof(ExpCompactNode) == 16, "ExpCompactNode should be 16 bytes");
+
+class CompactExp {
+public:
+    // Builder interface: each returns the position of the node.
+    using Value = std::uint32_t;
+
+    std::uint32_t number(double value) {
+        ExpCompactNode node{ExpCompactOp::Number, {}};
+        node.value = value;
+        std::uint64_t bits;
+        std::memcpy(&bits, &value, sizeof bits);
+        return intern(node, bits);
+    }
+
+    std::uint32_t variable(std::string_view name) {
+        ExpCompactNode node{ExpCompactOp::Variable, {}};
+        node.slot = slotFor(name);
+        return intern(node, node.slot);
+    }
+
+    std::uint32_t binary(char op, std::uint32_t left, std::uint32_t right) {
+        ExpCompactNode node{opFor(op), {}};
+        if (left >= nodes.size() || right >= nodes.size())
+            throw std::out_of_range("CompactExp: operand is not a node");
+        node.operands.left = left;
+        node.operands.right = right;
+        return intern(node, (std::uint64_t(left) << 32) | right);
+    }
+
+    // Which node is the whole expression.  parseCompactExp and fromTree set
+    // it; a client building by hand sets it when done.
+    void setRoot(std::uint32_t node) {
+        if (node >= nodes.size()) throw std::out_of_range("CompactExp: root is not a node");
+        root_ = node;
+    }
+    std::uint32_t root() const { return root_; }
+
+    //
+    // Evaluate with vars holding the variables in slot order (it may be
+    // null if there are none).  scratch is resized to hold a value per
+    // node; passing the same one each time saves allocating it.
+    //
+    double evaluate(const double* vars, std::vector<double>& scratch) const {
+        if (nodes.empty()) return 0;
+        scratch.resize(nodes.size());
+        double* values = scratch.data();
+        const ExpCompactNode* node = nodes.data();
+        for (std::uint32_t i = 0; i <= root_; ++i, ++node) {
+            switch (node->op) {
+            case ExpCompactOp::Number: values[i] = node->value; break;
+            case ExpCompactOp::Variable: values[i] = vars[node->slot]; break;
+            case ExpCompactOp::Add: values[i] = values[node->operands.left] + values[node->operands.right]; break;
+            case ExpCompactOp::Sub: values[i] = values[node->operands.left] - values[node->operands.right]; break;
+            case ExpCompactOp::Mul: values[i] = values[node->operands.left] * values[node->operands.right]; break;
+            case ExpCompactOp::Div: values[i] = values[node->operands.left] / values[node->operands.right]; break;
+            }
+        }
+        return values[root_];
+    }
+
+    double evaluate(const double* vars = nullptr) const {
+        std::vector<double> scratch;
+        return evaluate(vars, scratch);
+    }
+
+    // Look the variables up by name; missing ones throw out_of_range.
+    double evaluate(const ExpVariables& vars) const {
+        std::vector<double> values;
+        for (const std::string& name : names) values.push_back(vars.at(name));
+        return evaluate(values.data());
+    }
+
+    const std::vector<ExpCompactNode>& nodeArray() const { return nodes; }
+    std::size_t size() const { return nodes.size(); }
+
+    // The names of the variables, in slot order (the order they were first
+    // added).
+    const std::vector<std::string>& variables() const { return names; }
+
+    // Memory used by the nodes and the hash-consing table, roughly.
+    std::size_t bytes() const {
+        return nodes.capacity() * sizeof(ExpCompactNode) +
+               table.size() * (sizeof(Key) + sizeof(std::uint32_t) + 2 * sizeof(void*)) +
+               table.bucket_count() * sizeof(void*);
+    }
+
+    // Drop the hash-consing table, once nothing more will be added.
+    // Adding afterwards still works, but no longer finds repeats made
+    // before.
+    void freeze() {
+        table = decltype(table)();
+        nodes.shrink_to_fit();
+    }
+
+    // Copy an expression tree in, sharing repeated subtrees.
+    static CompactExp fromTree(const TreeOfExpNodes& tree);
+
+private:
+    static ExpCompactOp opFor(char op) {
+        switch (op) {
+        case '+': return ExpCompactOp::Add;
+        case '-': return ExpCompactOp::Sub;
+        case '*': return ExpCompactOp::Mul;
+        case '/': return ExpCompactOp::Div;
+        default: throw std::invalid_argument(std::string("CompactExp: bad operator \"") + op + "\"");
+        }
+    }
+
+    // A node's kind and its 8 bytes of payload, as the hash-consing key.
+    struct Key {
+        ExpCompactOp op;
+        std::uint64_t payload;
+        bool operator==(const Key& other) const { return op == other.op && payload == other.payload; }
+    };
+
+    struct KeyHash {
+        std::size_t operator()(const Key& key) const {
+            std::uint64_t h = (key.payload ^ (std::uint64_t(key.op) << 56)) * 0x9e3779b97f4a7c15ULL;
+            return static_cast<std::size_t>(h ^ (h >> 32));
+        }
+    };
+
+    std::uint32_t intern(const ExpCompactNode& node, std::uint64_t payload) {
+        auto [found, added] = table.try_emplace(Key{node.op, payload}, static_cast<std::uint32_t>(nodes.size()));
+        if (added) {
+            if (nodes.size() == std::numeric_limits<std::uint32_t>::max()) {
+                table.erase(found);
+                throw std::length_error("CompactExp: too many nodes");
+            }
+            nodes.push_back(node);
+        }
+        return found->second;
+    }
+
+    std::uint32_t slotFor(std::string_view name) {
+        auto found = std::find(names.begin(), names.end(), name);
+        if (found != names.end()) return static_cast<std::uint32_t>(found - names.begin());
+        names.emplace_back(name);
+        return static_cast<std::uint32_t>(names.size() - 1);
+    }
+
+    std::vector<ExpCompactNode> nodes;
+    std::vector<std::string> names;
+    std::unordered_map<Key, std::uint32_t, KeyHash> table;
+    std::uint32_t root_ = 0;
+};
+
+namespace expcompact_detail {
+
+inline std::uint32_t copyTree(CompactExp& exp, const TreeOfExpNodes& tree,
+                              std::unordered_map<const void*, std::uint32_t>& done) {
+    auto found = done.find(tree.identity());
+    if (found != done.end()) return found->second;
+    ExpNode node = tree.root();
+    std::uint32_t result;
+    if (node.nodetype == NUMBER) {
+        result = exp.number(node.operand);
+    } else if (node.nodetype == VARIABLE) {
+        result = exp.variable(node.op);
+    } else {
+        if (node.nodetype != OPERATOR) throw std::invalid_argument("CompactExp: bad node in expression tree");
+        if (tree.left().isEmpty() || tree.right().isEmpty())
+            throw std::invalid_argument("CompactExp: operator " + node.op + " is missing an operand");
+        if (node.op.size() != 1) throw std::invalid_argument("CompactExp: bad operator \"" + node.op + "\"");
+        std::uint32_t left = copyTree(exp, tree.left(), done);
+        std::uint32_t right = copyTree(exp, tree.right(), done);
+        result = exp.binary(node.op[0], left, right);
+    }
+    done.emplace(tree.identity(), result);
+    return result;
+}
+
+} // namespace expcompact_detail
+
+//
+// Like compileExpTree: an empty tree evaluates to 0, and an unknown
+// operator or a missing operand throws invalid_argument.
+//
+inline CompactExp CompactExp::fromTree(const TreeOfExpNodes& tree) {
+    CompactExp exp;
+    std::unordered_map<const void*, std::uint32_t> done;
+    exp.setRoot(tree.isEmpty() ? exp.number(0) : expcompact_detail::copyTree(exp, tree, done));
+    return exp;
+}
+
+// Parse text straight into a CompactExp.  Mistakes throw ExpSyntaxError.
+inline CompactExp parseCompactExp(std::string_view text) {
+    CompactExp exp;
+    exp.setRoot(parseExpression(text, exp));
+    return exp;
+}
@@ -0,0 +1,124 @@
+//
+// File:   ExpNode.hpp
+// Author: <Your Glorious Instructor>
+// Purpose:
+// The nodes of an expression tree, and the straightforward way of
+// evaluating one: walk the tree recursively and apply each operator to the
+// values of its two subtrees.  A leaf is either a number or a named
+// variable, whose value is looked up when the tree is evaluated.  By
+// intent, we don't use inheritance here as we're using the Tree rather
+// than extending it.
+//
+// Pulled out of apps/ExpTree so the bytecode compiler in ExpBytecode.hpp
+// and the benchmarks can share it.
+//
+#pragma once
+#include <functional>
+#include <iostream>
+#include <map>
+#include <string>
+#include "Tree.hpp"
+
+enum NodeTypes { NUMBER, OPERATOR, VARIABLE };
+
+// We define an ExpNode to represent a node in the expression tree.
+// It can either be a number (operand) or an operator (op), or a variable
+// (whose name is kept in op, e.g. ExpNode(VARIABLE, 0, "x")).
+// The new C++ feature here is the use of the spaceship operator (<=>) for comparison,
+// which allows us to compare ExpNode objects based on their members.  Note that this requires
+// C++20 or later.  The compiler sees this and generates the necessary comparison operators for us.
+struct ExpNode {
+    NodeTypes nodetype;
+    double operand;
+    std::string op;
+    ExpNode(NodeTypes typ, double opd = 0, std::string opr = "") :nodetype(typ), operand(opd), op(opr) {}
+    ExpNode(double opd): nodetype(NUMBER), operand(opd), op("") {}
+    ExpNode(std::string op): nodetype(OPERATOR), operand(0.0), op(op) {}
+    ExpNode() : nodetype(NUMBER), operand(0.0), op("") {}
+    auto operator<=>(const ExpNode& rhs) const = default;
+};
+
+inline void printNode(ExpNode aNode) {
+    if (aNode.nodetype == NUMBER) { std::cout << aNode.operand << " ";}
+    else if (aNode.nodetype == OPERATOR || aNode.nodetype == VARIABLE) {std::cout << aNode.op << " "; }
+    else { std::cout << "BAD NODE IN EXP TREE\n"; }
+}
+
+// We define a TreeOfExpNodes as a Tree of ExpNode objects. Cuts down on the line noise.
+using TreeOfExpNodes = Tree<ExpNode>;
+
+// The values of the variables in an expression, by name.  std::less<>
+// lets a parser look names up by string_view without making a string.
+using ExpVariables = std::map<std::string, double, std::less<>>;
+
+// This function computes the result of applying an operator to two operands.
+inline double computeOp(std::string op, double leftrand, double rightrand) {
+    double result = 0.0;
+    if (op == "+") {
+        result = leftrand + rightrand;
+    }
+    else if (op == "-") {
+        result = leftrand - rightrand;
+    }
+    else if (op == "*") {
+        result = leftrand * rightrand;
+    }
+    else if (op == "/") {
+        result = leftrand / rightrand;
+    }
+    else {
+        std::cerr << "Bad operator in expression, operator was " << op << std::endl;
+    }
+    return result;
+}
+
+//
+// Algorithm:
+// Do an in-order traversal of the tree (note: will
+// need to adjust the return type of the function)
+//
+// If anExpTree is not empty
+//    if anExpTree. root is an operand
+//       return that value
+//    else if anExpTree. root is a variable
+//       return its value from vars
+//    else
+//        A = evalExpTRee(anExpTree.left())
+//        B = evalExpTree(anExpTree.right())
+//        Op = anExpTree.root()
+//        return A Op B
+//
+// This re-walks the tree and re-decodes every operator string each time it
+// is called.  To evaluate the same expression over and over, compile it
+// once with compileExpTree (ExpBytecode.hpp) and run the result instead.
+//
+inline double evalExpTree(TreeOfExpNodes anExpTree, const ExpVariables& vars = {}) {
+    if (!anExpTree.isEmpty()) {
+        if (anExpTree.root().nodetype == NUMBER) {
+            return anExpTree.root().operand;
+        }
+        else if (anExpTree.root().nodetype == VARIABLE) {
+            auto found = vars.find(anExpTree.root().op);
+            if (found == vars.end()) {
+                std::cerr << "Error: No value for variable " << anExpTree.root().op << std::endl;
+                return 0;
+            }
+            return found->second;
+        }
+        else {
+            // We have an operator node, so we need to evaluate the left and right subtrees
+            // and then apply the operator to the results.
+            if (anExpTree.left().isEmpty() || anExpTree.right().isEmpty()) {
+                std::cerr << "Error: Operator node with empty subtree(s)." << std::endl;
+                return 0; // or throw an exception
+            }
+            double A = evalExpTree(anExpTree.left(), vars);
+            double B = evalExpTree(anExpTree.right(), vars);
+            ExpNode opnode = anExpTree.root();
+            return computeOp(opnode.op, A, B);
+        }
+    }
+    else {
+        return 0;
+    }
+}
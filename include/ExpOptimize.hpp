@@ -0,0 +1,154 @@
+//
+// File:   ExpOptimize.hpp
+// Author: <Your Glorious Instructor>
+// Purpose:
+// Simplify an expression tree before it is evaluated or compiled.
+//
+// buildExpTree gives back the tree exactly as it was typed, so (2*3)+x
+// multiplies 2 by 3 on every evaluation, and a subexpression written out
+// twice is worked out twice.  optimizeExpTree rebuilds the tree from the
+// bottom up and along the way
+//
+//   - folds constants: an operator whose operands are both numbers is
+//     replaced by its result, so (2*3)+x becomes 6+x;
+//
+//   - applies identities that don't change the result: x+0, 0+x, x-0,
+//     x*1, 1*x and x/1 all become x.  (The only difference is that x+0
+//     with x = -0 would have been +0.)  Rewrites that floating point
+//     doesn't honour, such as x*0 = 0 (not if x is infinite) or
+//     (x+1)+2 = x+3 (rounding), are left alone;
+//
+//   - shares identical subtrees ("hash-consing").  Tree nodes are
+//     immutable, so two copies of the same subexpression can be one node
+//     with two parents.  Every node is looked up in a table keyed by its
+//     contents and the identities of its (already shared) children before
+//     a new one is made, so the result is a DAG with each distinct
+//     subexpression stored once.
+//
+// compileExpTree (ExpBytecode.hpp) notices shared nodes and evaluates each
+// one only once per run, which is where the sharing pays off.
+//
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include "ExpNode.hpp"
+
+namespace expoptimize_detail {
+
+class Optimizer {
+public:
+    TreeOfExpNodes optimize(const TreeOfExpNodes& tree) {
+        if (tree.isEmpty()) return tree;
+        // The input may itself share subtrees; do each one once.
+        auto done = finished.find(tree.identity());
+        if (done != finished.end()) return done->second;
+
+        ExpNode node = tree.root();
+        TreeOfExpNodes result;
+        if (node.nodetype != OPERATOR || tree.left().isEmpty() || tree.right().isEmpty()) {
+            // A leaf, or a broken operator left for the compiler to report.
+            result = intern(tree.left(), node, tree.right());
+        } else {
+            result = simplify(node, optimize(tree.left()), optimize(tree.right()));
+        }
+        finished.emplace(tree.identity(), result);
+        return result;
+    }
+
+private:
+    static bool isNumber(const TreeOfExpNodes& tree, double value) {
+        return tree.root().nodetype == NUMBER && tree.root().operand == value;
+    }
+
+    TreeOfExpNodes simplify(const ExpNode& node, const TreeOfExpNodes& left, const TreeOfExpNodes& right) {
+        // Leave an unknown operator for compileExpTree to complain about.
+        if (node.op != "+" && node.op != "-" && node.op != "*" && node.op != "/")
+            return intern(left, node, right);
+        if (left.root().nodetype == NUMBER && right.root().nodetype == NUMBER) {
+            double value = computeOp(node.op, left.root().operand, right.root().operand);
+            return intern(TreeOfExpNodes(), ExpNode(value), TreeOfExpNodes());
+        }
+        if (node.op == "+") {
+            if (isNumber(right, 0)) return left;
+            if (isNumber(left, 0)) return right;
+        } else if (node.op == "-") {
+            if (isNumber(right, 0)) return left;
+        } else if (node.op == "*") {
+            if (isNumber(right, 1)) return left;
+            if (isNumber(left, 1)) return right;
+        } else if (node.op == "/") {
+            if (isNumber(right, 1)) return left;
+        }
+        return intern(left, node, right);
+    }
+
+    // Everything that makes a node what it is.  The children are already
+    // shared, so comparing their identities compares the whole subtrees.
+    struct Key {
+        NodeTypes nodetype;
+        std::uint64_t bits;   // of the operand, so 0 and -0 differ and NaN matches itself
+        std::string op;
+        const void* left;
+        const void* right;
+
+        bool operator==(const Key& other) const {
+            return nodetype == other.nodetype && bits == other.bits && op == other.op &&
+                   left == other.left && right == other.right;
+        }
+    };
+
+    struct KeyHash {
+        std::size_t operator()(const Key& key) const {
+            std::size_t h = std::hash<std::uint64_t>()(key.bits);
+            auto mix = [&h](std::size_t v) { h ^= v + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2); };
+            mix(static_cast<std::size_t>(key.nodetype));
+            mix(std::hash<std::string>()(key.op));
+            mix(std::hash<const void*>()(key.left));
+            mix(std::hash<const void*>()(key.right));
+            return h;
+        }
+    };
+
+    // The one node with these contents, made the first time it's asked for.
+    TreeOfExpNodes intern(const TreeOfExpNodes& left, const ExpNode& node, const TreeOfExpNodes& right) {
+        Key key{node.nodetype, 0, node.op, left.identity(), right.identity()};
+        std::memcpy(&key.bits, &node.operand, sizeof key.bits);
+        auto found = table.find(key);
+        if (found != table.end()) return found->second;
+        TreeOfExpNodes made(left, node, right);
+        table.emplace(std::move(key), made);
+        return made;
+    }
+
+    std::unordered_map<Key, TreeOfExpNodes, KeyHash> table;
+    std::unordered_map<const void*, TreeOfExpNodes> finished;
+};
+
+} // namespace expoptimize_detail
+
+//
+// Fold constants, apply the identities above, and share identical
+// subtrees.  The result evaluates to the same value as tree for any
+// values of its variables.  tree itself is not changed.
+//
+inline TreeOfExpNodes optimizeExpTree(const TreeOfExpNodes& tree) {
+    return expoptimize_detail::Optimizer().optimize(tree);
+}
+
+// The number of distinct nodes in tree, counting a shared subtree once.
+// For a tree with no sharing this is the same as tree.size().
+inline std::size_t expDagSize(const TreeOfExpNodes& tree) {
+    std::unordered_set<const void*> seen;
+    std::function<void(const TreeOfExpNodes&)> visit = [&](const TreeOfExpNodes& t) {
+        if (t.isEmpty() || !seen.insert(t.identity()).second) return;
+        visit(t.left());
+        visit(t.right());
+    };
+    visit(tree);
+    return seen.size();
+}
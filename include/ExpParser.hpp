@@ -0,0 +1,294 @@
+//
+// File:   ExpParser.hpp
+// Author: <Your Glorious Instructor>
+// Purpose:
+// Read arithmetic expressions such as 2*(x+1.5)/y out of a string.
+//
+// simplecalc and ExpTree used to read their input a character at a time
+// with istream::peek and ignore, pushing numbers and operators on stacks
+// and only doing anything at a ')', so every operation had to be written
+// in parentheses.  This is one parser for both of them:
+//
+//   - ExpTokenizer splits a std::string_view into numbers, names,
+//     operators and parentheses.  Tokens point into the text rather than
+//     copying it, and numbers are converted with std::from_chars, so
+//     nothing is allocated.  The text can be a std::string, a line of a
+//     memory-mapped file, or anything else that stays put while it is
+//     parsed.
+//
+//   - parseExpression reads the usual grammar, with * and / binding
+//     tighter than + and -, all four grouping left to right, parentheses,
+//     and a leading minus sign:
+//
+//         expression := term (('+' | '-') term)*
+//         term       := factor (('*' | '/') factor)*
+//         factor     := number | name | '(' expression ')' | '-' factor
+//
+//     It does this by precedence climbing: parse one operand, then keep
+//     taking operators as long as they bind at least as tightly as the
+//     level we're at.  A fully parenthesized expression, the old input
+//     format, parses to the same thing it always did.
+//
+//   - What happens to each piece is up to a Builder, which has a Value
+//     type and three functions:
+//
+//         Value number(double value);
+//         Value variable(std::string_view name);
+//         Value binary(char op, Value lhs, Value rhs);
+//
+//     The parser calls them in postfix order, as each piece is completed.
+//     ExpEvalBuilder works the answer out as it goes (Value is double), so
+//     parsing and evaluating allocates nothing at all; ExpTreeBuilder
+//     builds a TreeOfExpNodes.
+//
+// Mistakes throw ExpSyntaxError, which says where in the text they are.
+//
+#pragma once
+#include <cctype>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include "ExpNode.hpp"
+
+// A mistake in an expression, at offset position() in the text.
+class ExpSyntaxError : public std::invalid_argument {
+public:
+    ExpSyntaxError(const std::string& what, std::size_t position)
+        : std::invalid_argument(what + " at position " + std::to_string(position)), where(position) {}
+    std::size_t position() const { return where; }
+
+private:
+    std::size_t where;
+};
+
+enum class ExpTokenKind : std::uint8_t { Number, Name, Operator, LeftParen, RightParen, End };
+
+struct ExpToken {
+    ExpTokenKind kind = ExpTokenKind::End;
+    char op = 0;              // for Operator: one of + - * /
+    double value = 0;         // for Number
+    std::string_view text;    // the characters of the token
+    std::size_t position = 0; // where it starts in the text
+};
+
+//
+// Hands out the tokens of text one at a time.  peek() is the current
+// token and next() returns it and moves on; after the last token comes
+// one of kind End, as many times as you ask.
+//
+class ExpTokenizer {
+public:
+    explicit ExpTokenizer(std::string_view text) : text(text) { scan(); }
+
+    const ExpToken& peek() const { return current; }
+
+    ExpToken next() {
+        ExpToken token = current;
+        scan();
+        return token;
+    }
+
+private:
+    static bool isNameStart(char c) { return std::isalpha(static_cast<unsigned char>(c)) || c == '_'; }
+    static bool isNameChar(char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_'; }
+    static bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+    void scan() {
+        while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\r')) ++pos;
+        current = ExpToken();
+        current.position = pos;
+        if (pos == text.size()) return;
+
+        char c = text[pos];
+        std::size_t start = pos;
+        if (isDigit(c) || c == '.') {
+            const char* first = text.data() + pos;
+            auto [end, error] = std::from_chars(first, text.data() + text.size(), current.value);
+            if (error != std::errc()) throw ExpSyntaxError("bad number", pos);
+            pos += static_cast<std::size_t>(end - first);
+            current.kind = ExpTokenKind::Number;
+        } else if (isNameStart(c)) {
+            while (pos < text.size() && isNameChar(text[pos])) ++pos;
+            current.kind = ExpTokenKind::Name;
+        } else if (c == '+' || c == '-' || c == '*' || c == '/') {
+            ++pos;
+            current.kind = ExpTokenKind::Operator;
+            current.op = c;
+        } else if (c == '(') {
+            ++pos;
+            current.kind = ExpTokenKind::LeftParen;
+        } else if (c == ')') {
+            ++pos;
+            current.kind = ExpTokenKind::RightParen;
+        } else {
+            throw ExpSyntaxError(std::string("unexpected character '") + c + "'", pos);
+        }
+        current.text = text.substr(start, pos - start);
+    }
+
+    std::string_view text;
+    std::size_t pos = 0;
+    ExpToken current;
+};
+
+namespace expparser_detail {
+
+template <typename Builder>
+class Parser {
+public:
+    using Value = typename Builder::Value;
+
+    Parser(std::string_view text, Builder& builder) : tokens(text), builder(builder) {}
+
+    Value parse() {
+        Value result = expression(0);
+        if (tokens.peek().kind != ExpTokenKind::End) fail("expected an operator");
+        return result;
+    }
+
+private:
+    // Parentheses nested deeper than this are refused rather than risk
+    // running out of stack.
+    static constexpr int MaxNesting = 1000;
+
+    static int precedence(char op) { return op == '*' || op == '/' ? 2 : 1; }
+
+    [[noreturn]] void fail(const std::string& what) const {
+        const ExpToken& token = tokens.peek();
+        if (token.kind == ExpTokenKind::End) throw ExpSyntaxError(what + ", found the end", token.position);
+        throw ExpSyntaxError(what + ", found '" + std::string(token.text) + "'", token.position);
+    }
+
+    // Operands joined by operators that bind at least as tightly as
+    // minPrecedence.
+    Value expression(int minPrecedence) {
+        Value lhs = factor();
+        while (tokens.peek().kind == ExpTokenKind::Operator && precedence(tokens.peek().op) >= minPrecedence) {
+            char op = tokens.next().op;
+            // Only tighter operators go into the right operand, which is
+            // what makes a-b-c mean (a-b)-c.
+            Value rhs = expression(precedence(op) + 1);
+            lhs = builder.binary(op, std::move(lhs), std::move(rhs));
+        }
+        return lhs;
+    }
+
+    Value factor() {
+        const ExpToken& token = tokens.peek();
+        switch (token.kind) {
+        case ExpTokenKind::Number:
+            return builder.number(tokens.next().value);
+        case ExpTokenKind::Name:
+            return builder.variable(tokens.next().text);
+        case ExpTokenKind::LeftParen: {
+            if (++nesting > MaxNesting) fail("parentheses nested too deeply");
+            tokens.next();
+            Value inside = expression(0);
+            if (tokens.peek().kind != ExpTokenKind::RightParen) fail("expected ')'");
+            tokens.next();
+            --nesting;
+            return inside;
+        }
+        case ExpTokenKind::Operator:
+            if (token.op == '-') {
+                if (++nesting > MaxNesting) fail("too many minus signs");
+                tokens.next();
+                // -2 is just the number; -x is 0-x.
+                if (tokens.peek().kind == ExpTokenKind::Number) {
+                    --nesting;
+                    return builder.number(-tokens.next().value);
+                }
+                Value zero = builder.number(0);
+                Value operand = factor();
+                --nesting;
+                return builder.binary('-', std::move(zero), std::move(operand));
+            }
+            break;
+        default:
+            break;
+        }
+        fail("expected a number, a name or '('");
+    }
+
+    ExpTokenizer tokens;
+    Builder& builder;
+    int nesting = 0;
+};
+
+} // namespace expparser_detail
+
+// Parse text, handing the pieces to builder, and return what it builds
+// for the whole expression.
+template <typename Builder>
+typename Builder::Value parseExpression(std::string_view text, Builder& builder) {
+    return expparser_detail::Parser<Builder>(text, builder).parse();
+}
+
+//
+// Works the value out while parsing.  Variables are looked up in vars,
+// which must outlast the builder; one that isn't there (or any variable,
+// if there is no vars) throws out_of_range.
+//
+class ExpEvalBuilder {
+public:
+    using Value = double;
+
+    ExpEvalBuilder() = default;
+    explicit ExpEvalBuilder(const ExpVariables& vars) : vars(&vars) {}
+
+    double number(double value) { return value; }
+
+    double variable(std::string_view name) {
+        if (vars) {
+            auto found = vars->find(name);
+            if (found != vars->end()) return found->second;
+        }
+        throw std::out_of_range("no value for variable " + std::string(name));
+    }
+
+    double binary(char op, double lhs, double rhs) {
+        switch (op) {
+        case '+': return lhs + rhs;
+        case '-': return lhs - rhs;
+        case '*': return lhs * rhs;
+        default: return lhs / rhs;
+        }
+    }
+
+private:
+    const ExpVariables* vars = nullptr;
+};
+
+// Builds the expression tree.
+class ExpTreeBuilder {
+public:
+    using Value = TreeOfExpNodes;
+
+    TreeOfExpNodes number(double value) { return leaf(ExpNode(value)); }
+
+    TreeOfExpNodes variable(std::string_view name) { return leaf(ExpNode(VARIABLE, 0, std::string(name))); }
+
+    TreeOfExpNodes binary(char op, TreeOfExpNodes lhs, TreeOfExpNodes rhs) {
+        return TreeOfExpNodes(lhs, ExpNode(std::string(1, op)), rhs);
+    }
+
+private:
+    static TreeOfExpNodes leaf(const ExpNode& node) { return TreeOfExpNodes(TreeOfExpNodes(), node, TreeOfExpNodes()); }
+};
+
+// Parse and evaluate text in one go.
+inline double evaluateExpression(std::string_view text, const ExpVariables& vars = ExpVariables()) {
+    ExpEvalBuilder builder(vars);
+    return parseExpression(text, builder);
+}
+
+// Parse text into an expression tree.
+inline TreeOfExpNodes parseExpTree(std::string_view text) {
+    ExpTreeBuilder builder;
+    return parseExpression(text, builder);
+}
@@ -0,0 +1,290 @@
+//
+// File:   ExpStatic.hpp
+// Author: <Your Glorious Instructor>
+// Purpose:
+// Turn an expression written in the program text into ordinary compiled
+// code, with nothing left to interpret when it runs.
+//
+//     constexpr auto f = staticExpression<"(x*2.5 + y) / (y*y + 1)">;
+//     double a = f(3.0, 4.0);             // x = 3, y = 4
+//     static_assert(staticExpression<"2*(3+4)">() == 14);
+//
+// The string is a template argument (a C++20 class-type template
+// parameter), so the compiler parses it while it compiles the program,
+// using the same grammar as ExpParser.hpp: the four operators with the
+// usual precedence, parentheses, names, numbers and a leading minus sign.
+// A mistake in the string is a compile error.
+//
+// The parse produces a small array of nodes that is itself a constant.
+// StaticExpression::at<I> evaluates node I, and since I and everything
+// about node I are known to the compiler, "if constexpr" picks out the one
+// line of arithmetic that node needs and at<I> calls at<left> and
+// at<right> for its operands.  After inlining, f(3.0, 4.0) is exactly the
+// code you'd get from writing (x*2.5 + y) / (y*y + 1) by hand, and
+// runBatch() over columns of input vectorizes like a hand-written loop.
+//
+// Variables are numbered in the order they first appear, as in
+// compileExpTree, and are passed in that order.
+//
+// Numbers are converted by the compiler too.  When the digits, taken as
+// a whole number, are at most 2^53 (about 15 significant digits) and the
+// power of ten they are then scaled by is between 10^-22 and 10^22, which
+// covers the usual cases, the result is exactly what std::from_chars would
+// give.  Other numbers take more than one rounding and may be off in the
+// last bit or so.
+//
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+
+// A string literal that can be a template argument.
+template <std::size_t N>
+struct ExpFixedString {
+    char text[N] = {};
+
+    constexpr ExpFixedString(const char (&s)[N]) {
+        for (std::size_t i = 0; i < N; ++i) text[i] = s[i];
+    }
+
+    constexpr std::size_t size() const { return N - 1; }
+};
+
+namespace expstatic_detail {
+
+enum class Kind : std::uint8_t { Number, Variable, Operator };
+
+struct Node {
+    Kind kind = Kind::Number;
+    char op = 0;        // for Operator
+    double value = 0;   // for Number
+    int slot = 0;       // for Variable
+    int left = -1;      // for Operator, the nodes of its operands
+    int right = -1;
+};
+
+// The parsed expression.  MaxNodes has to allow for the 0 and the minus
+// that -x turns into, so it's twice the length of the text.
+template <std::size_t MaxNodes>
+struct Ast {
+    Node nodes[MaxNodes] = {};
+    int count = 0;
+    int root = 0;
+    // Where in the text each variable's name is, by slot.
+    std::size_t nameStart[MaxNodes] = {};
+    std::size_t nameLength[MaxNodes] = {};
+    int variables = 0;
+};
+
+constexpr bool isDigit(char c) { return c >= '0' && c <= '9'; }
+constexpr bool isNameStart(char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_'; }
+constexpr bool isNameChar(char c) { return isNameStart(c) || isDigit(c); }
+
+// 10 to the power n, exactly for n up to 22.
+constexpr double powerOfTen(int n) {
+    double result = 1;
+    for (int i = 0; i < n; ++i) result *= 10;
+    return result;
+}
+
+// The same precedence climbing as ExpParser.hpp, done by the compiler.
+template <std::size_t MaxNodes>
+class Parser {
+public:
+    constexpr Parser(const char* text, std::size_t length) : text(text), length(length) {}
+
+    constexpr Ast<MaxNodes> parse() {
+        ast.root = expression(0);
+        if (peek() != '\0') throw std::invalid_argument("staticExpression: expected an operator");
+        return ast;
+    }
+
+private:
+    static constexpr int precedence(char op) { return op == '*' || op == '/' ? 2 : 1; }
+    static constexpr bool isOperator(char c) { return c == '+' || c == '-' || c == '*' || c == '/'; }
+
+    // The next character that isn't a space, or '\0' at the end.
+    constexpr char peek() {
+        while (pos < length && (text[pos] == ' ' || text[pos] == '\t')) ++pos;
+        return pos < length ? text[pos] : '\0';
+    }
+
+    constexpr int add(const Node& node) {
+        ast.nodes[ast.count] = node;
+        return ast.count++;
+    }
+
+    constexpr int number(double value) {
+        Node node;
+        node.value = value;
+        return add(node);
+    }
+
+    constexpr int binary(char op, int left, int right) {
+        Node node;
+        node.kind = Kind::Operator;
+        node.op = op;
+        node.left = left;
+        node.right = right;
+        return add(node);
+    }
+
+    constexpr int expression(int minPrecedence) {
+        int lhs = factor();
+        while (isOperator(peek()) && precedence(text[pos]) >= minPrecedence) {
+            char op = text[pos++];
+            int rhs = expression(precedence(op) + 1);
+            lhs = binary(op, lhs, rhs);
+        }
+        return lhs;
+    }
+
+    constexpr int factor() {
+        char c = peek();
+        if (isDigit(c) || c == '.') return number(readNumber());
+        if (isNameStart(c)) {
+            std::size_t start = pos;
+            while (pos < length && isNameChar(text[pos])) ++pos;
+            Node node;
+            node.kind = Kind::Variable;
+            node.slot = slotFor(start, pos - start);
+            return add(node);
+        }
+        if (c == '(') {
+            ++pos;
+            int inside = expression(0);
+            if (peek() != ')') throw std::invalid_argument("staticExpression: expected ')'");
+            ++pos;
+            return inside;
+        }
+        if (c == '-') {
+            ++pos;
+            char next = peek();
+            // -2 is just the number; -x is 0-x.
+            if (isDigit(next) || next == '.') return number(-readNumber());
+            int zero = number(0);
+            int operand = factor();
+            return binary('-', zero, operand);
+        }
+        throw std::invalid_argument("staticExpression: expected a number, a name or '('");
+    }
+
+    constexpr int slotFor(std::size_t start, std::size_t size) {
+        std::string_view name(text + start, size);
+        for (int i = 0; i < ast.variables; ++i)
+            if (std::string_view(text + ast.nameStart[i], ast.nameLength[i]) == name) return i;
+        ast.nameStart[ast.variables] = start;
+        ast.nameLength[ast.variables] = size;
+        return ast.variables++;
+    }
+
+    // Digits, an optional fraction and an optional exponent, like
+    // from_chars.  The digits are collected into an integer and scaled by
+    // a power of ten at the end.  That is one correctly rounded operation
+    // only when the integer is at most 2^53 and the power is at most
+    // 10^22, the largest both held exactly in a double; past either, the
+    // conversion or the extra scaling steps round again.
+    constexpr double readNumber() {
+        std::uint64_t digits = 0;
+        int scale = 0;
+        bool any = false;
+        for (; pos < length && isDigit(text[pos]); ++pos, any = true) {
+            if (digits < 100000000000000000ULL) digits = digits * 10 + static_cast<std::uint64_t>(text[pos] - '0');
+            else ++scale;
+        }
+        if (pos < length && text[pos] == '.') {
+            for (++pos; pos < length && isDigit(text[pos]); ++pos, any = true) {
+                if (digits < 100000000000000000ULL) {
+                    digits = digits * 10 + static_cast<std::uint64_t>(text[pos] - '0');
+                    --scale;
+                }
+            }
+        }
+        if (!any) throw std::invalid_argument("staticExpression: bad number");
+        if (pos < length && (text[pos] == 'e' || text[pos] == 'E')) {
+            std::size_t at = pos + 1;
+            bool negative = at < length && text[at] == '-';
+            if (at < length && (text[at] == '+' || text[at] == '-')) ++at;
+            if (at < length && isDigit(text[at])) {
+                int exponent = 0;
+                for (pos = at; pos < length && isDigit(text[pos]); ++pos) exponent = exponent * 10 + (text[pos] - '0');
+                scale += negative ? -exponent : exponent;
+            }
+        }
+        double value = static_cast<double>(digits);
+        for (; scale > 22; scale -= 22) value *= powerOfTen(22);
+        for (; scale < -22; scale += 22) value /= powerOfTen(22);
+        return scale < 0 ? value / powerOfTen(-scale) : value * powerOfTen(scale);
+    }
+
+    const char* text;
+    std::size_t length;
+    std::size_t pos = 0;
+    Ast<MaxNodes> ast;
+};
+
+} // namespace expstatic_detail
+
+template <ExpFixedString Text>
+class StaticExpression {
+    static constexpr auto ast =
+        expstatic_detail::Parser<2 * sizeof(Text.text)>(Text.text, Text.size()).parse();
+
+public:
+    // How many variables the expression has.
+    static constexpr std::size_t variableCount = static_cast<std::size_t>(ast.variables);
+
+    // The name of the variable in slot.
+    static constexpr std::string_view variable(std::size_t slot) {
+        return std::string_view(Text.text + ast.nameStart[slot], ast.nameLength[slot]);
+    }
+
+    // Evaluate with vars holding the variables in slot order.
+    static constexpr double evaluate(const double* vars) { return at<ast.root>(vars); }
+
+    // Evaluate with the variables given as arguments, in slot order.
+    template <typename... Values>
+    constexpr double operator()(Values... values) const {
+        static_assert(sizeof...(Values) == variableCount, "staticExpression: wrong number of variables");
+        if constexpr (sizeof...(Values) == 0) {
+            return evaluate(nullptr);
+        } else {
+            const double vars[] = {static_cast<double>(values)...};
+            return evaluate(vars);
+        }
+    }
+
+    // Like ExpProgram::runBatch: out[r] gets the value with variable i set
+    // to columns[i][r].
+    static void runBatch(const double* const* columns, std::size_t rows, double* out) {
+        for (std::size_t r = 0; r < rows; ++r) {
+            double vars[variableCount > 0 ? variableCount : 1] = {};
+            for (std::size_t i = 0; i < variableCount; ++i) vars[i] = columns[i][r];
+            out[r] = evaluate(vars);
+        }
+    }
+
+private:
+    // The value of node I.  Everything about the node is a constant, so
+    // each instantiation is one line of arithmetic.
+    template <int I>
+    static constexpr double at(const double* vars) {
+        constexpr expstatic_detail::Node node = ast.nodes[I];
+        if constexpr (node.kind == expstatic_detail::Kind::Number) {
+            return node.value;
+        } else if constexpr (node.kind == expstatic_detail::Kind::Variable) {
+            return vars[node.slot];
+        } else {
+            double lhs = at<node.left>(vars);
+            double rhs = at<node.right>(vars);
+            if constexpr (node.op == '+') return lhs + rhs;
+            else if constexpr (node.op == '-') return lhs - rhs;
+            else if constexpr (node.op == '*') return lhs * rhs;
+            else return lhs / rhs;
+        }
+    }
+};
+
+template <ExpFixedString Text>
+inline constexpr StaticExpression<Text> staticExpression{};
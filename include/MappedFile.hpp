@@ -0,0 +1,68 @@
+//
+// File:   MappedFile.hpp
+// Author: <Your Glorious Instructor>
+// Purpose:
+// Map a file read-only into memory, so it can be read as one big array of
+// bytes without copying it in first.  The operating system pages it in as
+// it is touched and can drop the pages again whenever it likes, since they
+// are the file's own.
+//
+// This uses POSIX mmap.
+//
+#pragma once
+#include <cerrno>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//
+// A file mapped read-only into memory for as long as the object lives.
+//
+class MappedFile {
+public:
+    // How the file will be read, as a hint to the operating system's
+    // read-ahead.
+    enum class Access { Sequential, Random };
+
+    explicit MappedFile(const std::string& path, Access access = Access::Sequential) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::system_error(errno, std::generic_category(), "MappedFile: can't open " + path);
+        struct stat info;
+        if (::fstat(fd, &info) != 0) {
+            int error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::generic_category(), "MappedFile: can't stat " + path);
+        }
+        size = static_cast<std::size_t>(info.st_size);
+        // An empty file can't be mapped, and has nothing to map anyway.
+        if (size > 0) {
+            void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped == MAP_FAILED) {
+                int error = errno;
+                ::close(fd);
+                throw std::system_error(error, std::generic_category(), "MappedFile: can't map " + path);
+            }
+            data = static_cast<const char*>(mapped);
+            ::madvise(mapped, size, access == Access::Sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+        }
+        ::close(fd);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+        if (data) ::munmap(const_cast<char*>(data), size);
+    }
+
+    std::string_view text() const { return std::string_view(data, size); }
+
+private:
+    const char* data = nullptr;
+    std::size_t size = 0;
+};
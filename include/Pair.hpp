@@ -5,6 +5,8 @@
 // A simplifed implementation of the Ordered Pair ADT
 //
 #pragma once
+#include <utility>
+
 template <typename KeyType, typename ValueType>
 class Pair {
 public:
@@ -12,9 +14,9 @@ public:
   ValueType second;
 
   Pair() = delete;
-  Pair(KeyType x, ValueType y): first(x), second(y) {}
+  Pair(KeyType x, ValueType y): first(std::move(x)), second(std::move(y)) {}
 
-  bool operator<(const Pair<KeyType, ValueType> rhs) const {
+  bool operator<(const Pair<KeyType, ValueType> & rhs) const {
     bool meetsCriteria = false;
     if (this->first < rhs.first) {
       meetsCriteria = true;
@@ -23,7 +25,7 @@ public:
   }
 
 
-  bool operator>(const Pair<KeyType, ValueType> rhs) const {
+  bool operator>(const Pair<KeyType, ValueType> & rhs) const {
     bool meetsCriteria = false;
     if (this->first > rhs.first) {
       meetsCriteria = true;
@@ -32,7 +34,7 @@ public:
   }
 
 
-  bool operator==(const Pair<KeyType, ValueType> rhs) const {
+  bool operator==(const Pair<KeyType, ValueType> & rhs) const {
     bool meetsCriteria = false;
     if (this->first == rhs.first) {
       meetsCriteria = true;
@@ -42,7 +44,6 @@ public:
 };
 
 template <typename KeyType, typename ValueType>
-Pair<KeyType, ValueType> & MakePair(KeyType first, ValueType second) {
-  Pair<KeyType, ValueType> * newPair = new Pair<KeyType, ValueType>(first, second);
-  return *newPair;
+Pair<KeyType, ValueType> MakePair(KeyType first, ValueType second) {
+  return Pair<KeyType, ValueType>(std::move(first), std::move(second));
 }
@@ -26,7 +26,11 @@
 #include <memory>
 #include <functional>
 #include <cassert>
+#include <atomic>
+#include <cstdint>
 #include <initializer_list>
+#include <iterator>
+#include <vector>
 template<typename T>
 class Tree
 {
@@ -34,19 +38,34 @@ class Tree
     // underlying structure implied by the mathematical definition of the Tree
     // ADT
     //
+    // The _edit field records which Transient (see below) created the node.
+    // Nodes built by the ordinary persistent operations carry 0, which no
+    // Transient ever uses, so they are never modified in place.
+    //
     struct Node
     {
         Node(std::shared_ptr<const Node>  lft
              , T val
-             , std::shared_ptr<const Node>  rgt)
-        : _lft(lft), _val(val), _rgt(rgt)
+             , std::shared_ptr<const Node>  rgt
+             , std::uint64_t edit = 0)
+        : _lft(std::move(lft)), _val(std::move(val)), _rgt(std::move(rgt)), _edit(edit)
         {}
 
         std::shared_ptr<const Node> _lft;
         T _val;
         std::shared_ptr<const Node> _rgt;
+        std::uint64_t _edit;
     };
 
+    //
+    // Every Transient gets its own edit id.  Ids are never handed out twice,
+    // so once a Transient is finished no later one can claim its nodes.
+    //
+    static std::uint64_t nextEditId() {
+        static std::atomic<std::uint64_t> counter{0};
+        return ++counter;
+    }
+
     //
     // And this private constructor defines how we keep track of the root of the
     // tree while not exposing that information to clients of this class.
@@ -76,11 +95,25 @@ public:
     // an initializer list.
     //
     Tree(std::initializer_list<T> init) {
-        Tree t;
+        Transient t = Tree().transient();
         for (T v: init) {
-            t = t.insert(v);
+            t.insert(v);
         }
-        _root = t._root;
+        _root = t.persistent()._root;
+    }
+
+    //
+    // Build a balanced tree from n values that arrive in increasing order,
+    // one from each call to next().  Inserting them one at a time would
+    // copy a search path per value and, since they are sorted, make a tree
+    // that is one long right spine.  Instead the first half goes into the
+    // left subtree, the middle value becomes the root and the rest goes
+    // into the right subtree, recursively, so every value is placed once,
+    // in O(n) time, and the tree is as shallow as it can be.
+    //
+    template <typename Next>
+    static Tree fromSorted(size_t n, Next next) {
+        return buildSorted(n, next);
     }
 
     //
@@ -94,7 +127,12 @@ public:
         return 1 + left().size() + right().size();
     }
 
-    T root() const {
+    //
+    // The value is returned by reference rather than copied.  Nodes never
+    // change, so the reference stays good for as long as any Tree still
+    // holds this node.
+    //
+    const T & root() const {
         assert(!isEmpty());
         return _root->_val;
     }
@@ -110,6 +148,15 @@ public:
         return Tree(_root->_rgt);
     }
 
+    //
+    // Since nodes are never changed, two Trees with the same root node are
+    // the same tree.  identity() names that node (nullptr for an empty
+    // tree) so clients can tell when subtrees are shared, and use it as a
+    // hash key.  The value means nothing once every Tree holding the node
+    // is gone.
+    //
+    const void * identity() const { return _root.get(); }
+
     //
     // Now we manipulate the tree.
     // Note how insert operates... we don't try to "fix" an existing tree.
@@ -139,6 +186,17 @@ public:
             return *this; // no duplicates
     }
 
+    //
+    // Like insert, except that a value the tree already has (one that
+    // compares equal to x) is replaced by x rather than kept.  This is what
+    // a dictionary wants when it stores (key, value) pairs ordered by key.
+    // x is moved into its node rather than copied at every level.
+    //
+    template <typename Compare=std::less<T>>
+    Tree assign(T x, Compare comp=std::less<T>()) const {
+        return Tree(assignNode(_root, x, comp));
+    }
+
     // Continuing the use of the Compare type parameter, we provide a default
     // comparison function that uses std::less<T>.  This allows the user to
     // provide a callable object that defines how to compare two values of type T.
@@ -157,6 +215,125 @@ public:
         }   
     }
 
+    //
+    // Look for a value that compares equal to key and return a pointer to
+    // it, or nullptr if there isn't one.  Unlike find, this copies nothing
+    // and touches no reference counts, and key needn't be a T: comp only
+    // has to accept (key, value) and (value, key), so a dictionary can look
+    // up a (key, value) pair by its key alone.  The pointer is good for as
+    // long as some Tree holds the node.
+    //
+    template <typename Key, typename Compare>
+    T const * search(Key const & key, Compare comp) const {
+        Node const * node = _root.get();
+        while (node) {
+            if (comp(key, node->_val))
+                node = node->_lft.get();
+            else if (comp(node->_val, key))
+                node = node->_rgt.get();
+            else
+                return &node->_val;
+        }
+        return nullptr;
+    }
+
+    //
+    // A const_iterator visits the values in order, smallest first, reading
+    // them in place: nothing is copied and no reference counts change.  It
+    // keeps the nodes still to be visited on a small stack, the current one
+    // on top, so incrementing is amortized O(1).  Like the pointer from
+    // search, an iterator is good for as long as some Tree holds its nodes.
+    //
+    //     for (int x : tree) ...
+    //     for (auto it = tree.lowerBound(10); it != tree.end() && *it < 20; ++it) ...
+    //
+    class const_iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = T const *;
+        using reference = T const &;
+
+        const_iterator() = default;
+
+        reference operator*() const { return _path.back()->_val; }
+        pointer operator->() const { return &_path.back()->_val; }
+
+        const_iterator & operator++() {
+            Node const * node = _path.back();
+            _path.pop_back();
+            pushLeftSpine(node->_rgt.get());
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            const_iterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        bool operator==(const_iterator const & other) const {
+            if (_path.empty() || other._path.empty())
+                return _path.empty() == other._path.empty();
+            return _path.back() == other._path.back();
+        }
+
+        bool operator!=(const_iterator const & other) const { return !(*this == other); }
+
+    private:
+        friend class Tree;
+
+        void pushLeftSpine(Node const * node) {
+            for (; node; node = node->_lft.get())
+                _path.push_back(node);
+        }
+
+        std::vector<Node const *> _path;
+    };
+
+    const_iterator begin() const {
+        const_iterator it;
+        it.pushLeftSpine(_root.get());
+        return it;
+    }
+
+    const_iterator end() const { return const_iterator(); }
+
+    //
+    // The first value not less than key, and the first value greater than
+    // key, as for std::lower_bound and std::upper_bound.  As with search,
+    // comp has to take (key, value) and (value, key).
+    //
+    template <typename Key, typename Compare=std::less<>>
+    const_iterator lowerBound(Key const & key, Compare comp=Compare()) const {
+        const_iterator it;
+        for (Node const * node = _root.get(); node; ) {
+            if (comp(node->_val, key)) {
+                node = node->_rgt.get();
+            } else {
+                it._path.push_back(node);
+                node = node->_lft.get();
+            }
+        }
+        return it;
+    }
+
+    template <typename Key, typename Compare=std::less<>>
+    const_iterator upperBound(Key const & key, Compare comp=Compare()) const {
+        const_iterator it;
+        for (Node const * node = _root.get(); node; ) {
+            if (comp(key, node->_val)) {
+                it._path.push_back(node);
+                node = node->_lft.get();
+            } else {
+                node = node->_rgt.get();
+            }
+        }
+        return it;
+    }
+
     //
     // This function finds a value in the tree, and returns true if it is found.
     // If it is found, the subtree where it was found is returned in the
@@ -214,7 +391,122 @@ public:
         visit(contents);
     }
 
+    //
+    // Immutability costs us a copy of the whole search path on every insert,
+    // which adds up when we do a long run of inserts and only keep the final
+    // version.  A Transient is a mutable builder for that case:
+    //
+    //     auto t = tree.transient();
+    //     t.insert(1).insert(2).insert(3);
+    //     tree = t.persistent();
+    //
+    // The first time the Transient walks through a node it still shares with
+    // the original tree, it copies that node and tags the copy with its edit
+    // id.  After that the copy belongs to the Transient and is changed in
+    // place, so each node is copied at most once per batch no matter how many
+    // inserts pass through it.  The original tree is never touched.
+    //
+    // Calling persistent() hands back an ordinary Tree and retires the edit
+    // id, after which the Transient must not be used again.
+    //
+    class Transient
+    {
+    public:
+        explicit Transient(Tree const & tree)
+          : _root(tree._root), _edit(nextEditId()) {}
+
+        Transient(Transient const & other) = delete;
+        Transient & operator=(Transient const & other) = delete;
+        Transient(Transient && other) = default;
+        Transient & operator=(Transient && other) = default;
+        ~Transient() = default;
+
+        bool isEmpty() const { return !_root; }
+
+        template <typename Compare=std::less<T>>
+        Transient & insert(T x, Compare comp=std::less<T>()) {
+            assert(_edit != 0 && "Transient used after persistent()");
+            std::shared_ptr<const Node> * link = &_root;
+            while (*link) {
+                Node * node = editable(*link);
+                if (comp(x, node->_val))
+                    link = &node->_lft;
+                else if (comp(node->_val, x))
+                    link = &node->_rgt;
+                else
+                    return *this; // no duplicates
+            }
+            *link = std::make_shared<Node>(nullptr, std::move(x), nullptr, _edit);
+            return *this;
+        }
+
+        Tree persistent() {
+            assert(_edit != 0 && "Transient used after persistent()");
+            _edit = 0;
+            return Tree(std::move(_root));
+        }
+
+    private:
+        //
+        // Return a node we are allowed to modify, copying it first if it is
+        // still shared with some other version of the tree.  Every node is
+        // created through make_shared<Node>, so casting away the const on one
+        // we own is well defined.
+        //
+        Node * editable(std::shared_ptr<const Node> & link) {
+            if (link->_edit != _edit) {
+                link = std::make_shared<Node>(link->_lft, link->_val, link->_rgt, _edit);
+            }
+            return const_cast<Node *>(link.get());
+        }
+
+        std::shared_ptr<const Node> _root;
+        std::uint64_t _edit;
+    };
+
+    Transient transient() const {
+        return Transient(*this);
+    }
+
+    //
+    // A Tree is a single shared_ptr, and like any object it can't be read
+    // by one thread while another assigns to it.  Since the nodes never
+    // change, all that has to be protected is the root pointer, and these
+    // do that: one thread publishes new versions with atomicStore while any
+    // number of others take copies with atomicLoad.  The copy is a complete
+    // version of the tree that the publisher can no longer affect, so it
+    // can be read at leisure without any further synchronization.
+    //
+    static Tree atomicLoad(Tree const * tree) {
+        return Tree(std::atomic_load(&tree->_root));
+    }
+
+    static void atomicStore(Tree * tree, Tree value) {
+        std::atomic_store(&tree->_root, std::move(value._root));
+    }
+
 private:
+    template <typename Next>
+    static Tree buildSorted(size_t n, Next & next) {
+        if (n == 0)
+            return Tree();
+        Tree lft = buildSorted(n / 2, next);
+        T val = next();
+        Tree rgt = buildSorted(n - n / 2 - 1, next);
+        return Tree(std::make_shared<Node>(std::move(lft._root), std::move(val), std::move(rgt._root)));
+    }
+
+    template <typename Compare>
+    static std::shared_ptr<const Node> assignNode(std::shared_ptr<const Node> const & node, T & x, Compare & comp) {
+        if (!node)
+            return std::make_shared<Node>(nullptr, std::move(x), nullptr);
+        if (comp(x, node->_val))
+            return std::make_shared<Node>(assignNode(node->_lft, x, comp), node->_val, node->_rgt);
+        if (comp(node->_val, x))
+            return std::make_shared<Node>(node->_lft, node->_val, assignNode(node->_rgt, x, comp));
+        return std::make_shared<Node>(node->_lft, std::move(x), node->_rgt);
+    }
+
     std::shared_ptr<const Node> _root;
 };
 
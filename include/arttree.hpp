@@ -0,0 +1,716 @@
+//
+// File:   arttree.hpp
+// Author: Your Glorious Instructor
+// Purpose:
+// Provide a dictionary from std::string keys to values as an adaptive radix
+// tree (ART), for keys such as paths and URLs that share long prefixes.
+//
+// A Dictionary<std::string, V> compares whole strings at every level of
+// its tree, and with a million "/home/alice/projects/..." keys most of
+// every comparison is spent re-reading the same prefix.  A radix tree
+// never compares keys: it goes down one byte of the key per level, using
+// the byte to pick the child, so a lookup costs about one step per byte
+// of the key no matter how many keys there are.
+//
+// Two things keep that from wasting space or time:
+//
+//   - Inner nodes come in four sizes and grow as children are added.  A
+//     Node4 holds up to 4 (byte, child) pairs and a Node16 up to 16, both
+//     kept sorted by byte; a Node16 is searched with one SSE2 comparison of
+//     all 16 bytes at once.  A Node48 maps each byte to one of 48 child
+//     slots through a 256-entry index, and a Node256 is just 256 child
+//     pointers.  Most nodes are small, and big ones cost one array lookup.
+//
+//   - A chain of nodes with one child each is collapsed into the node
+//     below, which keeps the bytes skipped as its "prefix" (path
+//     compression), and a key that is the only one below some point is a
+//     leaf right there rather than a chain of one-child nodes (lazy
+//     expansion).  So "/usr/share/doc/" shared by a thousand keys is a
+//     prefix of one node, not fifteen levels.  A node keeps the first
+//     MaxPrefix bytes of its prefix; lookups check those and skip the
+//     rest, which is safe because a lookup always ends by comparing the
+//     whole key stored in the leaf.
+//
+// A key that is also the start of longer keys ("/usr/bin" and
+// "/usr/bin/cc") ends at an inner node, and is held there as that node's
+// "terminal" leaf.  It comes before all of the node's children, which
+// puts keys in the same order as std::string's <, the order Dictionary
+// iterates in.
+//
+// ArtTree has the Dictionary lookup interface (find, contains, at,
+// operator[], insert, insert_or_assign, try_emplace, size, empty), ordered
+// iterators with lower_bound, upper_bound and range, and prefix(p), which
+// finds the node below which every key starts with p and walks just that
+// subtree.  Lookups take std::string_view and allocate nothing.
+//
+// Unlike Dictionary this is an ordinary mutable container: it owns its
+// nodes, can be moved but not copied, and there are no snapshots.
+// Inserting invalidates iterators (a node may be replaced by a bigger one)
+// but never references to values, which live in leaves that don't move.
+//
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+template <typename ValueType>
+class ArtTree {
+public:
+    using value_type = std::pair<const std::string, ValueType>;
+
+private:
+    enum class Kind : std::uint8_t { Leaf, Node4, Node16, Node48, Node256 };
+
+    // The prefix bytes an inner node keeps; longer prefixes are checked
+    // against a leaf when it matters.
+    static constexpr std::size_t MaxPrefix = 10;
+
+    struct Node {
+        explicit Node(Kind kind) : kind(kind) {}
+        Kind kind;
+    };
+
+    struct Leaf : Node {
+        template <typename... Args>
+        Leaf(std::string key, Args&&... args)
+            : Node(Kind::Leaf), entry(std::piecewise_construct, std::forward_as_tuple(std::move(key)),
+                                      std::forward_as_tuple(std::forward<Args>(args)...)) {}
+        value_type entry;
+    };
+
+    struct Inner : Node {
+        explicit Inner(Kind kind) : Node(kind) {}
+        std::uint16_t count = 0;          // children
+        std::uint32_t prefixLength = 0;   // bytes skipped before this node's byte
+        unsigned char prefix[MaxPrefix] = {};
+        Leaf* terminal = nullptr;         // the key that ends at this node
+    };
+
+    struct Node4 : Inner {
+        Node4() : Inner(Kind::Node4) {}
+        unsigned char keys[4] = {};
+        Node* children[4] = {};
+    };
+
+    struct Node16 : Inner {
+        Node16() : Inner(Kind::Node16) {}
+        unsigned char keys[16] = {};
+        Node* children[16] = {};
+    };
+
+    struct Node48 : Inner {
+        Node48() : Inner(Kind::Node48) {}
+        unsigned char index[256] = {};    // child slot + 1, or 0 for none
+        Node* children[48] = {};
+    };
+
+    struct Node256 : Inner {
+        Node256() : Inner(Kind::Node256) {}
+        Node* children[256] = {};
+    };
+
+public:
+    //
+    // Visits entries in key order.  The stack holds the inner nodes on the
+    // way down to the current leaf, each with how far through its children
+    // we are: -1 before its terminal, then an index into keys (Node4 and
+    // Node16) or the next byte to look at (Node48 and Node256).
+    //
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = typename ArtTree::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const value_type*;
+        using reference = const value_type&;
+
+        const_iterator() = default;
+
+        reference operator*() const { return current->entry; }
+        pointer operator->() const { return &current->entry; }
+
+        const_iterator& operator++() {
+            next();
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            const_iterator old = *this;
+            next();
+            return old;
+        }
+
+        bool operator==(const const_iterator& other) const { return current == other.current; }
+        bool operator!=(const const_iterator& other) const { return current != other.current; }
+
+    private:
+        friend class ArtTree;
+
+        struct Frame {
+            const Inner* node;
+            int position;
+        };
+
+        // Start at the smallest key at or below node.
+        void descend(const Node* node) {
+            if (node->kind == Kind::Leaf) {
+                current = static_cast<const Leaf*>(node);
+                return;
+            }
+            path.push_back(Frame{static_cast<const Inner*>(node), -1});
+            next();
+        }
+
+        // Move to the next leaf, or to the end.
+        void next() {
+            while (!path.empty()) {
+                const Node* child = nextChild(path.back());
+                if (!child) {
+                    path.pop_back();
+                } else if (child->kind == Kind::Leaf) {
+                    current = static_cast<const Leaf*>(child);
+                    return;
+                } else {
+                    path.push_back(Frame{static_cast<const Inner*>(child), -1});
+                }
+            }
+            current = nullptr;
+        }
+
+        static const Node* nextChild(Frame& frame) {
+            const Inner* inner = frame.node;
+            if (frame.position < 0) {
+                frame.position = 0;
+                if (inner->terminal) return inner->terminal;
+            }
+            switch (inner->kind) {
+            case Kind::Node4: {
+                auto node = static_cast<const Node4*>(inner);
+                return frame.position < node->count ? node->children[frame.position++] : nullptr;
+            }
+            case Kind::Node16: {
+                auto node = static_cast<const Node16*>(inner);
+                return frame.position < node->count ? node->children[frame.position++] : nullptr;
+            }
+            case Kind::Node48: {
+                auto node = static_cast<const Node48*>(inner);
+                while (frame.position < 256) {
+                    unsigned char slot = node->index[frame.position++];
+                    if (slot) return node->children[slot - 1];
+                }
+                return nullptr;
+            }
+            default: {
+                auto node = static_cast<const Node256*>(inner);
+                while (frame.position < 256) {
+                    const Node* child = node->children[frame.position++];
+                    if (child) return child;
+                }
+                return nullptr;
+            }
+            }
+        }
+
+        std::vector<Frame> path;
+        const Leaf* current = nullptr;
+    };
+
+    using iterator = const_iterator;
+
+    // A pair of iterators to use in a range-based for.
+    struct Range {
+        const_iterator first;
+        const_iterator last;
+        const_iterator begin() const { return first; }
+        const_iterator end() const { return last; }
+    };
+
+    ArtTree() = default;
+    ArtTree(const ArtTree&) = delete;
+    ArtTree& operator=(const ArtTree&) = delete;
+    ArtTree(ArtTree&& other) noexcept : root(other.root), count(other.count) {
+        other.root = nullptr;
+        other.count = 0;
+    }
+    ArtTree& operator=(ArtTree&& other) noexcept {
+        std::swap(root, other.root);
+        std::swap(count, other.count);
+        return *this;
+    }
+    ~ArtTree() { destroy(root); }
+
+    bool empty() const { return count == 0; }
+    std::size_t size() const { return count; }
+
+    // The value for key, or nothing if key isn't there.
+    std::optional<std::reference_wrapper<const ValueType>> find(std::string_view key) const {
+        const Leaf* leaf = locate(key);
+        if (!leaf) return std::nullopt;
+        return std::cref(leaf->entry.second);
+    }
+
+    bool contains(std::string_view key) const { return locate(key) != nullptr; }
+
+    const ValueType& at(std::string_view key) const {
+        const Leaf* leaf = locate(key);
+        if (!leaf) throw std::out_of_range("Key not found in dictionary");
+        return leaf->entry.second;
+    }
+
+    const ValueType& operator[](std::string_view key) const { return at(key); }
+
+    // Add key, or give it a new value if it is already there.
+    void insert(std::string key, ValueType value) { insert_or_assign(std::move(key), std::move(value)); }
+
+    // The same as insert, but says whether key is new.
+    bool insert_or_assign(std::string key, ValueType value) {
+        if (Leaf* leaf = const_cast<Leaf*>(locate(key))) {
+            leaf->entry.second = std::move(value);
+            return false;
+        }
+        add(new Leaf(std::move(key), std::move(value)));
+        return true;
+    }
+
+    //
+    // Add key with the value made from args, unless key is already there,
+    // in which case nothing is built and nothing changes.  Says whether
+    // key was added.
+    //
+    template <typename... Args>
+    bool try_emplace(std::string key, Args&&... args) {
+        if (locate(key)) return false;
+        add(new Leaf(std::move(key), std::forward<Args>(args)...));
+        return true;
+    }
+
+    const_iterator begin() const {
+        const_iterator it;
+        if (root) it.descend(root);
+        return it;
+    }
+
+    const_iterator end() const { return const_iterator(); }
+
+    // The first entry whose key is not less than key.
+    const_iterator lower_bound(std::string_view key) const {
+        const_iterator it;
+        const Node* node = root;
+        std::size_t depth = 0;
+        while (node) {
+            if (node->kind == Kind::Leaf) {
+                auto leaf = static_cast<const Leaf*>(node);
+                if (std::string_view(leaf->entry.first) >= key) it.current = leaf;
+                else it.next();
+                return it;
+            }
+            auto inner = static_cast<const Inner*>(node);
+            const unsigned char* bytes = prefixBytes(inner, depth);
+            for (std::size_t i = 0; i < inner->prefixLength; ++i) {
+                // Every key below is longer than key and starts with it,
+                // or differs from it here.
+                if (depth + i == key.size()) {
+                    it.descend(node);
+                    return it;
+                }
+                unsigned char b = byteAt(key, depth + i);
+                if (bytes[i] != b) {
+                    if (bytes[i] > b) it.descend(node);
+                    else it.next();
+                    return it;
+                }
+            }
+            depth += inner->prefixLength;
+            // The terminal is key itself, and comes first.
+            if (depth == key.size()) {
+                it.descend(node);
+                return it;
+            }
+            unsigned char b = byteAt(key, depth);
+            it.path.push_back(typename const_iterator::Frame{inner, positionAfter(inner, b)});
+            Node* const* child = findChild(inner, b);
+            if (!child) {
+                it.next();
+                return it;
+            }
+            node = *child;
+            ++depth;
+        }
+        return it;
+    }
+
+    // The first entry whose key is greater than key.
+    const_iterator upper_bound(std::string_view key) const {
+        const_iterator it = lower_bound(key);
+        if (it != end() && it->first == key) ++it;
+        return it;
+    }
+
+    // The entries with lo <= key < hi, in order.
+    Range range(std::string_view lo, std::string_view hi) const {
+        if (!(lo < hi)) return Range{end(), end()};
+        return Range{lower_bound(lo), lower_bound(hi)};
+    }
+
+    //
+    // The entries whose keys start with p, in order.  This goes down to the
+    // node that all of them are under, and only that subtree is walked.
+    //
+    Range prefix(std::string_view p) const {
+        const Node* node = root;
+        std::size_t depth = 0;
+        while (node) {
+            if (node->kind == Kind::Leaf) {
+                auto leaf = static_cast<const Leaf*>(node);
+                if (leaf->entry.first.compare(0, p.size(), p) != 0) return Range{end(), end()};
+                break;
+            }
+            auto inner = static_cast<const Inner*>(node);
+            const unsigned char* bytes = prefixBytes(inner, depth);
+            std::size_t check = std::min<std::size_t>(inner->prefixLength, p.size() - depth);
+            for (std::size_t i = 0; i < check; ++i) {
+                if (bytes[i] != byteAt(p, depth + i)) return Range{end(), end()};
+            }
+            depth += inner->prefixLength;
+            if (depth >= p.size()) break;
+            Node* const* child = findChild(inner, byteAt(p, depth));
+            if (!child) return Range{end(), end()};
+            node = *child;
+            ++depth;
+        }
+        const_iterator first;
+        if (node) first.descend(node);
+        return Range{first, end()};
+    }
+
+private:
+    static unsigned char byteAt(std::string_view key, std::size_t i) { return static_cast<unsigned char>(key[i]); }
+
+    static void destroy(Node* node) {
+        if (!node) return;
+        switch (node->kind) {
+        case Kind::Leaf:
+            delete static_cast<Leaf*>(node);
+            return;
+        case Kind::Node4: {
+            auto inner = static_cast<Node4*>(node);
+            for (int i = 0; i < inner->count; ++i) destroy(inner->children[i]);
+            delete inner->terminal;
+            delete inner;
+            return;
+        }
+        case Kind::Node16: {
+            auto inner = static_cast<Node16*>(node);
+            for (int i = 0; i < inner->count; ++i) destroy(inner->children[i]);
+            delete inner->terminal;
+            delete inner;
+            return;
+        }
+        case Kind::Node48: {
+            auto inner = static_cast<Node48*>(node);
+            for (int i = 0; i < inner->count; ++i) destroy(inner->children[i]);
+            delete inner->terminal;
+            delete inner;
+            return;
+        }
+        case Kind::Node256: {
+            auto inner = static_cast<Node256*>(node);
+            for (Node* child : inner->children) destroy(child);
+            delete inner->terminal;
+            delete inner;
+            return;
+        }
+        }
+    }
+
+    //
+    // The slot holding the child for byte b, or nullptr.  Node16 compares
+    // b with all sixteen keys in one instruction and picks the match out
+    // of the resulting bit mask.
+    //
+    static Node* const* findChild(const Inner* inner, unsigned char b) {
+        switch (inner->kind) {
+        case Kind::Node4: {
+            auto node = static_cast<const Node4*>(inner);
+            for (int i = 0; i < node->count; ++i)
+                if (node->keys[i] == b) return &node->children[i];
+            return nullptr;
+        }
+        case Kind::Node16: {
+            auto node = static_cast<const Node16*>(inner);
+#if defined(__SSE2__)
+            __m128i matches = _mm_cmpeq_epi8(_mm_set1_epi8(static_cast<char>(b)),
+                                             _mm_loadu_si128(reinterpret_cast<const __m128i*>(node->keys)));
+            unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(matches)) & ((1u << node->count) - 1);
+            return mask ? &node->children[__builtin_ctz(mask)] : nullptr;
+#else
+            for (int i = 0; i < node->count; ++i)
+                if (node->keys[i] == b) return &node->children[i];
+            return nullptr;
+#endif
+        }
+        case Kind::Node48: {
+            auto node = static_cast<const Node48*>(inner);
+            return node->index[b] ? &node->children[node->index[b] - 1] : nullptr;
+        }
+        default: {
+            auto node = static_cast<const Node256*>(inner);
+            return node->children[b] ? &node->children[b] : nullptr;
+        }
+        }
+    }
+
+    static Node** findChild(Inner* inner, unsigned char b) {
+        return const_cast<Node**>(findChild(static_cast<const Inner*>(inner), b));
+    }
+
+    // How many of a sorted key array's first count entries are <= b.
+    static int countUpTo(const unsigned char* keys, int count, unsigned char b) {
+        int i = 0;
+        while (i < count && keys[i] <= b) ++i;
+        return i;
+    }
+
+#if defined(__SSE2__)
+    // The same for Node16, all at once.  SSE2 only compares signed bytes,
+    // so both sides are flipped into signed order first.
+    static int countUpTo16(const unsigned char* keys, int count, unsigned char b) {
+        const __m128i flip = _mm_set1_epi8(static_cast<char>(0x80));
+        __m128i greater = _mm_cmpgt_epi8(_mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(keys)), flip),
+                                         _mm_xor_si128(_mm_set1_epi8(static_cast<char>(b)), flip));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(greater)) & ((1u << count) - 1);
+        return mask ? __builtin_ctz(mask) : count;
+    }
+#else
+    static int countUpTo16(const unsigned char* keys, int count, unsigned char b) { return countUpTo(keys, count, b); }
+#endif
+
+    // Where a const_iterator resumes after the child for byte b.
+    static int positionAfter(const Inner* inner, unsigned char b) {
+        switch (inner->kind) {
+        case Kind::Node4: return countUpTo(static_cast<const Node4*>(inner)->keys, inner->count, b);
+        case Kind::Node16: return countUpTo16(static_cast<const Node16*>(inner)->keys, inner->count, b);
+        default: return b + 1;
+        }
+    }
+
+    // Any leaf below node; they all share node's whole prefix.
+    static const Leaf* anyLeaf(const Node* node) {
+        while (node->kind != Kind::Leaf) {
+            auto inner = static_cast<const Inner*>(node);
+            if (inner->terminal) return inner->terminal;
+            typename const_iterator::Frame frame{inner, 0};
+            node = const_iterator::nextChild(frame);
+        }
+        return static_cast<const Leaf*>(node);
+    }
+
+    // All of inner's prefix, which starts at depth in its keys.
+    static const unsigned char* prefixBytes(const Inner* inner, std::size_t depth) {
+        if (inner->prefixLength <= MaxPrefix) return inner->prefix;
+        return reinterpret_cast<const unsigned char*>(anyLeaf(inner)->entry.first.data()) + depth;
+    }
+
+    static void setPrefix(Inner* inner, const unsigned char* bytes, std::size_t length) {
+        inner->prefixLength = static_cast<std::uint32_t>(length);
+        std::memmove(inner->prefix, bytes, std::min(length, MaxPrefix));
+    }
+
+    // Find a leaf by key, checking only the prefix bytes nodes keep, and
+    // then the whole key.
+    const Leaf* locate(std::string_view key) const {
+        const Node* node = root;
+        std::size_t depth = 0;
+        while (node) {
+            if (node->kind == Kind::Leaf) {
+                auto leaf = static_cast<const Leaf*>(node);
+                return leaf->entry.first == key ? leaf : nullptr;
+            }
+            auto inner = static_cast<const Inner*>(node);
+            if (inner->prefixLength) {
+                if (key.size() < depth + inner->prefixLength) return nullptr;
+                std::size_t check = std::min<std::size_t>(inner->prefixLength, MaxPrefix);
+                if (std::memcmp(inner->prefix, key.data() + depth, check) != 0) return nullptr;
+                depth += inner->prefixLength;
+            }
+            if (depth == key.size()) {
+                return inner->terminal && inner->terminal->entry.first == key ? inner->terminal : nullptr;
+            }
+            Node* const* child = findChild(inner, byteAt(key, depth));
+            if (!child) return nullptr;
+            node = *child;
+            ++depth;
+        }
+        return nullptr;
+    }
+
+    // Put leaf into node, whose prefix ends at depth: as its terminal if
+    // the key ends there, otherwise as a child.
+    static void place(Node*& slot, Leaf* leaf, std::size_t depth) {
+        auto inner = static_cast<Inner*>(slot);
+        const std::string& key = leaf->entry.first;
+        if (key.size() == depth) inner->terminal = leaf;
+        else addChild(slot, byteAt(key, depth), leaf);
+    }
+
+    // Add a leaf whose key isn't in the tree yet.
+    void add(Leaf* leaf) {
+        const std::string& key = leaf->entry.first;
+        Node** slot = &root;
+        std::size_t depth = 0;
+        ++count;
+        while (true) {
+            if (!*slot) {
+                *slot = leaf;
+                return;
+            }
+            if ((*slot)->kind == Kind::Leaf) {
+                // Two keys where there was one: a Node4 holding both, with
+                // whatever they have in common as its prefix.
+                auto other = static_cast<Leaf*>(*slot);
+                const std::string& otherKey = other->entry.first;
+                std::size_t common = 0;
+                while (depth + common < key.size() && depth + common < otherKey.size() &&
+                       key[depth + common] == otherKey[depth + common])
+                    ++common;
+                Node* node = new Node4();
+                setPrefix(static_cast<Inner*>(node), reinterpret_cast<const unsigned char*>(key.data()) + depth, common);
+                place(node, other, depth + common);
+                place(node, leaf, depth + common);
+                *slot = node;
+                return;
+            }
+            auto inner = static_cast<Inner*>(*slot);
+            if (inner->prefixLength) {
+                const unsigned char* bytes = prefixBytes(inner, depth);
+                std::size_t same = 0;
+                while (same < inner->prefixLength && depth + same < key.size() &&
+                       bytes[same] == byteAt(key, depth + same))
+                    ++same;
+                if (same < inner->prefixLength) {
+                    // The key leaves the prefix part way: a new Node4 takes
+                    // the part they share, and the old node keeps what's
+                    // left after the byte that tells them apart.
+                    Node* node = new Node4();
+                    setPrefix(static_cast<Inner*>(node), bytes, same);
+                    unsigned char split = bytes[same];
+                    setPrefix(inner, bytes + same + 1, inner->prefixLength - same - 1);
+                    addChild(node, split, inner);
+                    place(node, leaf, depth + same);
+                    *slot = node;
+                    return;
+                }
+                depth += inner->prefixLength;
+            }
+            if (depth == key.size()) {
+                inner->terminal = leaf;
+                return;
+            }
+            Node** child = findChild(inner, byteAt(key, depth));
+            if (!child) {
+                addChild(*slot, byteAt(key, depth), leaf);
+                return;
+            }
+            slot = child;
+            ++depth;
+        }
+    }
+
+    // Copy the parts every inner node has.
+    static void copyHeader(Inner* to, const Inner* from) {
+        to->count = from->count;
+        to->prefixLength = from->prefixLength;
+        std::memcpy(to->prefix, from->prefix, MaxPrefix);
+        to->terminal = from->terminal;
+    }
+
+    //
+    // Give the node in slot a child for byte b, which it doesn't have yet.
+    // A full node is replaced by one of the next size up.
+    //
+    static void addChild(Node*& slot, unsigned char b, Node* child) {
+        switch (slot->kind) {
+        case Kind::Node4: {
+            auto node = static_cast<Node4*>(slot);
+            if (node->count < 4) {
+                insertSorted(node->keys, node->children, node->count, countUpTo(node->keys, node->count, b), b, child);
+                return;
+            }
+            auto bigger = new Node16();
+            copyHeader(bigger, node);
+            std::copy(node->keys, node->keys + 4, bigger->keys);
+            std::copy(node->children, node->children + 4, bigger->children);
+            delete node;
+            slot = bigger;
+            addChild(slot, b, child);
+            return;
+        }
+        case Kind::Node16: {
+            auto node = static_cast<Node16*>(slot);
+            if (node->count < 16) {
+                insertSorted(node->keys, node->children, node->count, countUpTo16(node->keys, node->count, b), b,
+                             child);
+                return;
+            }
+            auto bigger = new Node48();
+            copyHeader(bigger, node);
+            for (int i = 0; i < 16; ++i) {
+                bigger->children[i] = node->children[i];
+                bigger->index[node->keys[i]] = static_cast<unsigned char>(i + 1);
+            }
+            delete node;
+            slot = bigger;
+            addChild(slot, b, child);
+            return;
+        }
+        case Kind::Node48: {
+            auto node = static_cast<Node48*>(slot);
+            if (node->count < 48) {
+                // Nothing is ever removed, so the slots fill in order.
+                node->children[node->count] = child;
+                node->index[b] = static_cast<unsigned char>(++node->count);
+                return;
+            }
+            auto bigger = new Node256();
+            copyHeader(bigger, node);
+            for (int byte = 0; byte < 256; ++byte)
+                if (node->index[byte]) bigger->children[byte] = node->children[node->index[byte] - 1];
+            delete node;
+            slot = bigger;
+            addChild(slot, b, child);
+            return;
+        }
+        default: {
+            auto node = static_cast<Node256*>(slot);
+            node->children[b] = child;
+            ++node->count;
+            return;
+        }
+        }
+    }
+
+    static void insertSorted(unsigned char* keys, Node** children, std::uint16_t& count, int at, unsigned char b,
+                             Node* child) {
+        std::copy_backward(keys + at, keys + count, keys + count + 1);
+        std::copy_backward(children + at, children + count, children + count + 1);
+        keys[at] = b;
+        children[at] = child;
+        ++count;
+    }
+
+    Node* root = nullptr;
+    std::size_t count = 0;
+};
@@ -3,201 +3,629 @@
 // Purpose:
 // Provide a balanced AVL Tree
 //
+// The tree holds a set of unique keys of any type T.  Keys are ordered with
+// the Compare function object, which defaults to std::less<T> just like the
+// standard library's ordered containers.  Two keys a and b are considered
+// equal when neither comp(a, b) nor comp(b, a) holds.
+//
+// The Storage parameter decides where the nodes live:
+//   AVLNodeHeap  - every node is allocated on its own with new (the default)
+//   AVLNodePool  - nodes are packed into large chunks and refer to each other
+//                  with 32-bit indices instead of 64-bit pointers
+//
+// The Augment parameter lets each node carry a summary of its whole subtree,
+// such as the largest interval end point or the sum of the values below it.
+// The tree keeps the summaries current through inserts, removes and
+// rotations; classes like IntervalTree and RangeSumTree derive from AVLTree
+// and use them to answer queries without visiting every node.
+//
 #pragma once
 #include <iostream>
 #include <algorithm>
+#include <functional>
+#include <iterator>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
-template <typename T>
-class AVLTree {
-private:
-    class AVLNode {
+//
+// A storage policy supplies the type a node uses to refer to its children
+// (Ref) and a Pool that creates, looks up and releases nodes.  In both
+// policies a value-initialized Ref, Ref{}, means "no node" and converts to
+// false, so the tree code can test links the same way in either mode.
+//
+struct AVLNodeHeap {
+    template <typename Node>
+    using Ref = Node*;
+
+    template <typename Node>
+    class Pool {
+    public:
+        Node& operator[](Node* ref) const { return *ref; }
+
+        Node* create(const Node& proto) { return new Node(proto); }
+
+        void release(Node* ref) { delete ref; }
+
+        // Free every node reachable from root.
+        void clear(Node* root) {
+            if (root) {
+                clear(root->left);
+                clear(root->right);
+                delete root;
+            }
+        }
+
+        void swap(Pool&) noexcept {}
+    };
+};
+
+//
+// The pooled policy hands out nodes from chunks of ChunkSize slots.  A Ref is
+// the slot number: the high bits pick the chunk and the low bits the slot in
+// it.  Chunks never move once allocated, so a reference to a node stays good
+// while other nodes are added.  Slot 0 is never used so that Ref{} can mean
+// "no node".  Released slots are recycled before new ones are taken.
+//
+// Dropping the whole tree frees one block per chunk rather than one per node,
+// and skips visiting the nodes at all when T has a trivial destructor.
+//
+struct AVLNodePool {
+    template <typename Node>
+    using Ref = std::uint32_t;
+
+    template <typename Node>
+    class Pool {
     public:
+        Pool() = default;
+        Pool(const Pool&) = delete;
+        Pool& operator=(const Pool&) = delete;
+        Pool(Pool&& other) noexcept { swap(other); }
+        Pool& operator=(Pool&& other) noexcept {
+            swap(other);
+            return *this;
+        }
+        ~Pool() { freeChunks(); }
+
+        Node& operator[](std::uint32_t ref) const {
+            return chunks[ref >> ChunkBits][ref & (ChunkSize - 1)];
+        }
+
+        std::uint32_t create(const Node& proto) {
+            std::uint32_t ref;
+            if (!freeSlots.empty()) {
+                ref = freeSlots.back();
+                freeSlots.pop_back();
+            } else {
+                if (used == MaxSlots)
+                    throw std::length_error("AVLNodePool: too many nodes for 32-bit indices");
+                if ((used >> ChunkBits) == chunks.size())
+                    chunks.push_back(std::allocator<Node>().allocate(ChunkSize));
+                ref = static_cast<std::uint32_t>(used++);
+            }
+            ::new (static_cast<void*>(&(*this)[ref])) Node(proto);
+            return ref;
+        }
+
+        void release(std::uint32_t ref) {
+            (*this)[ref].~Node();
+            freeSlots.push_back(ref);
+        }
+
+        // Free every node.  Keys only need their destructors run when T has
+        // one that does something; otherwise we just hand back the chunks.
+        void clear(std::uint32_t root) {
+            if (!std::is_trivially_destructible<Node>::value && root) {
+                std::vector<std::uint32_t> pending{ root };
+                while (!pending.empty()) {
+                    Node& node = (*this)[pending.back()];
+                    pending.pop_back();
+                    if (node.left) pending.push_back(node.left);
+                    if (node.right) pending.push_back(node.right);
+                    node.~Node();
+                }
+            }
+            freeChunks();
+        }
+
+        void swap(Pool& other) noexcept {
+            chunks.swap(other.chunks);
+            freeSlots.swap(other.freeSlots);
+            std::swap(used, other.used);
+        }
+
+    private:
+        static constexpr unsigned ChunkBits = 12;
+        static constexpr std::size_t ChunkSize = std::size_t(1) << ChunkBits;
+        static constexpr std::size_t MaxSlots = std::size_t(0xFFFFFFFF);
+
+        void freeChunks() {
+            for (Node* chunk : chunks)
+                std::allocator<Node>().deallocate(chunk, ChunkSize);
+            chunks.clear();
+            freeSlots.clear();
+            used = 1;
+        }
+
+        std::vector<Node*> chunks;
+        std::vector<std::uint32_t> freeSlots;
+        std::size_t used = 1;   // slot 0 stands for "no node"
+    };
+};
+
+//
+// An augmentation describes the per-subtree summary:
+//   value_type                      - what each node stores
+//   make(key)                       - the summary of a single key
+//   combine(lhs, rhs)               - the summary of two adjacent runs of keys
+//                                     (lhs before rhs in key order)
+//   enabled                         - false only for AVLNoAugment, which lets
+//                                     the tree skip all the bookkeeping
+// combine must be associative; it is only ever applied to non-empty runs, so
+// no identity value is needed.
+//
+struct AVLNoAugment {
+    struct value_type {};
+    static constexpr bool enabled = false;
+    template <typename T>
+    static value_type make(const T&) { return value_type(); }
+    static value_type combine(value_type, value_type) { return value_type(); }
+};
+
+template <typename T, typename Compare = std::less<T>, typename Storage = AVLNodeHeap,
+          typename Augment = AVLNoAugment>
+class AVLTree {
+protected:
+    using Summary = typename Augment::value_type;
+    struct AVLNode;
+    using Ref = typename Storage::template Ref<AVLNode>;
+    using Pool = typename Storage::template Pool<AVLNode>;
+
+    //
+    // Rather than a full int height, each node keeps its balance factor,
+    // height(left) - height(right), which is always -1, 0 or +1 in a valid
+    // AVL tree.  A signed char is plenty and keeps the node small.
+    //
+    struct AVLNode {
         T key;
-        AVLNode* left;
-        AVLNode* right;
-        int height;
-        AVLNode(int val) : key(val), left(nullptr), right(nullptr), height(1) {}
+        Ref left;
+        Ref right;
+        signed char balance;
+        Summary summary;
+        AVLNode(const T& val)
+            : key(val), left(), right(), balance(0), summary(Augment::make(key)) {}
     };
-    AVLNode* root;
+    Pool nodes;
+    Ref root;
+    std::size_t count;
+    Compare comp;
+
+    AVLNode& node(Ref ref) const { return nodes[ref]; }
+
+private:
+    //
+    // insert and remove are iterative.  On the way down they remember the
+    // link (the reference inside the parent, or root itself) that led to
+    // each node and which way they went from there; on the way back up those
+    // links are where a rotated subtree gets reattached.  The height of an
+    // AVL tree with n nodes is below 1.45 * log2(n + 2), so 96 entries cover
+    // any tree that fits in memory.
+    //
+    static constexpr int MaxHeight = 96;
+
+    struct SearchPath {
+        Ref* link[MaxHeight];
+        bool wentRight[MaxHeight];
+        int depth = 0;
+
+        void push(Ref* l, bool right) {
+            link[depth] = l;
+            wentRight[depth] = right;
+            ++depth;
+        }
+    };
+
+    // Recompute a node's summary from its key and its children's summaries.
+    void pull(Ref ref) {
+        if constexpr (Augment::enabled) {
+            AVLNode& n = node(ref);
+            Summary s = Augment::make(n.key);
+            if (n.left) s = Augment::combine(node(n.left).summary, s);
+            if (n.right) s = Augment::combine(s, node(n.right).summary);
+            n.summary = s;
+        }
+    }
 
-    // Get height of a node
-    int height(AVLNode* node) {
-        return (node == nullptr) ? 0 : node->height;
+    // Even when the balance factors have settled, every ancestor of a
+    // changed node still has a stale summary.  Refresh them from level i up.
+    void pullPath(const SearchPath& path, int i) {
+        if constexpr (Augment::enabled) {
+            for (; i >= 0; --i) pull(*path.link[i]);
+        }
     }
 
     // Get balance factor of a node
-    int getBalance(AVLNode* node) {
-        return (node == nullptr) ? 0 : height(node->left) - height(node->right);
+    int getBalance(Ref ref) const {
+        return ref ? node(ref).balance : 0;
     }
 
+    //
+    // The rotations update the balance factors directly instead of
+    // recomputing heights.  Writing the old factors in terms of the heights
+    // of the three subtrees that move and simplifying gives the expressions
+    // below.
+    //
+
     // Right rotation
-    AVLNode* rotateRight(AVLNode* y) {
-        AVLNode* x = y->left;
-        AVLNode* T2 = x->right;
+    Ref rotateRight(Ref yRef) {
+        AVLNode& y = node(yRef);
+        Ref xRef = y.left;
+        AVLNode& x = node(xRef);
+        Ref T2 = x.right;
 
         // Perform rotation
-        x->right = y;
-        y->left = T2;
-
-        // Update heights
-        y->height = std::max(height(y->left), height(y->right)) + 1;
-        x->height = std::max(height(x->left), height(x->right)) + 1;
-
-        return x;
+        x.right = yRef;
+        y.left = T2;
+
+        // Update balance factors, and summaries from the bottom up
+        int yb = y.balance - 1 - std::max(static_cast<int>(x.balance), 0);
+        int xb = x.balance - 1 + std::min(yb, 0);
+        y.balance = static_cast<signed char>(yb);
+        x.balance = static_cast<signed char>(xb);
+        pull(yRef);
+        pull(xRef);
+
+        return xRef;
     }
 
     // Left rotation
-    AVLNode* rotateLeft(AVLNode* x) {
-        AVLNode* y = x->right;
-        AVLNode* T2 = y->left;
+    Ref rotateLeft(Ref xRef) {
+        AVLNode& x = node(xRef);
+        Ref yRef = x.right;
+        AVLNode& y = node(yRef);
+        Ref T2 = y.left;
 
         // Perform rotation
-        y->left = x;
-        x->right = T2;
+        y.left = xRef;
+        x.right = T2;
+
+        // Update balance factors, and summaries from the bottom up
+        int xb = x.balance + 1 - std::min(static_cast<int>(y.balance), 0);
+        int yb = y.balance + 1 + std::max(xb, 0);
+        x.balance = static_cast<signed char>(xb);
+        y.balance = static_cast<signed char>(yb);
+        pull(xRef);
+        pull(yRef);
+
+        return yRef;
+    }
 
-        // Update heights
-        x->height = std::max(height(x->left), height(x->right)) + 1;
-        y->height = std::max(height(y->left), height(y->right)) + 1;
+    // Fix a node whose balance factor has reached +2 or -2 and return the
+    // new root of its subtree.
+    Ref rebalance(Ref ref) {
+        AVLNode& n = node(ref);
+        if (n.balance > 1) {
+            // Left-Right (LR) needs the extra rotation, Left-Left (LL) doesn't
+            if (getBalance(n.left) < 0)
+                n.left = rotateLeft(n.left);
+            return rotateRight(ref);
+        }
+        // Right-Left (RL) needs the extra rotation, Right-Right (RR) doesn't
+        if (getBalance(n.right) > 0)
+            n.right = rotateRight(n.right);
+        return rotateLeft(ref);
+    }
 
-        return y;
+    //
+    // After an insert, walk back up the path.  The subtree we came out of
+    // grew by one level.  If that leaves the parent perfectly balanced its
+    // height didn't change and nothing further up can be affected, so we
+    // stop.  A rotation also restores the subtree's old height, so we stop
+    // after at most one of those too.  Only summaries, if any, still need
+    // updating above the stopping point.
+    //
+    void retraceInsert(SearchPath& path) {
+        for (int i = path.depth - 1; i >= 0; --i) {
+            AVLNode& n = node(*path.link[i]);
+            n.balance += path.wentRight[i] ? -1 : 1;
+            if (n.balance == 2 || n.balance == -2) {
+                *path.link[i] = rebalance(*path.link[i]);
+                pullPath(path, i - 1);
+                return;
+            }
+            pull(*path.link[i]);
+            if (n.balance == 0) {
+                pullPath(path, i - 1);
+                return;
+            }
+        }
     }
 
-    // Insert a node in AVL tree
-    AVLNode* insert(AVLNode* node, int key) {
-        if (node == nullptr) return new AVLNode(key);
+    //
+    // After a removal the subtree we came out of lost a level.  If the
+    // parent was balanced before, it is now off by one but keeps its height,
+    // so we stop.  A rotation shortens the subtree unless the new root ends
+    // up leaning one way, in which case we stop there as well.
+    //
+    void retraceRemove(SearchPath& path) {
+        for (int i = path.depth - 1; i >= 0; --i) {
+            AVLNode& n = node(*path.link[i]);
+            n.balance += path.wentRight[i] ? 1 : -1;
+            if (n.balance == 2 || n.balance == -2) {
+                Ref top = rebalance(*path.link[i]);
+                *path.link[i] = top;
+                if (node(top).balance != 0) {
+                    pullPath(path, i - 1);
+                    return;
+                }
+                continue;
+            }
+            pull(*path.link[i]);
+            if (n.balance == 1 || n.balance == -1) {
+                pullPath(path, i - 1);
+                return;
+            }
+        }
+    }
 
-        if (key < node->key)
-            node->left = insert(node->left, key);
-        else if (key > node->key)
-            node->right = insert(node->right, key);
-        else
-            return node;  // Duplicates not allowed
+    // Compute the real height of a subtree, or -1 if any balance factor
+    // stored below it is wrong.  Only used by isValid().
+    int checkedHeight(Ref ref) const {
+        if (!ref) return 0;
+        const AVLNode& n = node(ref);
+        int lh = checkedHeight(n.left);
+        int rh = checkedHeight(n.right);
+        if (lh < 0 || rh < 0 || lh - rh != n.balance) return -1;
+        if (n.left && !comp(node(n.left).key, n.key)) return -1;
+        if (n.right && !comp(n.key, node(n.right).key)) return -1;
+        return 1 + std::max(lh, rh);
+    }
 
-        // Update height
-        node->height = 1 + std::max(height(node->left), height(node->right));
+    // In-order traversal
+    void inorder(Ref ref) {
+        if (ref) {
+            inorder(node(ref).left);
+            std::cout << node(ref).key << " ";
+            inorder(node(ref).right);
+        }
+    }
 
-        // Get balance factor
-        int balance = getBalance(node);
+    // Make a deep copy of another tree's subtree in our own pool, used by
+    // the copy constructor.
+    Ref clone(const AVLTree& other, Ref ref) {
+        if (!ref) return Ref();
+        const AVLNode& source = other.node(ref);
+        Ref copy = nodes.create(source);
+        Ref lft = clone(other, source.left);
+        Ref rgt = clone(other, source.right);
+        node(copy).left = lft;
+        node(copy).right = rgt;
+        return copy;
+    }
 
-        // Perform rotations if unbalanced
-        // Left-Left (LL) Case
-        if (balance > 1 && key < node->left->key)
-            return rotateRight(node);
+public:
+    //
+    // An in-order iterator.  We don't keep parent pointers in the nodes, so
+    // the iterator remembers the path of ancestors it still has to visit.
+    // The node on top of the stack is the one the iterator refers to, and an
+    // empty stack is the end of the sequence.  Any insert or remove
+    // invalidates all iterators.
+    //
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        const_iterator() = default;
+
+        reference operator*() const { return (*pool)[path.back()].key; }
+        pointer operator->() const { return &(*pool)[path.back()].key; }
+
+        const_iterator& operator++() {
+            Ref next = (*pool)[path.back()].right;
+            path.pop_back();
+            pushLeft(next);
+            return *this;
+        }
 
-        // Right-Right (RR) Case
-        if (balance < -1 && key > node->right->key)
-            return rotateLeft(node);
+        const_iterator operator++(int) {
+            const_iterator old = *this;
+            ++*this;
+            return old;
+        }
 
-        // Left-Right (LR) Case
-        if (balance > 1 && key > node->left->key) {
-            node->left = rotateLeft(node->left);
-            return rotateRight(node);
+        bool operator==(const const_iterator& rhs) const {
+            if (path.empty() || rhs.path.empty()) return path.empty() == rhs.path.empty();
+            return path.back() == rhs.path.back();
         }
+        bool operator!=(const const_iterator& rhs) const { return !(*this == rhs); }
+
+    private:
+        friend class AVLTree;
+
+        explicit const_iterator(const Pool* p) : pool(p) {}
 
-        // Right-Left (RL) Case
-        if (balance < -1 && key < node->right->key) {
-            node->right = rotateRight(node->right);
-            return rotateLeft(node);
+        void pushLeft(Ref ref) {
+            while (ref) {
+                path.push_back(ref);
+                ref = (*pool)[ref].left;
+            }
         }
 
-        return node;
+        const Pool* pool = nullptr;
+        std::vector<Ref> path;
+    };
+    using iterator = const_iterator;
+
+    explicit AVLTree(const Compare& cmp = Compare()) : root(), count(0), comp(cmp) {}
+
+    AVLTree(const AVLTree& other) : root(), count(other.count), comp(other.comp) {
+        root = clone(other, other.root);
     }
 
-    // Find the node with the minimum value (for deletion)
-    AVLNode* minValueNode(AVLNode* node) {
-        AVLNode* current = node;
-        while (current->left != nullptr)
-            current = current->left;
-        return current;
+    AVLTree& operator=(const AVLTree& other) {
+        AVLTree copy(other);
+        swap(copy);
+        return *this;
     }
 
-    // Delete a node
-    AVLNode* deleteNode(AVLNode* root, int key) {
-        if (root == nullptr) return root;
+    AVLTree(AVLTree&& other) noexcept : root(), count(0), comp(other.comp) {
+        swap(other);
+    }
 
-        if (key < root->key)
-            root->left = deleteNode(root->left, key);
-        else if (key > root->key)
-            root->right = deleteNode(root->right, key);
-        else {
-            if ((root->left == nullptr) || (root->right == nullptr)) {
-                AVLNode* temp = root->left ? root->left : root->right;
-                if (temp == nullptr) {
-                    temp = root;
-                    root = nullptr;
-                } else
-                    *root = *temp;
-                delete temp;
-            } else {
-                AVLNode* temp = minValueNode(root->right);
-                root->key = temp->key;
-                root->right = deleteNode(root->right, temp->key);
-            }
-        }
+    AVLTree& operator=(AVLTree&& other) noexcept {
+        swap(other);
+        return *this;
+    }
 
-        if (root == nullptr) return root;
+    virtual ~AVLTree() {
+       nodes.clear(root);
+    }
 
-        root->height = 1 + std::max(height(root->left), height(root->right));
+    void swap(AVLTree& other) noexcept {
+        nodes.swap(other.nodes);
+        std::swap(root, other.root);
+        std::swap(count, other.count);
+        std::swap(comp, other.comp);
+    }
 
-        int balance = getBalance(root);
+    std::size_t size() const { return count; }
+    bool empty() const { return count == 0; }
 
-        // Left-Left (LL)
-        if (balance > 1 && getBalance(root->left) >= 0)
-            return rotateRight(root);
+    void clear() {
+        nodes.clear(root);
+        root = Ref();
+        count = 0;
+    }
 
-        // Left-Right (LR)
-        if (balance > 1 && getBalance(root->left) < 0) {
-            root->left = rotateLeft(root->left);
-            return rotateRight(root);
+    // Returns true if the key was added, false if it was already present.
+    bool insert(const T& key) {
+        SearchPath path;
+        Ref* link = &root;
+        while (*link) {
+            AVLNode& n = node(*link);
+            if (comp(key, n.key)) {
+                path.push(link, false);
+                link = &n.left;
+            } else if (comp(n.key, key)) {
+                path.push(link, true);
+                link = &n.right;
+            } else {
+                return false;  // Duplicates not allowed
+            }
         }
+        *link = nodes.create(AVLNode(key));
+        ++count;
+        retraceInsert(path);
+        return true;
+    }
 
-        // Right-Right (RR)
-        if (balance < -1 && getBalance(root->right) <= 0)
-            return rotateLeft(root);
-
-        // Right-Left (RL)
-        if (balance < -1 && getBalance(root->right) > 0) {
-            root->right = rotateRight(root->right);
-            return rotateLeft(root);
+    // Returns true if the key was found and removed.
+    bool remove(const T& key) {
+        SearchPath path;
+        Ref* link = &root;
+        while (*link) {
+            AVLNode& n = node(*link);
+            if (comp(key, n.key)) {
+                path.push(link, false);
+                link = &n.left;
+            } else if (comp(n.key, key)) {
+                path.push(link, true);
+                link = &n.right;
+            } else {
+                break;
+            }
         }
-
-        return root;
+        Ref target = *link;
+        if (!target) return false;
+
+        if (node(target).left && node(target).right) {
+            // Two children: move the in-order successor's key up into the
+            // target and unlink the successor instead, which has no left child.
+            path.push(link, true);
+            link = &node(target).right;
+            while (node(*link).left) {
+                path.push(link, false);
+                link = &node(*link).left;
+            }
+            Ref successor = *link;
+            node(target).key = std::move(node(successor).key);
+            target = successor;
+        }
+        *link = node(target).left ? node(target).left : node(target).right;
+        nodes.release(target);
+        --count;
+        retraceRemove(path);
+        return true;
     }
 
-    // In-order traversal
-    void inorder(AVLNode* root) {
-        if (root != nullptr) {
-            inorder(root->left);
-            std::cout << root->key << " ";
-            inorder(root->right);
+    bool contains(const T& key) const {
+        Ref ref = root;
+        while (ref) {
+            const AVLNode& n = node(ref);
+            if (comp(key, n.key))
+                ref = n.left;
+            else if (comp(n.key, key))
+                ref = n.right;
+            else
+                return true;
         }
+        return false;
     }
 
-    void destroy(AVLNode *node) {
-        if (node) {
-            destroy(node->left);
-            destroy(node->right);
-            delete node;
+    const_iterator find(const T& key) const {
+        const_iterator it = lower_bound(key);
+        if (it != end() && comp(key, *it)) return end();
+        return it;
+    }
+
+    // First key that is not less than the given key, or end() if none.
+    // Only the ancestors where we turned left are still to be visited, so
+    // those are the only ones we keep on the iterator's path.
+    const_iterator lower_bound(const T& key) const {
+        const_iterator it(&nodes);
+        Ref ref = root;
+        while (ref) {
+            const AVLNode& n = node(ref);
+            if (comp(n.key, key)) {
+                ref = n.right;
+            } else {
+                it.path.push_back(ref);
+                ref = n.left;
+            }
         }
+        return it;
     }
 
-public:
-    AVLTree() : root(nullptr) {}
-    AVLTree(const AVLTree&) = default; 
-    AVLTree& operator=(const AVLTree&) = default; 
-    AVLTree(AVLTree&&) = default; 
-    AVLTree& operator=(AVLTree&&) = default;
-    virtual ~AVLTree() {
-       destroy(root);
+    const_iterator begin() const {
+        const_iterator it(&nodes);
+        it.pushLeft(root);
+        return it;
     }
 
+    const_iterator end() const { return const_iterator(&nodes); }
 
-    void insert(int key) {
-        root = insert(root, key);
+    // The height of the tree.  The balance factors tell us which child is
+    // taller, so we only need to follow one path down.
+    int height() const {
+        int h = 0;
+        for (Ref ref = root; ref; ++h)
+            ref = (node(ref).balance > 0) ? node(ref).left : node(ref).right;
+        return h;
     }
 
-    void remove(int key) {
-        root = deleteNode(root, key);
+    // Check the ordering and AVL balance of every node.  This visits the
+    // whole tree, so it is meant for tests and debugging.
+    bool isValid() const {
+        return checkedHeight(root) >= 0;
     }
 
     void display() {
@@ -205,3 +633,7 @@ public:
         std::cout << std::endl;
     }
 };
+
+// An AVLTree whose nodes live in a chunked pool and link with 32-bit indices.
+template <typename T, typename Compare = std::less<T>>
+using PooledAVLTree = AVLTree<T, Compare, AVLNodePool>;
@@ -0,0 +1,490 @@
+//
+// File:   bplustree.hpp
+// Author: Your Glorious Instructor
+// Purpose:
+// Provide a B+tree: a B-tree that keeps every key/value pair in its leaves
+// and chains the leaves together in key order.
+//
+// The internal nodes only hold copies of keys to steer searches, so they
+// stay small and a lookup still costs one node per level.  Because the
+// leaves form a sorted linked list, walking all the entries, or all the
+// entries in a key range, is a search for the first one followed by a
+// sequential walk along the leaves, with no climbing back up the tree.
+// That is what makes B+trees the usual choice for database indexes.
+//
+// Inserts split full nodes on the way down, as in BTree.  A leaf split
+// copies the first key of the new right leaf up into the parent; an
+// internal split moves its middle key up.
+//
+// bulk_load builds the whole tree in one pass from sorted input, filling
+// each leaf to a chosen fraction of its capacity.  Packing leaves full is
+// best for a tree that will only be read; leaving some room makes later
+// inserts cheaper because fewer of them have to split a leaf.
+//
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+template <typename K, typename V, int Order = 64, typename Compare = std::less<K>>
+class BPlusTree {
+    static_assert(Order >= 4 && Order % 2 == 0, "BPlusTree order must be an even number of at least 4");
+
+public:
+    // A leaf holds up to LeafMax entries and an internal node up to Order
+    // children.  Apart from the root, no node is ever less than half full.
+    static constexpr int LeafMax = Order - 1;
+    static constexpr int MinLeaf = LeafMax / 2;
+    static constexpr int MinChildren = Order / 2;
+
+private:
+    struct Node {
+        int count = 0;   // entries in a leaf, keys in an internal node
+        bool leaf;
+        explicit Node(bool isLeaf) : leaf(isLeaf) {}
+    };
+
+    // Keys and values are kept in separate arrays so that searching a leaf
+    // only touches keys.
+    struct Leaf : Node {
+        K keys[LeafMax];
+        V values[LeafMax];
+        Leaf* next = nullptr;
+        Leaf() : Node(true) {}
+    };
+
+    // keys[i] is the smallest key anywhere under children[i + 1].
+    struct Internal : Node {
+        K keys[Order - 1];
+        Node* children[Order];
+        Internal() : Node(false) {}
+    };
+
+    Node* root = nullptr;
+    Leaf* first = nullptr;
+    std::size_t numEntries = 0;
+    Compare comp;
+
+    static Leaf* asLeaf(Node* node) { return static_cast<Leaf*>(node); }
+    static const Leaf* asLeaf(const Node* node) { return static_cast<const Leaf*>(node); }
+    static Internal* asInternal(Node* node) { return static_cast<Internal*>(node); }
+    static const Internal* asInternal(const Node* node) { return static_cast<const Internal*>(node); }
+
+    static void destroy(Node* node) {
+        if (node->leaf) {
+            delete asLeaf(node);
+        } else {
+            Internal* in = asInternal(node);
+            for (int i = 0; i <= in->count; ++i) destroy(in->children[i]);
+            delete in;
+        }
+    }
+
+    // Number of keys in [keys, keys + n) that are less than key (or, with
+    // orEqual, not greater than key).  Branch-free like BTree::lowerBound.
+    int rank(const K* keys, int n, const K& key, bool orEqual) const {
+        if (n == 0) return 0;
+        const K* base = keys;
+        while (n > 1) {
+            int half = n / 2;
+            bool right = orEqual ? !comp(key, base[half]) : comp(base[half], key);
+            base = right ? base + half : base;
+            n -= half;
+        }
+        bool after = orEqual ? !comp(key, *base) : comp(*base, key);
+        return static_cast<int>(base - keys) + (after ? 1 : 0);
+    }
+
+    // The child of in whose subtree key belongs to.
+    int childIndex(const Internal* in, const K& key) const {
+        return rank(in->keys, in->count, key, true);
+    }
+
+    const Leaf* findLeaf(const K& key) const {
+        const Node* node = root;
+        while (!node->leaf) {
+            const Internal* in = asInternal(node);
+            node = in->children[childIndex(in, key)];
+        }
+        return asLeaf(node);
+    }
+
+    // Split parent's full child i and add the key that now separates the
+    // two halves to parent.
+    void splitChild(Internal* parent, int i) {
+        Node* child = parent->children[i];
+        Node* sibling;
+        K separator;
+        if (child->leaf) {
+            Leaf* left = asLeaf(child);
+            Leaf* right = new Leaf();
+            int keep = (LeafMax + 1) / 2;
+            std::move(left->keys + keep, left->keys + LeafMax, right->keys);
+            std::move(left->values + keep, left->values + LeafMax, right->values);
+            right->count = LeafMax - keep;
+            left->count = keep;
+            right->next = left->next;
+            left->next = right;
+            separator = right->keys[0];
+            sibling = right;
+        } else {
+            Internal* left = asInternal(child);
+            Internal* right = new Internal();
+            constexpr int Half = Order / 2;   // children left behind
+            std::move(left->keys + Half, left->keys + Order - 1, right->keys);
+            std::move(left->children + Half, left->children + Order, right->children);
+            right->count = Order - 1 - Half;
+            left->count = Half - 1;
+            separator = std::move(left->keys[Half - 1]);
+            sibling = right;
+        }
+
+        std::move_backward(parent->keys + i, parent->keys + parent->count,
+                           parent->keys + parent->count + 1);
+        std::move_backward(parent->children + i + 1, parent->children + parent->count + 1,
+                           parent->children + parent->count + 2);
+        parent->keys[i] = std::move(separator);
+        parent->children[i + 1] = sibling;
+        ++parent->count;
+    }
+
+    static bool isFull(const Node* node) {
+        return node->leaf ? node->count == LeafMax : node->count == Order - 1;
+    }
+
+    // Checks one subtree for isValid; returns its height or -1.  Every key
+    // must be in [lo, hi) where those are given.
+    int checkedHeight(const Node* node, const K* lo, const K* hi, bool isRoot,
+                      std::vector<const Leaf*>& leaves) const {
+        auto inBounds = [&](const K& k) {
+            return !(lo && comp(k, *lo)) && !(hi && !comp(k, *hi));
+        };
+        if (node->leaf) {
+            const Leaf* leaf = asLeaf(node);
+            if (leaf->count > LeafMax || (!isRoot && leaf->count < MinLeaf)) return -1;
+            for (int i = 0; i < leaf->count; ++i) {
+                if (i > 0 && !comp(leaf->keys[i - 1], leaf->keys[i])) return -1;
+                if (!inBounds(leaf->keys[i])) return -1;
+            }
+            leaves.push_back(leaf);
+            return 1;
+        }
+        const Internal* in = asInternal(node);
+        if (in->count > Order - 1 || in->count < (isRoot ? 1 : MinChildren - 1)) return -1;
+        for (int i = 0; i < in->count; ++i) {
+            if (i > 0 && !comp(in->keys[i - 1], in->keys[i])) return -1;
+            if (!inBounds(in->keys[i])) return -1;
+        }
+        int height = -1;
+        for (int i = 0; i <= in->count; ++i) {
+            int h = checkedHeight(in->children[i], i == 0 ? lo : &in->keys[i - 1],
+                                  i == in->count ? hi : &in->keys[i], false, leaves);
+            if (h < 0 || (height >= 0 && h != height)) return -1;
+            height = h;
+        }
+        return height + 1;
+    }
+
+    //
+    // How bulk_load shares n items out between nodes: perNode each, except
+    // that a short last node is either folded into the one before it (if
+    // they fit together in maxSize) or evened out with it, so that no node
+    // ends up with fewer than minSize items.
+    //
+    static std::vector<std::size_t> groupSizes(std::size_t n, std::size_t perNode,
+                                               std::size_t minSize, std::size_t maxSize) {
+        std::vector<std::size_t> sizes(n / perNode, perNode);
+        std::size_t rest = n % perNode;
+        if (rest > 0) sizes.push_back(rest);
+        if (sizes.size() > 1 && sizes.back() < minSize) {
+            std::size_t both = sizes.back() + sizes[sizes.size() - 2];
+            sizes.pop_back();
+            if (both <= maxSize) {
+                sizes.back() = both;
+            } else {
+                sizes.back() = both - both / 2;
+                sizes.push_back(both / 2);
+            }
+        }
+        return sizes;
+    }
+
+public:
+    //
+    // Iterators walk the leaf chain.  Entries are stored as separate key
+    // and value arrays, so dereferencing gives a pair of references rather
+    // than a reference to a stored pair; key() and value() are also there.
+    //
+    class const_iterator {
+        friend class BPlusTree;
+        const Leaf* leaf = nullptr;
+        int index = 0;
+        const_iterator(const Leaf* l, int i) : leaf(l), index(i) {
+            if (leaf && index == leaf->count) {   // ran off the end of a leaf
+                leaf = leaf->next;
+                index = 0;
+            }
+        }
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::pair<K, V>;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::pair<const K&, const V&>;
+        using pointer = void;
+
+        const_iterator() = default;
+
+        const K& key() const { return leaf->keys[index]; }
+        const V& value() const { return leaf->values[index]; }
+        reference operator*() const { return reference(leaf->keys[index], leaf->values[index]); }
+
+        const_iterator& operator++() {
+            if (++index == leaf->count) {
+                leaf = leaf->next;
+                index = 0;
+            }
+            return *this;
+        }
+        const_iterator operator++(int) {
+            const_iterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        bool operator==(const const_iterator& rhs) const { return leaf == rhs.leaf && index == rhs.index; }
+        bool operator!=(const const_iterator& rhs) const { return !(*this == rhs); }
+    };
+
+    //
+    // The entries with lo <= key < hi, for a range-based for loop.  The
+    // end is found while walking, so building a range costs one search.
+    //
+    class Range {
+        friend class BPlusTree;
+        const_iterator from;
+        const K hi;
+        const Compare* comp;
+        Range(const_iterator f, const K& h, const Compare* c) : from(f), hi(h), comp(c) {}
+
+    public:
+        class iterator {
+            friend class Range;
+            const_iterator it;
+            const Range* range;
+            iterator(const_iterator i, const Range* r) : it(i), range(r) {
+                if (it != const_iterator() && !(*range->comp)(it.key(), range->hi)) it = const_iterator();
+            }
+
+        public:
+            std::pair<const K&, const V&> operator*() const { return *it; }
+            const K& key() const { return it.key(); }
+            const V& value() const { return it.value(); }
+            iterator& operator++() {
+                ++it;
+                if (it != const_iterator() && !(*range->comp)(it.key(), range->hi)) it = const_iterator();
+                return *this;
+            }
+            bool operator==(const iterator& rhs) const { return it == rhs.it; }
+            bool operator!=(const iterator& rhs) const { return it != rhs.it; }
+        };
+
+        iterator begin() const { return iterator(from, this); }
+        iterator end() const { return iterator(const_iterator(), this); }
+        bool empty() const { return begin() == end(); }
+    };
+
+    BPlusTree() = default;
+    explicit BPlusTree(const Compare& c) : comp(c) {}
+
+    BPlusTree(const BPlusTree&) = delete;
+    BPlusTree& operator=(const BPlusTree&) = delete;
+
+    BPlusTree(BPlusTree&& other) noexcept
+        : root(other.root), first(other.first), numEntries(other.numEntries), comp(other.comp) {
+        other.root = nullptr;
+        other.first = nullptr;
+        other.numEntries = 0;
+    }
+    BPlusTree& operator=(BPlusTree&& other) noexcept {
+        std::swap(root, other.root);
+        std::swap(first, other.first);
+        std::swap(numEntries, other.numEntries);
+        std::swap(comp, other.comp);
+        return *this;
+    }
+
+    ~BPlusTree() { clear(); }
+
+    std::size_t size() const { return numEntries; }
+    bool empty() const { return numEntries == 0; }
+
+    void clear() {
+        if (root) destroy(root);
+        root = nullptr;
+        first = nullptr;
+        numEntries = 0;
+    }
+
+    // Adds key with value, or replaces the value if key is already there.
+    // Returns true if a new entry was added.
+    bool insert(const K& key, const V& value) {
+        if (!root) {
+            first = new Leaf();
+            root = first;
+        }
+        if (isFull(root)) {
+            Internal* newRoot = new Internal();
+            newRoot->children[0] = root;
+            root = newRoot;
+            splitChild(newRoot, 0);
+        }
+
+        Node* node = root;
+        while (!node->leaf) {
+            Internal* in = asInternal(node);
+            int i = childIndex(in, key);
+            if (isFull(in->children[i])) {
+                splitChild(in, i);
+                if (!comp(key, in->keys[i])) ++i;
+            }
+            node = in->children[i];
+        }
+
+        Leaf* leaf = asLeaf(node);
+        int i = rank(leaf->keys, leaf->count, key, false);
+        if (i < leaf->count && !comp(key, leaf->keys[i])) {
+            leaf->values[i] = value;
+            return false;
+        }
+        std::move_backward(leaf->keys + i, leaf->keys + leaf->count, leaf->keys + leaf->count + 1);
+        std::move_backward(leaf->values + i, leaf->values + leaf->count, leaf->values + leaf->count + 1);
+        leaf->keys[i] = key;
+        leaf->values[i] = value;
+        ++leaf->count;
+        ++numEntries;
+        return true;
+    }
+
+    //
+    // Replace the contents with the entries in [firstEntry, lastEntry),
+    // which must be sorted by key with no key repeated; std::invalid_argument
+    // is thrown otherwise and the tree is left empty.  Each leaf gets about
+    // fillFactor * LeafMax entries and each internal node about
+    // fillFactor * Order children, except that no node ends up less than
+    // half full.  fillFactor is clamped to [0.5, 1].
+    //
+    template <typename InputIt>
+    void bulk_load(InputIt firstEntry, InputIt lastEntry, double fillFactor = 1.0) {
+        clear();
+        fillFactor = std::min(1.0, std::max(0.5, fillFactor));
+        std::vector<std::pair<K, V>> entries(firstEntry, lastEntry);
+        for (std::size_t i = 1; i < entries.size(); ++i) {
+            if (!comp(entries[i - 1].first, entries[i].first))
+                throw std::invalid_argument("BPlusTree::bulk_load: keys must be sorted and unique");
+        }
+        if (entries.empty()) return;
+
+        // Leaves
+        std::size_t perLeaf = std::max<std::size_t>(MinLeaf, std::lround(fillFactor * LeafMax));
+        std::vector<Node*> level;
+        std::vector<K> lowKeys;   // smallest key under each node of `level`
+        Leaf* prev = nullptr;
+        std::size_t pos = 0;
+        for (std::size_t take : groupSizes(entries.size(), perLeaf, MinLeaf, LeafMax)) {
+            Leaf* leaf = new Leaf();
+            for (std::size_t j = 0; j < take; ++j, ++pos) {
+                leaf->keys[j] = std::move(entries[pos].first);
+                leaf->values[j] = std::move(entries[pos].second);
+            }
+            leaf->count = static_cast<int>(take);
+            if (prev) prev->next = leaf;
+            else first = leaf;
+            prev = leaf;
+            level.push_back(leaf);
+            lowKeys.push_back(leaf->keys[0]);
+        }
+        numEntries = entries.size();
+
+        // Internal levels, until one node is left
+        std::size_t perNode = std::max<std::size_t>(MinChildren, std::lround(fillFactor * Order));
+        while (level.size() > 1) {
+            std::vector<Node*> parents;
+            std::vector<K> parentLows;
+            pos = 0;
+            for (std::size_t take : groupSizes(level.size(), perNode, MinChildren, Order)) {
+                Internal* in = new Internal();
+                parentLows.push_back(lowKeys[pos]);
+                for (std::size_t j = 0; j < take; ++j, ++pos) {
+                    in->children[j] = level[pos];
+                    if (j > 0) in->keys[j - 1] = lowKeys[pos];
+                }
+                in->count = static_cast<int>(take) - 1;
+                parents.push_back(in);
+            }
+            level.swap(parents);
+            lowKeys.swap(parentLows);
+        }
+        root = level.front();
+    }
+
+    const V* find(const K& key) const {
+        if (!root) return nullptr;
+        const Leaf* leaf = findLeaf(key);
+        int i = rank(leaf->keys, leaf->count, key, false);
+        return (i < leaf->count && !comp(key, leaf->keys[i])) ? &leaf->values[i] : nullptr;
+    }
+
+    V* find(const K& key) { return const_cast<V*>(static_cast<const BPlusTree*>(this)->find(key)); }
+
+    bool contains(const K& key) const { return find(key) != nullptr; }
+
+    // First entry with a key not less than key.
+    const_iterator lower_bound(const K& key) const {
+        if (!root) return end();
+        const Leaf* leaf = findLeaf(key);
+        return const_iterator(leaf, rank(leaf->keys, leaf->count, key, false));
+    }
+
+    Range range(const K& lo, const K& hi) const { return Range(lower_bound(lo), hi, &comp); }
+
+    const_iterator begin() const { return const_iterator(first, 0); }
+    const_iterator end() const { return const_iterator(); }
+
+    // Number of levels; 0 for an empty tree.
+    int height() const {
+        int h = 0;
+        for (const Node* node = root; node; node = node->leaf ? nullptr : asInternal(node)->children[0])
+            ++h;
+        return h;
+    }
+
+    // Number of leaves and the average fraction of their slots in use.
+    std::pair<std::size_t, double> leafStats() const {
+        std::size_t leaves = 0;
+        for (const Leaf* leaf = first; leaf; leaf = leaf->next) ++leaves;
+        double fill = leaves ? double(numEntries) / (double(leaves) * LeafMax) : 0.0;
+        return { leaves, fill };
+    }
+
+    // Node sizes within bounds, keys in order and inside their separators,
+    // all leaves at one depth and chained left to right.
+    bool isValid() const {
+        if (!root) return numEntries == 0 && first == nullptr;
+        std::vector<const Leaf*> leaves;
+        if (checkedHeight(root, nullptr, nullptr, true, leaves) < 0) return false;
+        std::size_t n = 0;
+        const Leaf* leaf = first;
+        for (const Leaf* expected : leaves) {
+            if (leaf != expected) return false;
+            n += leaf->count;
+            leaf = leaf->next;
+        }
+        return leaf == nullptr && n == numEntries;
+    }
+};
@@ -0,0 +1,402 @@
+//
+// File:   btree.hpp
+// Author: Your Glorious Instructor
+// Purpose:
+// Provide a B-tree: the TwoThreeTree idea with many keys per node.
+//
+// A 2-3 tree is a B-tree of order 3: a node holds up to 2 keys and 3
+// children, a full node splits in two and sends its middle key up, and all
+// leaves sit at the same depth.  BTree<K, Order> does the same with up to
+// Order children and Order - 1 keys per node.  With a few dozen keys per
+// node the tree is only a handful of levels deep, and each level costs one
+// or two cache misses to bring a node in plus a fast search inside it.
+//
+// The algorithms are the single-pass ones from Cormen et al.,
+// "Introduction to Algorithms":
+//  - insert splits any full node it meets on the way down, so there is
+//    always room in the parent for the key that a split sends up;
+//  - erase makes sure every node it steps into has more than the minimum
+//    number of keys (borrowing from a sibling or merging with one), so the
+//    key can be taken out without walking back up.
+//
+// Keys live in fixed-size arrays inside the node and leaves don't carry a
+// child array at all, so a node is a single allocation.  K has to be
+// default constructible and should be cheap to move; ints, doubles and
+// short strings are what this is meant for.
+//
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <utility>
+
+template <typename K, int Order = 64, typename Compare = std::less<K>>
+class BTree {
+    static_assert(Order >= 4 && Order % 2 == 0, "BTree order must be an even number of at least 4");
+
+public:
+    static constexpr int MaxKeys = Order - 1;
+    static constexpr int MinKeys = Order / 2 - 1;   // except at the root
+
+private:
+    struct Node {
+        int count = 0;
+        bool leaf;
+        K keys[MaxKeys];
+
+        explicit Node(bool isLeaf) : leaf(isLeaf) {}
+    };
+
+    struct Internal : Node {
+        Node* children[Order];
+
+        Internal() : Node(false) {}
+    };
+
+    Node* root = nullptr;
+    std::size_t numKeys = 0;
+    Compare comp;
+
+    static Internal* internal(Node* node) { return static_cast<Internal*>(node); }
+    static const Internal* internal(const Node* node) { return static_cast<const Internal*>(node); }
+
+    static void destroy(Node* node) {
+        if (node->leaf) {
+            delete node;
+        } else {
+            Internal* in = internal(node);
+            for (int i = 0; i <= in->count; ++i) destroy(in->children[i]);
+            delete in;
+        }
+    }
+
+    // Delete one node whose keys and children have already been moved out.
+    static void freeNode(Node* node) {
+        if (node->leaf) delete node;
+        else delete internal(node);
+    }
+
+    //
+    // Index of the first key in node that is not less than key.  This is a
+    // binary search without the unpredictable branch: each step keeps
+    // either the lower or upper half of what is left, picked with a
+    // conditional move, and the loop always runs the same number of times
+    // for a given count.
+    //
+    int lowerBound(const Node* node, const K& key) const {
+        int n = node->count;
+        if (n == 0) return 0;
+        const K* base = node->keys;
+        while (n > 1) {
+            int half = n / 2;
+            base = comp(base[half], key) ? base + half : base;
+            n -= half;
+        }
+        return static_cast<int>(base - node->keys) + (comp(*base, key) ? 1 : 0);
+    }
+
+    bool matches(const Node* node, int i, const K& key) const {
+        return i < node->count && !comp(key, node->keys[i]);
+    }
+
+    //
+    // Split parent's full child i in two.  The upper half of its keys (and
+    // children) go to a new node, and the middle key moves up into parent.
+    //
+    void splitChild(Internal* parent, int i) {
+        constexpr int Half = Order / 2;   // keys left behind: Half - 1
+        Node* full = parent->children[i];
+        Node* sibling = full->leaf ? new Node(true) : new Internal();
+
+        std::move(full->keys + Half, full->keys + MaxKeys, sibling->keys);
+        sibling->count = MaxKeys - Half;
+        if (!full->leaf) {
+            std::move(internal(full)->children + Half, internal(full)->children + Order,
+                      internal(sibling)->children);
+        }
+        full->count = Half - 1;
+
+        std::move_backward(parent->keys + i, parent->keys + parent->count,
+                           parent->keys + parent->count + 1);
+        std::move_backward(parent->children + i + 1, parent->children + parent->count + 1,
+                           parent->children + parent->count + 2);
+        parent->keys[i] = std::move(full->keys[Half - 1]);
+        parent->children[i + 1] = sibling;
+        ++parent->count;
+    }
+
+    //
+    // Merge parent's children i and i + 1, with the key between them, into
+    // child i.  Both children have MinKeys keys, so the result is full.
+    //
+    void mergeChildren(Internal* parent, int i) {
+        Node* left = parent->children[i];
+        Node* right = parent->children[i + 1];
+
+        left->keys[left->count] = std::move(parent->keys[i]);
+        std::move(right->keys, right->keys + right->count, left->keys + left->count + 1);
+        if (!left->leaf) {
+            std::move(internal(right)->children, internal(right)->children + right->count + 1,
+                      internal(left)->children + left->count + 1);
+        }
+        left->count += right->count + 1;
+
+        std::move(parent->keys + i + 1, parent->keys + parent->count, parent->keys + i);
+        std::move(parent->children + i + 2, parent->children + parent->count + 1,
+                  parent->children + i + 1);
+        --parent->count;
+        freeNode(right);
+    }
+
+    // Move one key from child i's left sibling through the parent into it.
+    void borrowFromLeft(Internal* parent, int i) {
+        Node* child = parent->children[i];
+        Node* left = parent->children[i - 1];
+
+        std::move_backward(child->keys, child->keys + child->count, child->keys + child->count + 1);
+        child->keys[0] = std::move(parent->keys[i - 1]);
+        parent->keys[i - 1] = std::move(left->keys[left->count - 1]);
+        if (!child->leaf) {
+            Internal* c = internal(child);
+            std::move_backward(c->children, c->children + child->count + 1,
+                               c->children + child->count + 2);
+            c->children[0] = internal(left)->children[left->count];
+        }
+        ++child->count;
+        --left->count;
+    }
+
+    // Move one key from child i's right sibling through the parent into it.
+    void borrowFromRight(Internal* parent, int i) {
+        Node* child = parent->children[i];
+        Node* right = parent->children[i + 1];
+
+        child->keys[child->count] = std::move(parent->keys[i]);
+        parent->keys[i] = std::move(right->keys[0]);
+        std::move(right->keys + 1, right->keys + right->count, right->keys);
+        if (!child->leaf) {
+            Internal* r = internal(right);
+            internal(child)->children[child->count + 1] = r->children[0];
+            std::move(r->children + 1, r->children + right->count + 1, r->children);
+        }
+        ++child->count;
+        --right->count;
+    }
+
+    //
+    // Before erase steps from parent into child i, make sure the child has
+    // a key to spare.  Returns the node to step into, which is child i - 1
+    // if it had to be merged into its left sibling.
+    //
+    Node* fillChild(Internal* parent, int i) {
+        if (parent->children[i]->count > MinKeys) return parent->children[i];
+        if (i > 0 && parent->children[i - 1]->count > MinKeys) {
+            borrowFromLeft(parent, i);
+        } else if (i < parent->count && parent->children[i + 1]->count > MinKeys) {
+            borrowFromRight(parent, i);
+        } else if (i < parent->count) {
+            mergeChildren(parent, i);
+        } else {
+            mergeChildren(parent, i - 1);
+            return parent->children[i - 1];
+        }
+        return parent->children[i];
+    }
+
+    template <typename Visitor>
+    static void inorder(const Node* node, Visitor& visit) {
+        if (node->leaf) {
+            for (int i = 0; i < node->count; ++i) visit(node->keys[i]);
+            return;
+        }
+        const Internal* in = internal(node);
+        for (int i = 0; i < node->count; ++i) {
+            inorder(in->children[i], visit);
+            visit(node->keys[i]);
+        }
+        inorder(in->children[node->count], visit);
+    }
+
+    // Checks one subtree for isValid; returns its height or -1.  Keys must
+    // be strictly between lo and hi where those are given.
+    int checkedHeight(const Node* node, const K* lo, const K* hi, bool isRoot) const {
+        if (node->count > MaxKeys || (!isRoot && node->count < MinKeys)) return -1;
+        for (int i = 0; i < node->count; ++i) {
+            if (i > 0 && !comp(node->keys[i - 1], node->keys[i])) return -1;
+            if ((lo && !comp(*lo, node->keys[i])) || (hi && !comp(node->keys[i], *hi))) return -1;
+        }
+        if (node->leaf) return 1;
+        const Internal* in = internal(node);
+        int height = -1;
+        for (int i = 0; i <= node->count; ++i) {
+            int h = checkedHeight(in->children[i], i == 0 ? lo : &node->keys[i - 1],
+                                  i == node->count ? hi : &node->keys[i], false);
+            if (h < 0 || (height >= 0 && h != height)) return -1;
+            height = h;
+        }
+        return height + 1;
+    }
+
+public:
+    BTree() = default;
+    explicit BTree(const Compare& c) : comp(c) {}
+
+    BTree(const BTree&) = delete;
+    BTree& operator=(const BTree&) = delete;
+
+    BTree(BTree&& other) noexcept : root(other.root), numKeys(other.numKeys), comp(other.comp) {
+        other.root = nullptr;
+        other.numKeys = 0;
+    }
+    BTree& operator=(BTree&& other) noexcept {
+        std::swap(root, other.root);
+        std::swap(numKeys, other.numKeys);
+        std::swap(comp, other.comp);
+        return *this;
+    }
+
+    ~BTree() { clear(); }
+
+    std::size_t size() const { return numKeys; }
+    bool empty() const { return numKeys == 0; }
+
+    void clear() {
+        if (root) destroy(root);
+        root = nullptr;
+        numKeys = 0;
+    }
+
+    // Returns true if key was added, false if it was already there.
+    bool insert(const K& key) {
+        if (!root) root = new Node(true);
+        if (root->count == MaxKeys) {
+            Internal* newRoot = new Internal();
+            newRoot->children[0] = root;
+            root = newRoot;
+            splitChild(newRoot, 0);
+        }
+
+        Node* node = root;
+        for (;;) {
+            int i = lowerBound(node, key);
+            if (matches(node, i, key)) return false;
+            if (node->leaf) {
+                std::move_backward(node->keys + i, node->keys + node->count,
+                                   node->keys + node->count + 1);
+                node->keys[i] = key;
+                ++node->count;
+                ++numKeys;
+                return true;
+            }
+            Internal* in = internal(node);
+            if (in->children[i]->count == MaxKeys) {
+                splitChild(in, i);
+                if (comp(in->keys[i], key)) ++i;
+                else if (!comp(key, in->keys[i])) return false;   // it was the middle key
+            }
+            node = in->children[i];
+        }
+    }
+
+    // Returns true if key was there and has been removed.
+    bool erase(const K& key) {
+        if (!root) return false;
+        bool removed = false;
+        K target = key;
+        Node* node = root;
+        for (;;) {
+            int i = lowerBound(node, target);
+            bool found = matches(node, i, target);
+            if (node->leaf) {
+                if (found) {
+                    std::move(node->keys + i + 1, node->keys + node->count, node->keys + i);
+                    --node->count;
+                    removed = true;
+                }
+                break;
+            }
+
+            Internal* in = internal(node);
+            if (!found) {
+                node = fillChild(in, i);
+                continue;
+            }
+
+            // The key is in this internal node.  Replace it with its
+            // predecessor or successor and go on to delete that from the
+            // leaf it lives in, or, when neither side can spare a key,
+            // merge the two sides around it and delete it from there.
+            Node* left = in->children[i];
+            Node* right = in->children[i + 1];
+            if (left->count > MinKeys) {
+                const Node* n = left;
+                while (!n->leaf) n = internal(n)->children[n->count];
+                in->keys[i] = n->keys[n->count - 1];
+                target = in->keys[i];
+                node = left;
+            } else if (right->count > MinKeys) {
+                const Node* n = right;
+                while (!n->leaf) n = internal(n)->children[0];
+                in->keys[i] = n->keys[0];
+                target = in->keys[i];
+                node = right;
+            } else {
+                mergeChildren(in, i);
+                node = left;
+            }
+        }
+
+        // A merge may have emptied the root.
+        if (root->count == 0) {
+            Node* old = root;
+            root = root->leaf ? nullptr : internal(root)->children[0];
+            freeNode(old);
+        }
+        if (removed) --numKeys;
+        return removed;
+    }
+
+    bool contains(const K& key) const {
+        const Node* node = root;
+        while (node) {
+            int i = lowerBound(node, key);
+            if (matches(node, i, key)) return true;
+            node = node->leaf ? nullptr : internal(node)->children[i];
+        }
+        return false;
+    }
+
+    // Same interface as TwoThreeTree::search.
+    std::optional<K> search(const K& key) const {
+        const Node* node = root;
+        while (node) {
+            int i = lowerBound(node, key);
+            if (matches(node, i, key)) return node->keys[i];
+            node = node->leaf ? nullptr : internal(node)->children[i];
+        }
+        return std::nullopt;
+    }
+
+    // Call visit(key) for every key, in order.
+    template <typename Visitor>
+    void forEach(Visitor visit) const {
+        if (root) inorder(root, visit);
+    }
+
+    // Number of levels; 0 for an empty tree.
+    int height() const {
+        int h = 0;
+        for (const Node* node = root; node; node = node->leaf ? nullptr : internal(node)->children[0])
+            ++h;
+        return h;
+    }
+
+    // Key counts within bounds, keys in order, all leaves at one depth.
+    bool isValid() const {
+        if (!root) return numKeys == 0;
+        std::size_t n = 0;
+        forEach([&n](const K&) { ++n; });
+        return n == numKeys && checkedHeight(root, nullptr, nullptr, true) > 0;
+    }
+};
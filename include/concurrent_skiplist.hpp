@@ -0,0 +1,450 @@
+//
+// File:   concurrent_skiplist.hpp
+// Author: Your Glorious Instructor
+// Purpose:
+// A lock-free skip list that many threads can search, insert into and erase
+// from at the same time.
+//
+// The design follows the lock-free skip list from Herlihy & Shavit's "The Art
+// of Multiprocessor Programming":
+//
+//  - Each forward link is an atomic word holding a pointer and, in its lowest
+//    bit, a "marked" flag.  Marking a node's link at some level means the node
+//    is being deleted at that level; nobody may link anything after it there.
+//  - erase() marks a node's links from the top level down.  Whoever marks
+//    level 0 owns the deletion; that is the moment the key leaves the set.
+//  - Searches that run into a marked node help by unlinking it (a CAS on the
+//    predecessor's link) and carry on.  contains() doesn't even do that much:
+//    it just steps over marked nodes and never writes anything.
+//  - insert() links the new node at level 0 with one CAS (the moment it joins
+//    the set) and then links the higher levels one at a time.
+//
+// Freeing memory is the hard part of lock-free code: after a node has been
+// unlinked, another thread may still be standing on it.  We use epoch-based
+// reclamation (see EpochDomain below): every operation runs inside an epoch
+// guard, and an unlinked node is only freed once every thread that might
+// have seen it has left its guard.
+//
+// Each thread draws tower heights from its own random number generator, so
+// unlike SkipList there is no shared generator to fight over.
+//
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <random>
+#include <utility>
+#include <vector>
+
+//
+// Epoch-based reclamation.
+//
+// There is a global epoch number.  A thread entering a guarded section
+// announces the epoch it saw; leaving, it announces that it is quiescent.
+// Retired objects are tagged with the epoch in which they were retired.  The
+// global epoch may only advance once every active thread has caught up with
+// it, so once it has moved two steps past an object's tag, no thread can
+// still hold a reference obtained before the object was unlinked, and the
+// object can be freed.
+//
+// One process-wide domain is shared by every ConcurrentSkipList.  Threads
+// get a record the first time they enter a guard and give it back (for
+// another thread to reuse, pending garbage and all) when they exit.
+//
+class EpochDomain {
+private:
+    static constexpr std::uint64_t Quiescent = ~std::uint64_t(0);
+    static constexpr int ScanInterval = 64;
+
+    struct Retired {
+        void* object;
+        void (*deleter)(void*);
+    };
+
+    //
+    // Per-thread state.  Objects retired in epoch e go in limbo[e % 3];
+    // limboEpoch remembers which epoch each of those lists belongs to.
+    //
+    struct Record {
+        std::atomic<std::uint64_t> announced{ Quiescent };
+        std::atomic<bool> inUse{ true };
+        Record* next = nullptr;
+        int nesting = 0;
+        int retiredSinceScan = 0;
+        std::vector<Retired> limbo[3];
+        std::uint64_t limboEpoch[3] = { 0, 0, 0 };
+    };
+
+public:
+    using Deleter = void (*)(void*);
+
+    static EpochDomain& instance() {
+        static EpochDomain domain;
+        return domain;
+    }
+
+    // RAII guard: all access to shared nodes happens while one is alive.
+    // Guards nest; only the outermost one announces anything.
+    class Guard {
+    public:
+        Guard() : record(instance().localRecord()) {
+            if (record->nesting++ == 0) instance().enter(*record);
+        }
+        ~Guard() {
+            if (--record->nesting == 0) instance().leave(*record);
+        }
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+
+    private:
+        Record* record;
+    };
+
+    // Hand an unlinked object over to be freed once it is safe.  Must be
+    // called inside a Guard, and the object must already be unreachable
+    // for any thread that starts looking after this call.
+    void retire(void* object, Deleter deleter) {
+        Record& rec = *localRecord();
+        std::uint64_t epoch = globalEpoch.load();
+        int slot = static_cast<int>(epoch % 3);
+        if (rec.limboEpoch[slot] != epoch) {
+            // Whatever is still in this slot is at least three epochs old.
+            freeList(rec.limbo[slot]);
+            rec.limboEpoch[slot] = epoch;
+        }
+        rec.limbo[slot].push_back(Retired{ object, deleter });
+        if (++rec.retiredSinceScan >= ScanInterval) {
+            rec.retiredSinceScan = 0;
+            tryAdvance();
+            reclaim(rec);
+        }
+    }
+
+    ~EpochDomain() {
+        // Program exit: no thread can be inside a guard any more.
+        Record* rec = records.load();
+        while (rec != nullptr) {
+            Record* next = rec->next;
+            for (auto& list : rec->limbo) freeList(list);
+            delete rec;
+            rec = next;
+        }
+    }
+
+private:
+    EpochDomain() = default;
+
+    // Gives the thread's record back to the domain when the thread exits.
+    // Anything still in its limbo lists is freed by the next thread to pick
+    // the record up, or when the program ends.
+    struct ThreadRecord {
+        Record* record = nullptr;
+        ~ThreadRecord() {
+            if (record != nullptr) record->inUse.store(false, std::memory_order_release);
+        }
+    };
+
+    Record* localRecord() {
+        static thread_local ThreadRecord local;
+        if (local.record == nullptr) local.record = acquireRecord();
+        return local.record;
+    }
+
+    // Reuse a record abandoned by a finished thread, or add a new one.
+    Record* acquireRecord() {
+        for (Record* rec = records.load(std::memory_order_acquire); rec != nullptr; rec = rec->next) {
+            bool expected = false;
+            if (!rec->inUse.load(std::memory_order_relaxed) &&
+                rec->inUse.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+                return rec;
+        }
+        Record* rec = new Record();
+        Record* head = records.load(std::memory_order_relaxed);
+        do {
+            rec->next = head;
+        } while (!records.compare_exchange_weak(head, rec, std::memory_order_acq_rel));
+        return rec;
+    }
+
+    void enter(Record& rec) {
+        // The announcement has to be visible before we read any shared
+        // pointer, and has to name the current epoch once it is.  These are
+        // sequentially consistent operations, which gives us both.
+        std::uint64_t epoch = globalEpoch.load();
+        rec.announced.store(epoch);
+        while (epoch != globalEpoch.load()) {
+            epoch = globalEpoch.load();
+            rec.announced.store(epoch);
+        }
+    }
+
+    void leave(Record& rec) {
+        rec.announced.store(Quiescent, std::memory_order_release);
+    }
+
+    // Move the global epoch forward if every active thread has seen it.
+    void tryAdvance() {
+        std::uint64_t epoch = globalEpoch.load();
+        for (Record* rec = records.load(); rec != nullptr; rec = rec->next) {
+            std::uint64_t seen = rec->announced.load();
+            if (seen != Quiescent && seen != epoch) return;
+        }
+        globalEpoch.compare_exchange_strong(epoch, epoch + 1);
+    }
+
+    // Free this thread's objects that were retired two or more epochs ago.
+    void reclaim(Record& rec) {
+        std::uint64_t epoch = globalEpoch.load();
+        for (int slot = 0; slot < 3; ++slot)
+            if (rec.limboEpoch[slot] + 2 <= epoch) freeList(rec.limbo[slot]);
+    }
+
+    static void freeList(std::vector<Retired>& list) {
+        for (auto& r : list) r.deleter(r.object);
+        list.clear();
+    }
+
+    std::atomic<std::uint64_t> globalEpoch{ 0 };
+    std::atomic<Record*> records{ nullptr };
+};
+
+template <typename Comparable, int MaxLevel = 24>
+class ConcurrentSkipList {
+private:
+    //
+    // A node is allocated as one block: the Node header followed directly by
+    // its tower of `height` atomic links.  The head node has the full
+    // MaxLevel tower and no key.
+    //
+    // A deleted node can only be retired once nobody will link it in again.
+    // Its inserter may still be adding upper levels while it is being
+    // erased, so the inserter and the eraser each drop one of the two
+    // `owners` when they are finished with it, and the last one retires it.
+    //
+    struct alignas(std::atomic<std::uintptr_t>) Node {
+        alignas(Comparable) unsigned char keyStorage[sizeof(Comparable)];
+        int height;
+        std::atomic<int> owners;
+
+        const Comparable& key() const { return *reinterpret_cast<const Comparable*>(keyStorage); }
+
+        std::atomic<std::uintptr_t>& next(int level) {
+            return reinterpret_cast<std::atomic<std::uintptr_t>*>(this + 1)[level];
+        }
+    };
+
+    static Node* allocate(int height) {
+        void* raw = ::operator new(sizeof(Node) + height * sizeof(std::atomic<std::uintptr_t>));
+        Node* node = ::new (raw) Node;
+        node->height = height;
+        node->owners.store(2, std::memory_order_relaxed);
+        for (int i = 0; i < height; ++i)
+            ::new (static_cast<void*>(&node->next(i))) std::atomic<std::uintptr_t>(0);
+        return node;
+    }
+
+    static Node* makeNode(const Comparable& key, int height) {
+        Node* node = allocate(height);
+        ::new (static_cast<void*>(node->keyStorage)) Comparable(key);
+        return node;
+    }
+
+    // Used as the EpochDomain deleter and by the destructor.
+    static void destroyNode(void* p) {
+        Node* node = static_cast<Node*>(p);
+        reinterpret_cast<Comparable*>(node->keyStorage)->~Comparable();
+        ::operator delete(p);
+    }
+
+    static void release(Node* node) {
+        if (node->owners.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            EpochDomain::instance().retire(node, &destroyNode);
+    }
+
+    // Marked-pointer helpers: bit 0 of a link is the deletion mark.
+    static Node* ptr(std::uintptr_t link) { return reinterpret_cast<Node*>(link & ~std::uintptr_t(1)); }
+    static bool marked(std::uintptr_t link) { return (link & 1) != 0; }
+    static std::uintptr_t pack(Node* node, bool mark = false) {
+        return reinterpret_cast<std::uintptr_t>(node) | (mark ? 1 : 0);
+    }
+
+    // Each thread has its own generator.  A tower grows by one level for
+    // every trailing 1 bit of a random word, so each level is half as likely
+    // as the one below it.
+    static int randomLevel() {
+        static thread_local std::mt19937 gen(std::random_device{}());
+        std::uint32_t bits = gen();
+        int lvl = 1;
+        while ((bits & 1) && lvl < MaxLevel) {
+            ++lvl;
+            bits >>= 1;
+        }
+        return lvl;
+    }
+
+    //
+    // Fill preds/succs with the nodes either side of where key belongs on
+    // every level, unlinking any marked nodes we pass.  If one of those
+    // unlinks fails, something changed under us and we start over.  Returns
+    // true if an unmarked node holding key was found at level 0.
+    //
+    bool find(const Comparable& key, Node** preds, Node** succs) {
+    retry:
+        Node* pred = head;
+        for (int level = MaxLevel - 1; level >= 0; --level) {
+            Node* curr = ptr(pred->next(level).load(std::memory_order_acquire));
+            while (curr != nullptr) {
+                std::uintptr_t succ = curr->next(level).load(std::memory_order_acquire);
+                while (marked(succ)) {
+                    std::uintptr_t expected = pack(curr);
+                    if (!pred->next(level).compare_exchange_strong(expected, pack(ptr(succ)),
+                                                                   std::memory_order_acq_rel))
+                        goto retry;
+                    curr = ptr(succ);
+                    if (curr == nullptr) break;
+                    succ = curr->next(level).load(std::memory_order_acquire);
+                }
+                if (curr == nullptr || !(curr->key() < key)) break;
+                pred = curr;
+                curr = ptr(succ);
+            }
+            preds[level] = pred;
+            succs[level] = curr;
+        }
+        return succs[0] != nullptr && !(key < succs[0]->key());
+    }
+
+    Node* head;
+    std::atomic<std::size_t> count{ 0 };
+
+public:
+    ConcurrentSkipList() : head(allocate(MaxLevel)) {}
+
+    ConcurrentSkipList(const ConcurrentSkipList&) = delete;
+    ConcurrentSkipList& operator=(const ConcurrentSkipList&) = delete;
+
+    // Destruction must not race with any other operation on the list.
+    ~ConcurrentSkipList() {
+        Node* node = ptr(head->next(0).load());
+        while (node != nullptr) {
+            Node* next = ptr(node->next(0).load());
+            destroyNode(node);
+            node = next;
+        }
+        ::operator delete(head);
+    }
+
+    // Returns true if the key was added, false if it was already present.
+    bool insert(const Comparable& key) {
+        EpochDomain::Guard guard;
+        Node* preds[MaxLevel];
+        Node* succs[MaxLevel];
+        int height = randomLevel();
+        Node* node = nullptr;
+        for (;;) {
+            if (find(key, preds, succs)) {
+                if (node != nullptr) destroyNode(node);   // never published
+                return false;
+            }
+            if (node == nullptr) node = makeNode(key, height);
+            for (int i = 0; i < height; ++i)
+                node->next(i).store(pack(succs[i]), std::memory_order_relaxed);
+            std::uintptr_t expected = pack(succs[0]);
+            if (preds[0]->next(0).compare_exchange_strong(expected, pack(node),
+                                                          std::memory_order_release))
+                break;
+        }
+        count.fetch_add(1, std::memory_order_relaxed);
+
+        // The key is in the set; now add the express lanes above level 0.
+        for (int level = 1; level < height; ++level) {
+            for (;;) {
+                // Point our link at the current successor, unless someone
+                // has already started deleting us at this level.
+                std::uintptr_t mine = node->next(level).load(std::memory_order_acquire);
+                if (marked(mine)) goto done;
+                if (ptr(mine) != succs[level] &&
+                    !node->next(level).compare_exchange_strong(mine, pack(succs[level]),
+                                                               std::memory_order_acq_rel))
+                    goto done;
+                std::uintptr_t expected = pack(succs[level]);
+                if (preds[level]->next(level).compare_exchange_strong(expected, pack(node),
+                                                                      std::memory_order_release))
+                    break;
+                find(key, preds, succs);
+                if (succs[0] != node) goto done;   // we were deleted meanwhile
+            }
+        }
+    done:
+        // If an erase raced with us it may have finished its cleanup before
+        // we linked some upper level.  Clean up after it so the node is fully
+        // unlinked before it can be retired.
+        if (marked(node->next(0).load(std::memory_order_acquire))) find(key, preds, succs);
+        release(node);
+        return true;
+    }
+
+    // Returns true if this call removed the key.
+    bool erase(const Comparable& key) {
+        EpochDomain::Guard guard;
+        Node* preds[MaxLevel];
+        Node* succs[MaxLevel];
+        if (!find(key, preds, succs)) return false;
+        Node* victim = succs[0];
+
+        // Mark the upper levels, top down, so no new links go in after it.
+        for (int level = victim->height - 1; level >= 1; --level) {
+            std::uintptr_t succ = victim->next(level).load(std::memory_order_acquire);
+            while (!marked(succ))
+                victim->next(level).compare_exchange_weak(succ, succ | 1, std::memory_order_acq_rel);
+        }
+
+        // Marking level 0 is what removes the key; only one thread wins.
+        std::uintptr_t succ = victim->next(0).load(std::memory_order_acquire);
+        for (;;) {
+            if (marked(succ)) return false;
+            if (victim->next(0).compare_exchange_weak(succ, succ | 1, std::memory_order_acq_rel))
+                break;
+        }
+        count.fetch_sub(1, std::memory_order_relaxed);
+        find(key, preds, succs);   // unlink it everywhere
+        release(victim);
+        return true;
+    }
+
+    // Wait-free apart from the guard: reads only, stepping over marked nodes.
+    bool contains(const Comparable& key) const {
+        EpochDomain::Guard guard;
+        Node* pred = head;
+        Node* curr = nullptr;
+        for (int level = MaxLevel - 1; level >= 0; --level) {
+            curr = ptr(pred->next(level).load(std::memory_order_acquire));
+            while (curr != nullptr) {
+                std::uintptr_t succ = curr->next(level).load(std::memory_order_acquire);
+                if (marked(succ)) {
+                    curr = ptr(succ);
+                } else if (curr->key() < key) {
+                    pred = curr;
+                    curr = ptr(succ);
+                } else {
+                    break;
+                }
+            }
+        }
+        return curr != nullptr && !(key < curr->key());
+    }
+
+    // A snapshot of the number of keys; exact only when no updates are
+    // running.
+    std::size_t size() const { return count.load(std::memory_order_relaxed); }
+
+    // Visit the keys in order.  Only safe when no other thread is modifying
+    // the list.
+    template <typename Visitor>
+    void forEach(Visitor visit) const {
+        for (Node* node = ptr(head->next(0).load()); node != nullptr;
+             node = ptr(node->next(0).load()))
+            if (!marked(node->next(0).load())) visit(node->key());
+    }
+};
@@ -0,0 +1,626 @@
+//
+// File:   diskbtree.hpp
+// Author: Your Glorious Instructor
+// Purpose:
+// Provide a B+tree that lives in a file, for indexes that don't fit in
+// memory.
+//
+// The file is an array of fixed-size pages.  Page 0 is a header saying
+// where the root is and how big the tree is; every other page is one tree
+// node.  Leaves hold the key/value pairs and a link to the next leaf, and
+// internal nodes hold separator keys and child page numbers.  With 4K pages
+// and 8-byte keys a node has a couple of hundred children, so even a
+// billion entries are only four levels deep and a lookup reads at most
+// four pages, fewer once the top of the tree is cached.
+//
+// Pages are read and written with pread/pwrite through a PageCache: a
+// fixed number of in-memory frames managed least-recently-used first.  A
+// page in use is "pinned" and can't be evicted; a changed page is written
+// back when it is evicted or on flush().
+//
+// Insertion works like TwoThreeTree::insertRec and splitNode: go down to
+// the leaf, add the entry, and if the node overflows split it and hand the
+// separator key and new page back up to the parent, which may split in
+// turn.  A split root becomes the child of a new root.
+//
+// Keys and values are copied to and from the pages byte for byte, so they
+// must be trivially copyable (numbers, or structs of numbers).  This uses
+// POSIX file I/O.
+//
+#pragma once
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <list>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//
+// A fixed-size cache of file pages.  fetch() pins a page in memory and
+// returns a handle; the page stays put until every handle to it is gone.
+// Unpinned pages are kept in least-recently-used order, and when a frame
+// is needed the oldest one is written back (if it changed) and reused.
+//
+class PageCache {
+private:
+    struct Frame {
+        std::uint32_t page = 0;
+        int pins = 0;
+        bool dirty = false;
+        bool used = false;
+        std::unique_ptr<char[]> data;
+        std::list<std::size_t>::iterator lruPos;
+    };
+
+public:
+    // A pinned page.  Call markDirty() after changing its bytes.
+    class Handle {
+    public:
+        Handle() = default;
+        Handle(const Handle&) = delete;
+        Handle& operator=(const Handle&) = delete;
+        Handle(Handle&& other) noexcept : cache(other.cache), frame(other.frame) { other.cache = nullptr; }
+        Handle& operator=(Handle&& other) noexcept {
+            std::swap(cache, other.cache);
+            std::swap(frame, other.frame);
+            return *this;
+        }
+        ~Handle() {
+            if (cache) cache->unpin(frame);
+        }
+
+        char* data() const { return cache->frames[frame].data.get(); }
+        std::uint32_t page() const { return cache->frames[frame].page; }
+        void markDirty() const { cache->frames[frame].dirty = true; }
+
+    private:
+        friend class PageCache;
+        Handle(PageCache* c, std::size_t f) : cache(c), frame(f) {}
+        PageCache* cache = nullptr;
+        std::size_t frame = 0;
+    };
+
+    struct Stats {
+        std::uint64_t hits = 0;
+        std::uint64_t reads = 0;    // pages read from the file
+        std::uint64_t writes = 0;   // pages written to the file
+    };
+
+    PageCache(int fd, std::size_t pageSize, std::size_t capacity)
+        : fd(fd), pageSize(pageSize), frames(capacity) {
+        for (auto& f : frames) f.data.reset(new char[pageSize]);
+    }
+
+    PageCache(const PageCache&) = delete;
+    PageCache& operator=(const PageCache&) = delete;
+
+    // Pin page and return it, reading it in if it isn't cached.  A page
+    // past the end of the file reads as zeros.
+    Handle fetch(std::uint32_t page) {
+        auto found = table.find(page);
+        if (found != table.end()) {
+            ++stats.hits;
+            Frame& f = frames[found->second];
+            if (f.pins++ == 0) lru.erase(f.lruPos);
+            return Handle(this, found->second);
+        }
+        std::size_t slot = takeFrame();
+        Frame& f = frames[slot];
+        readPage(page, f.data.get());
+        f.page = page;
+        f.pins = 1;
+        f.dirty = false;
+        f.used = true;
+        table.emplace(page, slot);
+        return Handle(this, slot);
+    }
+
+    // Write every changed page back to the file.
+    void flush() {
+        for (auto& f : frames) {
+            if (f.used && f.dirty) {
+                writePage(f.page, f.data.get());
+                f.dirty = false;
+            }
+        }
+    }
+
+    // Forget every page without writing anything back.  Only for pages
+    // that have just been flushed; used to start benchmarks cold.
+    void discard() {
+        for (std::size_t i = 0; i < frames.size(); ++i) {
+            if (frames[i].used && frames[i].pins == 0) {
+                lru.erase(frames[i].lruPos);
+                table.erase(frames[i].page);
+                frames[i].used = false;
+                frames[i].dirty = false;
+            }
+        }
+    }
+
+    const Stats& statistics() const { return stats; }
+    void resetStatistics() { stats = Stats(); }
+    std::size_t capacity() const { return frames.size(); }
+
+private:
+    void unpin(std::size_t slot) {
+        Frame& f = frames[slot];
+        if (--f.pins == 0) {
+            lru.push_front(slot);
+            f.lruPos = lru.begin();
+        }
+    }
+
+    // A free frame, or the least recently used unpinned one.
+    std::size_t takeFrame() {
+        for (std::size_t i = nextUnused; i < frames.size(); ++i) {
+            if (!frames[i].used) {
+                nextUnused = i + 1;
+                return i;
+            }
+        }
+        nextUnused = frames.size();
+        for (std::size_t i = 0; i < frames.size(); ++i)
+            if (!frames[i].used) return i;
+        if (lru.empty()) throw std::runtime_error("PageCache: every page is pinned");
+        std::size_t slot = lru.back();
+        lru.pop_back();
+        Frame& f = frames[slot];
+        if (f.dirty) writePage(f.page, f.data.get());
+        table.erase(f.page);
+        f.used = false;
+        return slot;
+    }
+
+    void readPage(std::uint32_t page, char* buf) {
+        off_t offset = static_cast<off_t>(page) * static_cast<off_t>(pageSize);
+        std::size_t done = 0;
+        while (done < pageSize) {
+            ssize_t n = ::pread(fd, buf + done, pageSize - done, offset + static_cast<off_t>(done));
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                throw std::system_error(errno, std::generic_category(), "PageCache: read failed");
+            }
+            if (n == 0) break;   // past the end of the file
+            done += static_cast<std::size_t>(n);
+        }
+        std::memset(buf + done, 0, pageSize - done);
+        ++stats.reads;
+    }
+
+    void writePage(std::uint32_t page, const char* buf) {
+        off_t offset = static_cast<off_t>(page) * static_cast<off_t>(pageSize);
+        std::size_t done = 0;
+        while (done < pageSize) {
+            ssize_t n = ::pwrite(fd, buf + done, pageSize - done, offset + static_cast<off_t>(done));
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                throw std::system_error(errno, std::generic_category(), "PageCache: write failed");
+            }
+            done += static_cast<std::size_t>(n);
+        }
+        ++stats.writes;
+    }
+
+    int fd;
+    std::size_t pageSize;
+    std::vector<Frame> frames;
+    std::size_t nextUnused = 0;
+    std::unordered_map<std::uint32_t, std::size_t> table;   // page -> frame
+    std::list<std::size_t> lru;                             // unpinned, newest first
+    Stats stats;
+};
+
+template <typename K, typename V, std::size_t PageSize = 4096, typename Compare = std::less<K>>
+class DiskBTree {
+    static_assert(std::is_trivially_copyable<K>::value && std::is_trivially_copyable<V>::value,
+                  "DiskBTree keys and values are stored byte for byte");
+
+private:
+    //
+    // Page layouts.  Every node page starts with a NodeHeader.  A leaf then
+    // has LeafMax keys followed by LeafMax values; an internal node has
+    // InternalMax - 1 keys followed by InternalMax child page numbers.
+    //
+    struct FileHeader {
+        std::uint64_t magic;
+        std::uint32_t pageSize;
+        std::uint32_t keySize;
+        std::uint32_t valueSize;
+        std::uint32_t root;
+        std::uint32_t pageCount;
+        std::uint32_t height;
+        std::uint64_t entries;
+    };
+
+    struct NodeHeader {
+        std::uint16_t count;   // entries in a leaf, keys in an internal node
+        std::uint8_t leaf;
+        std::uint8_t unused;
+        std::uint32_t next;    // next leaf, 0 for none
+    };
+
+    static constexpr std::uint64_t Magic = 0x3233374254726565ull;   // "eerTB723"
+    static constexpr std::size_t Body = PageSize - sizeof(NodeHeader);
+
+public:
+    static constexpr int LeafMax = static_cast<int>(Body / (sizeof(K) + sizeof(V)));
+    static constexpr int InternalMax = static_cast<int>((Body + sizeof(K)) / (sizeof(K) + sizeof(std::uint32_t)));
+    static_assert(sizeof(FileHeader) <= PageSize && LeafMax >= 3 && InternalMax >= 3,
+                  "pages are too small for these keys and values");
+    // NodeHeader::count is 16 bits.
+    static_assert(LeafMax <= UINT16_MAX && InternalMax <= UINT16_MAX,
+                  "pages hold more entries than a node can count");
+
+private:
+    //
+    // A view of a node in a pinned page.  Fields are copied in and out with
+    // memcpy since nothing in the page is guaranteed to be aligned.
+    //
+    class Node {
+    public:
+        explicit Node(char* page) : page(page) {}
+
+        NodeHeader header() const {
+            NodeHeader h;
+            std::memcpy(&h, page, sizeof h);
+            return h;
+        }
+        void setHeader(const NodeHeader& h) { std::memcpy(page, &h, sizeof h); }
+
+        int count() const { return header().count; }
+        bool leaf() const { return header().leaf != 0; }
+
+        K key(int i) const { return load<K>(keysAt() + i * sizeof(K)); }
+        void setKey(int i, const K& k) { store(keysAt() + i * sizeof(K), k); }
+
+        V value(int i) const { return load<V>(valuesAt() + i * sizeof(V)); }
+        void setValue(int i, const V& v) { store(valuesAt() + i * sizeof(V), v); }
+
+        std::uint32_t child(int i) const { return load<std::uint32_t>(childrenAt() + i * 4); }
+        void setChild(int i, std::uint32_t c) { store(childrenAt() + i * 4, c); }
+
+    private:
+        template <typename T>
+        static T load(const char* p) {
+            T t;
+            std::memcpy(&t, p, sizeof(T));
+            return t;
+        }
+        template <typename T>
+        static void store(char* p, const T& t) { std::memcpy(p, &t, sizeof(T)); }
+
+        char* keysAt() const { return page + sizeof(NodeHeader); }
+        char* valuesAt() const { return keysAt() + LeafMax * sizeof(K); }
+        char* childrenAt() const { return keysAt() + (InternalMax - 1) * sizeof(K); }
+
+        char* page;
+    };
+
+    // What a node that split hands back to its parent.
+    struct Split {
+        K separator;             // smallest key in the new right-hand node
+        std::uint32_t right;     // its page
+    };
+
+    int fd = -1;
+    FileHeader header{};
+    std::unique_ptr<PageCache> cache;
+    Compare comp;
+
+    // Number of keys in node (the first `count` of them) less than key,
+    // or with orEqual, not greater than key.
+    int rank(const Node& node, int count, const K& key, bool orEqual) const {
+        int lo = 0, hi = count;
+        while (lo < hi) {
+            int mid = (lo + hi) / 2;
+            K k = node.key(mid);
+            if (orEqual ? !comp(key, k) : comp(k, key)) lo = mid + 1;
+            else hi = mid;
+        }
+        return lo;
+    }
+
+    std::uint32_t newPage(bool leaf) {
+        std::uint32_t page = header.pageCount++;
+        PageCache::Handle h = cache->fetch(page);
+        std::memset(h.data(), 0, PageSize);
+        Node(h.data()).setHeader(NodeHeader{ 0, static_cast<std::uint8_t>(leaf), 0, 0 });
+        h.markDirty();
+        return page;
+    }
+
+    void writeHeader() {
+        PageCache::Handle h = cache->fetch(0);
+        std::memset(h.data(), 0, PageSize);
+        std::memcpy(h.data(), &header, sizeof header);
+        h.markDirty();
+    }
+
+    //
+    // Insert into the subtree at page.  Returns the split, if the node had
+    // to split.  Sets added to false if key was already there (its value
+    // is replaced).  rightEdge says this node is the last on its level, so
+    // a key going past its end is bigger than every key in the tree.
+    //
+    std::optional<Split> insertRec(std::uint32_t page, const K& key, const V& value, bool rightEdge,
+                                   bool& added) {
+        PageCache::Handle h = cache->fetch(page);
+        Node node(h.data());
+        NodeHeader nh = node.header();
+
+        if (nh.leaf) {
+            int i = rank(node, nh.count, key, false);
+            if (i < nh.count && !comp(key, node.key(i))) {
+                node.setValue(i, value);
+                h.markDirty();
+                added = false;
+                return std::nullopt;
+            }
+            added = true;
+            if (nh.count < LeafMax) {
+                insertIntoLeaf(node, nh, i, key, value);
+                h.markDirty();
+                return std::nullopt;
+            }
+            return splitLeaf(h, node, nh, i, key, value, rightEdge && i == nh.count);
+        }
+
+        int i = rank(node, nh.count, key, true);
+        std::uint32_t child = node.child(i);
+        std::optional<Split> split = insertRec(child, key, value, rightEdge && i == nh.count, added);
+        if (!split) return std::nullopt;
+        if (nh.count < InternalMax - 1) {
+            insertIntoInternal(node, nh, i, *split);
+            h.markDirty();
+            return std::nullopt;
+        }
+        return splitInternal(h, node, nh, i, *split, rightEdge && i == nh.count);
+    }
+
+    static void insertIntoLeaf(Node& node, NodeHeader& nh, int i, const K& key, const V& value) {
+        for (int j = nh.count; j > i; --j) {
+            node.setKey(j, node.key(j - 1));
+            node.setValue(j, node.value(j - 1));
+        }
+        node.setKey(i, key);
+        node.setValue(i, value);
+        ++nh.count;
+        node.setHeader(nh);
+    }
+
+    // The new key goes after key i - 1, the new child after child i.
+    static void insertIntoInternal(Node& node, NodeHeader& nh, int i, const Split& split) {
+        for (int j = nh.count; j > i; --j) node.setKey(j, node.key(j - 1));
+        for (int j = nh.count + 1; j > i + 1; --j) node.setChild(j, node.child(j - 1));
+        node.setKey(i, split.separator);
+        node.setChild(i + 1, split.right);
+        ++nh.count;
+        node.setHeader(nh);
+    }
+
+    //
+    // The leaf is full: lay out its entries plus the new one in order, keep
+    // the first half and move the rest to a new leaf linked in after it.
+    //
+    // When appending, a new key past the end of the last leaf, an even
+    // split would leave behind half-empty leaves that never fill up, so the
+    // old leaf stays full and the new one starts with just the new key.
+    // Loading keys in order then packs the leaves.
+    //
+    Split splitLeaf(PageCache::Handle& h, Node& node, NodeHeader& nh, int i, const K& key, const V& value,
+                    bool appending) {
+        std::vector<std::pair<K, V>> all;
+        all.reserve(nh.count + 1);
+        for (int j = 0; j < nh.count; ++j) all.emplace_back(node.key(j), node.value(j));
+        all.insert(all.begin() + i, std::make_pair(key, value));
+
+        std::uint32_t rightPage = newPage(true);
+        PageCache::Handle rh = cache->fetch(rightPage);
+        Node right(rh.data());
+
+        int keep = static_cast<int>(appending ? all.size() - 1 : all.size() / 2);
+        for (int j = 0; j < keep; ++j) {
+            node.setKey(j, all[j].first);
+            node.setValue(j, all[j].second);
+        }
+        int moved = static_cast<int>(all.size()) - keep;
+        for (int j = 0; j < moved; ++j) {
+            right.setKey(j, all[keep + j].first);
+            right.setValue(j, all[keep + j].second);
+        }
+        right.setHeader(NodeHeader{ static_cast<std::uint16_t>(moved), 1, 0, nh.next });
+        nh.count = static_cast<std::uint16_t>(keep);
+        nh.next = rightPage;
+        node.setHeader(nh);
+        h.markDirty();
+        rh.markDirty();
+        return Split{ all[keep].first, rightPage };
+    }
+
+    //
+    // The internal node is full: lay out its keys and children with the
+    // new ones, keep the first half, send the middle key up and move the
+    // rest to a new node.  When appending, the old node keeps all but the
+    // last key and the new node starts with only the new child.
+    //
+    Split splitInternal(PageCache::Handle& h, Node& node, NodeHeader& nh, int i, const Split& split,
+                        bool appending) {
+        std::vector<K> keys;
+        std::vector<std::uint32_t> children;
+        for (int j = 0; j < nh.count; ++j) keys.push_back(node.key(j));
+        for (int j = 0; j <= nh.count; ++j) children.push_back(node.child(j));
+        keys.insert(keys.begin() + i, split.separator);
+        children.insert(children.begin() + i + 1, split.right);
+
+        std::uint32_t rightPage = newPage(false);
+        PageCache::Handle rh = cache->fetch(rightPage);
+        Node right(rh.data());
+
+        int mid = static_cast<int>(appending ? keys.size() - 1 : keys.size() / 2);
+        for (int j = 0; j < mid; ++j) node.setKey(j, keys[j]);
+        for (int j = 0; j <= mid; ++j) node.setChild(j, children[j]);
+        int moved = static_cast<int>(keys.size()) - mid - 1;
+        for (int j = 0; j < moved; ++j) right.setKey(j, keys[mid + 1 + j]);
+        for (int j = 0; j <= moved; ++j) right.setChild(j, children[mid + 1 + j]);
+        right.setHeader(NodeHeader{ static_cast<std::uint16_t>(moved), 0, 0, 0 });
+        nh.count = static_cast<std::uint16_t>(mid);
+        node.setHeader(nh);
+        h.markDirty();
+        rh.markDirty();
+        return Split{ keys[mid], rightPage };
+    }
+
+    // Pin the leaf that key belongs in.
+    PageCache::Handle findLeaf(const K& key) const {
+        PageCache::Handle h = cache->fetch(header.root);
+        for (;;) {
+            Node node(h.data());
+            NodeHeader nh = node.header();
+            if (nh.leaf) return h;
+            std::uint32_t child = node.child(rank(node, nh.count, key, true));
+            h = cache->fetch(child);
+        }
+    }
+
+public:
+    //
+    // Open the tree stored in the file at path, creating the file if it
+    // doesn't exist.  cachePages is how many pages are kept in memory.
+    // Throws std::system_error if the file can't be opened and
+    // std::runtime_error if it holds something else.
+    //
+    explicit DiskBTree(const std::string& path, std::size_t cachePages = 1024) {
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd < 0) throw std::system_error(errno, std::generic_category(), "DiskBTree: cannot open " + path);
+        cache.reset(new PageCache(fd, PageSize, std::max<std::size_t>(cachePages, 16)));
+
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            int err = errno;
+            ::close(fd);
+            throw std::system_error(err, std::generic_category(), "DiskBTree: cannot stat " + path);
+        }
+        if (st.st_size == 0) {
+            header = FileHeader{ Magic, PageSize, sizeof(K), sizeof(V), 0, 1, 1, 0 };
+            header.root = newPage(true);
+            writeHeader();
+            return;
+        }
+        {
+            PageCache::Handle h = cache->fetch(0);
+            std::memcpy(&header, h.data(), sizeof header);
+        }
+        if (header.magic != Magic || header.pageSize != PageSize || header.keySize != sizeof(K) ||
+            header.valueSize != sizeof(V)) {
+            cache.reset();
+            ::close(fd);
+            throw std::runtime_error("DiskBTree: " + path + " is not a tree with this page, key and value size");
+        }
+    }
+
+    DiskBTree(const DiskBTree&) = delete;
+    DiskBTree& operator=(const DiskBTree&) = delete;
+
+    // Writes everything back.  Errors here can't be reported, so call
+    // flush() first if they matter.
+    ~DiskBTree() {
+        try {
+            flush();
+        } catch (...) {
+        }
+        cache.reset();
+        ::close(fd);
+    }
+
+    std::uint64_t size() const { return header.entries; }
+    bool empty() const { return header.entries == 0; }
+    int height() const { return static_cast<int>(header.height); }
+    std::uint32_t pages() const { return header.pageCount; }
+
+    // Adds key with value, or replaces the value if key is already there.
+    // Returns true if a new entry was added.
+    bool insert(const K& key, const V& value) {
+        bool added = false;
+        std::optional<Split> split = insertRec(header.root, key, value, true, added);
+        if (split) {
+            std::uint32_t newRoot = newPage(false);
+            PageCache::Handle h = cache->fetch(newRoot);
+            Node node(h.data());
+            node.setChild(0, header.root);
+            node.setKey(0, split->separator);
+            node.setChild(1, split->right);
+            node.setHeader(NodeHeader{ 1, 0, 0, 0 });
+            h.markDirty();
+            header.root = newRoot;
+            ++header.height;
+        }
+        if (added) ++header.entries;
+        return added;
+    }
+
+    std::optional<V> find(const K& key) const {
+        PageCache::Handle h = findLeaf(key);
+        Node node(h.data());
+        int count = node.count();
+        int i = rank(node, count, key, false);
+        if (i < count && !comp(key, node.key(i))) return node.value(i);
+        return std::nullopt;
+    }
+
+    bool contains(const K& key) const { return find(key).has_value(); }
+
+    // Call visit(key, value) for each entry with lo <= key < hi, in order,
+    // following the leaf links.
+    template <typename Visitor>
+    void forEachInRange(const K& lo, const K& hi, Visitor visit) const {
+        PageCache::Handle h = findLeaf(lo);
+        int i = rank(Node(h.data()), Node(h.data()).count(), lo, false);
+        for (;;) {
+            Node node(h.data());
+            NodeHeader nh = node.header();
+            for (; i < nh.count; ++i) {
+                K k = node.key(i);
+                if (!comp(k, hi)) return;
+                visit(k, node.value(i));
+            }
+            if (nh.next == 0) return;
+            h = cache->fetch(nh.next);
+            i = 0;
+        }
+    }
+
+    // Write the header and every changed page to the file and ask the
+    // operating system to put them on disk.
+    void flush() {
+        writeHeader();
+        cache->flush();
+        if (::fsync(fd) != 0) throw std::system_error(errno, std::generic_category(), "DiskBTree: fsync failed");
+    }
+
+    // Flush, then empty the page cache and ask the operating system to drop
+    // its copy of the file too, so the next lookups start from disk.
+    void dropCaches() {
+        flush();
+        cache->discard();
+#ifdef POSIX_FADV_DONTNEED
+        ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+#endif
+    }
+
+    const PageCache::Stats& cacheStatistics() const { return cache->statistics(); }
+    void resetCacheStatistics() { cache->resetStatistics(); }
+};
@@ -0,0 +1,97 @@
+// File:   intervaltree.hpp
+// Author: Your Glorious Instructor
+// Purpose:
+// An interval tree built on the augmented AVLTree.
+//
+// The tree stores closed intervals [lo, hi] ordered by their low end point
+// (ties broken by the high end point).  Every node also remembers the
+// largest high end point anywhere in its subtree.  When we look for the
+// intervals that overlap [qlo, qhi] that summary lets us skip a whole
+// subtree as soon as we see its largest end point is below qlo, and the
+// ordering lets us skip everything to the right of a node that starts after
+// qhi.
+//
+// A query costs O(log n) to find where the answers start plus work for each
+// answer found; in the worst case that is O(min(n, k log n)) for k answers,
+// which in practice stays close to log n + k.
+//
+#pragma once
+#include <algorithm>
+#include <tuple>
+#include <vector>
+#include "avltree.hpp"
+
+template <typename K>
+struct Interval {
+    K lo;
+    K hi;
+
+    bool overlaps(const K& qlo, const K& qhi) const {
+        return !(hi < qlo) && !(qhi < lo);
+    }
+
+    bool operator<(const Interval& rhs) const {
+        return std::tie(lo, hi) < std::tie(rhs.lo, rhs.hi);
+    }
+    bool operator==(const Interval& rhs) const {
+        return !(*this < rhs) && !(rhs < *this);
+    }
+};
+
+// Summary for the interval tree: the largest high end point in the subtree.
+template <typename K>
+struct IntervalMaxEnd {
+    using value_type = K;
+    static constexpr bool enabled = true;
+    static K make(const Interval<K>& interval) { return interval.hi; }
+    static K combine(const K& lhs, const K& rhs) { return std::max(lhs, rhs); }
+};
+
+template <typename K, typename Storage = AVLNodeHeap>
+class IntervalTree
+    : public AVLTree<Interval<K>, std::less<Interval<K>>, Storage, IntervalMaxEnd<K>> {
+    using Base = AVLTree<Interval<K>, std::less<Interval<K>>, Storage, IntervalMaxEnd<K>>;
+    using typename Base::Ref;
+    using Base::node;
+
+public:
+    using Base::insert;
+    using Base::remove;
+    using Base::contains;
+
+    bool insert(const K& lo, const K& hi) { return insert(Interval<K>{ lo, hi }); }
+    bool remove(const K& lo, const K& hi) { return remove(Interval<K>{ lo, hi }); }
+
+    // Call visit(interval) for every interval that overlaps [qlo, qhi], in
+    // order of their low end points.
+    template <typename Visitor>
+    void forEachOverlapping(const K& qlo, const K& qhi, Visitor visit) const {
+        visitOverlapping(this->root, qlo, qhi, visit);
+    }
+
+    std::vector<Interval<K>> overlapping(const K& qlo, const K& qhi) const {
+        std::vector<Interval<K>> result;
+        forEachOverlapping(qlo, qhi, [&result](const Interval<K>& i) { result.push_back(i); });
+        return result;
+    }
+
+    // All intervals that contain the point x.
+    std::vector<Interval<K>> stabbing(const K& x) const {
+        return overlapping(x, x);
+    }
+
+private:
+    template <typename Visitor>
+    void visitOverlapping(Ref ref, const K& qlo, const K& qhi, Visitor& visit) const {
+        while (ref) {
+            const auto& n = node(ref);
+            // Nothing in this subtree reaches far enough right
+            if (n.summary < qlo) return;
+            visitOverlapping(n.left, qlo, qhi, visit);
+            // This interval and everything to its right start too late
+            if (qhi < n.key.lo) return;
+            if (n.key.overlaps(qlo, qhi)) visit(n.key);
+            ref = n.right;
+        }
+    }
+};
@@ -0,0 +1,113 @@
+// File:   rangesumtree.hpp
+// Author: Your Glorious Instructor
+// Purpose:
+// A key/value map built on the augmented AVLTree that answers "count, sum,
+// min and max of the values whose keys fall in [lo, hi]" in O(log n).
+//
+// Each node keeps those four numbers for its whole subtree.  To answer a
+// query we walk down from the root: once a subtree is known to lie entirely
+// inside the range we take its stored summary instead of visiting it, and
+// that only happens along the two paths to the range's end points.
+//
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include "avltree.hpp"
+
+template <typename V>
+struct RangeSummary {
+    std::size_t count = 0;
+    V sum = V();
+    V min = V();
+    V max = V();
+};
+
+// Summary for the range-sum tree.  Keys don't matter here, only values.
+template <typename K, typename V>
+struct RangeSumAugment {
+    using value_type = RangeSummary<V>;
+    static constexpr bool enabled = true;
+    static value_type make(const std::pair<K, V>& entry) {
+        return value_type{ 1, entry.second, entry.second, entry.second };
+    }
+    static value_type combine(const value_type& lhs, const value_type& rhs) {
+        return value_type{ lhs.count + rhs.count, lhs.sum + rhs.sum,
+                           std::min(lhs.min, rhs.min), std::max(lhs.max, rhs.max) };
+    }
+};
+
+// Order entries by key alone so each key appears once.
+template <typename K, typename V, typename KeyCompare = std::less<K>>
+struct CompareByKey {
+    KeyCompare keyLess;
+    bool operator()(const std::pair<K, V>& lhs, const std::pair<K, V>& rhs) const {
+        return keyLess(lhs.first, rhs.first);
+    }
+};
+
+template <typename K, typename V, typename Storage = AVLNodeHeap>
+class RangeSumTree
+    : public AVLTree<std::pair<K, V>, CompareByKey<K, V>, Storage, RangeSumAugment<K, V>> {
+    using Base = AVLTree<std::pair<K, V>, CompareByKey<K, V>, Storage, RangeSumAugment<K, V>>;
+    using Augment = RangeSumAugment<K, V>;
+    using typename Base::Ref;
+    using Base::node;
+
+public:
+    using Base::insert;
+    using Base::remove;
+
+    bool insert(const K& key, const V& value) { return insert(std::make_pair(key, value)); }
+    bool remove(const K& key) { return remove(std::make_pair(key, V())); }
+
+    // Summary of the values whose keys lie in [lo, hi].  count is 0 and the
+    // other fields are V() when no key is in range.
+    RangeSummary<V> aggregate(const K& lo, const K& hi) const {
+        RangeSummary<V> result;
+        collect(this->root, lo, hi, false, false, result);
+        return result;
+    }
+
+    V sum(const K& lo, const K& hi) const { return aggregate(lo, hi).sum; }
+
+    // Call visit(key, value) for every entry with a key in [lo, hi], in order.
+    template <typename Visitor>
+    void forEachInRange(const K& lo, const K& hi, Visitor visit) const {
+        for (auto it = this->lower_bound(std::make_pair(lo, V()));
+             it != this->end() && !(hi < it->first); ++it)
+            visit(it->first, it->second);
+    }
+
+private:
+    static void add(RangeSummary<V>& total, const RangeSummary<V>& part) {
+        total = (total.count == 0) ? part : Augment::combine(total, part);
+    }
+
+    // aboveLo / belowHi record that every key in this subtree is already
+    // known to be >= lo / <= hi, so that bound needs no more checking.
+    // Summaries are added in key order, which keeps combine's contract.
+    void collect(Ref ref, const K& lo, const K& hi, bool aboveLo, bool belowHi,
+                 RangeSummary<V>& total) const {
+        while (ref) {
+            const auto& n = node(ref);
+            if (aboveLo && belowHi) {
+                add(total, n.summary);
+                return;
+            }
+            if (!aboveLo && n.key.first < lo) {
+                ref = n.right;
+            } else if (!belowHi && hi < n.key.first) {
+                ref = n.left;
+            } else {
+                // This node is in range, so its left subtree is all <= hi
+                // and its right subtree is all >= lo.
+                if (n.left) collect(n.left, lo, hi, aboveLo, true, total);
+                add(total, Augment::make(n.key));
+                ref = n.right;
+                aboveLo = true;
+            }
+        }
+    }
+};
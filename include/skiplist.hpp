@@ -1,51 +1,294 @@
+//
+// File:   skiplist.hpp
+// Author: Your Glorious Instructor
+// Purpose:
+// Provide a skip list: a sorted linked list with extra "express lane" links
+// that make search, insert and erase O(log n) on average.  It can hold a
+// set of keys or map keys to values, and since level 0 is an ordinary
+// sorted list, walking a range of keys in order is as cheap as walking a
+// linked list.
+//
+// Each node is a single block holding its key followed directly by its
+// tower of forward links, so a node costs one allocation and a step along a
+// link is a plain pointer load.  The links don't own anything; the list
+// frees its nodes itself.  Blocks come from a SkipListPool that carves them
+// out of large slabs and keeps a free list for each tower height, so erased
+// nodes are reused by later inserts of the same height.
+//
+#pragma once
 #include <iostream>
-#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
 #include <memory>
+#include <new>
 #include <random>
-#include <cassert>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+//
+// Hands out variable-sized blocks for skip list nodes.  Memory comes from
+// slabs of SlabSize bytes that are only returned when the pool is
+// destroyed; a released block goes on the free list for its size class
+// (the tower height) and is handed out again by the next request of that
+// size.  Every block is aligned to Alignment.
+//
+template <std::size_t Alignment>
+class SkipListPool {
+    static_assert(Alignment >= alignof(void*) && Alignment <= alignof(std::max_align_t) &&
+                  (Alignment & (Alignment - 1)) == 0, "unsupported block alignment");
+
+public:
+    SkipListPool() = default;
+    SkipListPool(const SkipListPool&) = delete;
+    SkipListPool& operator=(const SkipListPool&) = delete;
+    ~SkipListPool() { freeSlabs(); }
+
+    void* allocate(std::size_t bytes, int sizeClass) {
+        if (sizeClass < static_cast<int>(freeLists.size()) && freeLists[sizeClass] != nullptr) {
+            FreeBlock* block = freeLists[sizeClass];
+            freeLists[sizeClass] = block->next;
+            return block;
+        }
+        bytes = roundUp(bytes);
+        if (bytes > remaining) {
+            std::size_t slabBytes = bytes > SlabSize ? bytes : SlabSize;
+            slabs.push_back(static_cast<char*>(::operator new(slabBytes)));
+            cursor = slabs.back();
+            remaining = slabBytes;
+        }
+        void* block = cursor;
+        cursor += bytes;
+        remaining -= bytes;
+        return block;
+    }
+
+    void release(void* block, int sizeClass) {
+        if (sizeClass >= static_cast<int>(freeLists.size())) freeLists.resize(sizeClass + 1, nullptr);
+        FreeBlock* freed = ::new (block) FreeBlock;
+        freed->next = freeLists[sizeClass];
+        freeLists[sizeClass] = freed;
+    }
+
+    // Return all memory at once.  Anything still living in it must already
+    // have been destroyed.
+    void clear() {
+        freeSlabs();
+        freeLists.clear();
+    }
+
+private:
+    static constexpr std::size_t SlabSize = 64 * 1024;
 
-template <typename Comparable>
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    static std::size_t roundUp(std::size_t bytes) {
+        return (bytes + Alignment - 1) & ~(Alignment - 1);
+    }
+
+    void freeSlabs() {
+        for (char* slab : slabs) ::operator delete(slab);
+        slabs.clear();
+        cursor = nullptr;
+        remaining = 0;
+    }
+
+    std::vector<char*> slabs;
+    std::vector<FreeBlock*> freeLists;
+    char* cursor = nullptr;
+    std::size_t remaining = 0;
+};
+
+// What insert does when the key is already in the list.
+enum class DuplicatePolicy {
+    Reject,      // leave the list alone and return false
+    Overwrite,   // replace the stored entry (for a map, its value)
+    Allow        // keep both; the new entry goes after the existing ones
+};
+
+//
+// SkipList<K> is an ordered set of keys and SkipList<K, V> an ordered map
+// from K to V.  In the map, entries are std::pair<const K, V> like in
+// std::map, and iterating gives them in key order.  What happens to a key
+// that is already present is up to the DuplicatePolicy; the default, Allow,
+// keeps every copy.
+//
+template <typename K, typename V = void>
 class SkipList {
+public:
+    using key_type = K;
+    using mapped_type = V;
+    using value_type = typename std::conditional<std::is_void<V>::value, K, std::pair<const K, V>>::type;
+    using size_type = std::size_t;
+
 private:
-    struct Node {
-        Comparable key;
-        std::vector<std::shared_ptr<Node>> forward;
+    static constexpr bool IsMap = !std::is_void<V>::value;
+
+    // No list can be taller than this; it sizes the update arrays that
+    // insert and erase keep on the stack.
+    static constexpr int MaxLevelLimit = 32;
+
+    //
+    // A node is its entry and height followed by `height` forward links in
+    // the same block.  The head node only has the links: its entry is never
+    // constructed, so neither K nor V needs a default constructor.
+    //
+    struct alignas(void*) Node {
+        alignas(value_type) unsigned char storage[sizeof(value_type)];
+        int height;
 
-        Node(int k, int level) : key(k), forward(level, nullptr) {}
+        value_type& value() { return *reinterpret_cast<value_type*>(storage); }
+        const value_type& value() const { return *reinterpret_cast<const value_type*>(storage); }
+        const K& key() const { return keyOf(value()); }
+
+        Node** forward() { return reinterpret_cast<Node**>(this + 1); }
+        Node* const* forward() const { return reinterpret_cast<Node* const*>(this + 1); }
     };
 
+    static const K& keyOf(const value_type& entry) {
+        if constexpr (IsMap) return entry.first;
+        else return entry;
+    }
+
+    DuplicatePolicy policy;
     int maxLevel;
-    float probability;
     int level;
-    std::shared_ptr<Node> head;
-    std::random_device rd;
+    std::size_t count;
+    std::uint64_t version;     // bumped whenever nodes are added or removed
+    std::uint32_t threshold;   // a level is added while gen() < threshold
     std::mt19937 gen;
-    std::uniform_real_distribution<> distribution;
+    SkipListPool<alignof(Node)> pool;
+    Node* head;
+
+    static std::size_t nodeBytes(int height) { return sizeof(Node) + height * sizeof(Node*); }
+
+    Node* allocateNode(int height) {
+        Node* node = ::new (pool.allocate(nodeBytes(height), height)) Node;
+        node->height = height;
+        for (int i = 0; i < height; ++i) node->forward()[i] = nullptr;
+        return node;
+    }
+
+    void destroyNode(Node* node) {
+        node->value().~value_type();
+        pool.release(node, node->height);
+    }
 
     int randomLevel() {
         int lvl = 1;
-        while (distribution(gen) < probability && lvl < maxLevel) {
+        while (gen() < threshold && lvl < maxLevel) {
             ++lvl;
         }
         return lvl;
     }
 
-public:
-    SkipList(int maxLvl = 16, float prob = 0.5)
-        : maxLevel(maxLvl), probability(prob), level(1), 
-          head(std::make_shared<Node>(-1, maxLvl)),
-          gen(rd()), distribution(0.0, 1.0) {}
-
-    void insert(Comparable key) {
-        std::vector<std::shared_ptr<Node>> update(maxLevel, nullptr);
-        auto current = head;
-
+    // Fill update[i] with the last node on level i whose key is less than
+    // key, and return the first node on level 0 that is not.
+    Node* findPredecessors(const K& key, Node** update) const {
+        Node* current = head;
         for (int i = level - 1; i >= 0; --i) {
-            while (current->forward[i] && current->forward[i]->key < key) {
-                current = current->forward[i];
+            Node* next;
+            while ((next = current->forward()[i]) != nullptr && next->key() < key) {
+                current = next;
             }
             update[i] = current;
         }
+        return current->forward()[0];
+    }
+
+    // First node whose key is not less than key (or, with `after`, is
+    // greater than key).  Read-only, so no update array.
+    Node* seek(const K& key, bool after) const {
+        Node* current = head;
+        for (int i = level - 1; i >= 0; --i) {
+            Node* next;
+            while ((next = current->forward()[i]) != nullptr &&
+                   (after ? !(key < next->key()) : next->key() < key)) {
+                current = next;
+            }
+        }
+        return current->forward()[0];
+    }
+
+    // Map entries keep their key; only the value is replaced.
+    static void overwrite(Node* node, const value_type& entry) {
+        if constexpr (IsMap) node->value().second = entry.second;
+        else node->value() = entry;
+    }
+
+    // Run the entry destructors.  The memory itself goes back with the pool.
+    void destroyAll() {
+        if (std::is_trivially_destructible<value_type>::value) return;
+        Node* node = head->forward()[0];
+        while (node != nullptr) {
+            Node* next = node->forward()[0];
+            node->value().~value_type();
+            node = next;
+        }
+    }
+
+    //
+    // Iterators walk level 0, so ++ is one pointer load.  As with std::set,
+    // a set's entries can't be changed through an iterator; a map's values
+    // can.
+    //
+    template <bool IsConst>
+    class Iterator {
+        friend class SkipList;
+        using NodePtr = typename std::conditional<IsConst, const Node*, Node*>::type;
+        NodePtr node = nullptr;
+        explicit Iterator(NodePtr n) : node(n) {}
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = typename SkipList::value_type;
+        using difference_type = std::ptrdiff_t;
+        using reference = typename std::conditional<IsConst || !IsMap, const value_type&, value_type&>::type;
+        using pointer = typename std::conditional<IsConst || !IsMap, const value_type*, value_type*>::type;
+
+        Iterator() = default;
+        // A mutable iterator converts to a const one.
+        template <bool WasConst, typename = typename std::enable_if<IsConst && !WasConst>::type>
+        Iterator(const Iterator<WasConst>& other) : node(other.node) {}
+
+        reference operator*() const { return node->value(); }
+        pointer operator->() const { return &node->value(); }
+
+        Iterator& operator++() {
+            node = node->forward()[0];
+            return *this;
+        }
+        Iterator operator++(int) {
+            Iterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        bool operator==(const Iterator& rhs) const { return node == rhs.node; }
+        bool operator!=(const Iterator& rhs) const { return node != rhs.node; }
+    };
+
+    // Insert entry given update[i], the last node on each level that goes
+    // before it, and next, the node after update[0].  Leaves update[] set
+    // up the same way for an entry that sorts right after this one.
+    bool insertEntry(const value_type& entry, Node** update, Node* next) {
+        if (next && !(keyOf(entry) < next->key())) {
+            if (policy == DuplicatePolicy::Reject) return false;
+            if (policy == DuplicatePolicy::Overwrite) {
+                overwrite(next, entry);
+                return false;
+            }
+            // Allow: go after the last equal key so copies stay in insertion
+            // order.
+            for (int i = level - 1; i >= 0; --i) {
+                Node* n;
+                while ((n = update[i]->forward()[i]) != nullptr && !(keyOf(entry) < n->key()))
+                    update[i] = n;
+            }
+        }
 
         int newLevel = randomLevel();
         if (newLevel > level) {
@@ -55,61 +298,241 @@ public:
             level = newLevel;
         }
 
-        auto newNode = std::make_shared<Node>(key, newLevel);
+        Node* newNode = allocateNode(newLevel);
+        try {
+            ::new (static_cast<void*>(newNode->storage)) value_type(entry);
+        } catch (...) {
+            pool.release(newNode, newLevel);
+            throw;
+        }
         for (int i = 0; i < newLevel; ++i) {
-            newNode->forward[i] = update[i]->forward[i];
-            update[i]->forward[i] = newNode;
+            newNode->forward()[i] = update[i]->forward()[i];
+            update[i]->forward()[i] = newNode;
+            update[i] = newNode;
         }
+        ++count;
+        ++version;
+        return true;
     }
 
-    bool search(Comparable key) const {
-        auto current = head;
-        for (int i = level - 1; i >= 0; --i) {
-            while (current->forward[i] && current->forward[i]->key < key) {
-                current = current->forward[i];
+    bool insertEntry(const value_type& entry) {
+        Node* update[MaxLevelLimit];
+        Node* next = findPredecessors(keyOf(entry), update);
+        return insertEntry(entry, update, next);
+    }
+
+public:
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    //
+    // A finger remembers where the last search through it ended: the last
+    // node before that spot on every level.  The next search through the
+    // same finger climbs only as high as it needs to get past the new key
+    // and comes back down from there, so a key close to the previous one
+    // costs O(log d) for a distance of d entries instead of O(log n).
+    //
+    // Any insert or erase not made through the finger may leave it pointing
+    // at a node that is gone; the list notices and the next search through
+    // it starts over from the head.
+    //
+    class Finger {
+        friend class SkipList;
+        Node* preds[MaxLevelLimit] = {};
+        const SkipList* owner = nullptr;
+        std::uint64_t version = 0;
+    };
+
+private:
+    // Is node the last one on level i that goes before key?
+    bool precedes(const Node* node, int i, const K& key) const {
+        if (node != head && !(node->key() < key)) return false;
+        const Node* next = node->forward()[i];
+        return next == nullptr || !(next->key() < key);
+    }
+
+    //
+    // findPredecessors, starting from a finger.  The finger's nodes are the
+    // last ones on each level before some earlier spot in the list, so once
+    // one level's node is right for key every level above it is too.  We
+    // climb to the first level that is right and search down from there.
+    //
+    Node* fingerSearch(const K& key, Finger& finger) {
+        if (finger.owner != this || finger.version != version) {
+            findPredecessors(key, finger.preds);
+        } else {
+            int top = 0;
+            while (top < level && !precedes(finger.preds[top], top, key)) ++top;
+            Node* current = (top < level) ? finger.preds[top] : head;
+            for (int i = top - 1; i >= 0; --i) {
+                Node* next;
+                while ((next = current->forward()[i]) != nullptr && next->key() < key) {
+                    current = next;
+                }
+                finger.preds[i] = current;
             }
         }
-        current = current->forward[0];
-        return current && current->key == key;
+        finger.owner = this;
+        finger.version = version;
+        return finger.preds[0]->forward()[0];
     }
 
-    void erase(int key) {
-        std::vector<std::shared_ptr<Node>> update(maxLevel, nullptr);
-        auto current = head;
+public:
 
-        for (int i = level - 1; i >= 0; --i) {
-            while (current->forward[i] && current->forward[i]->key < key) {
-                current = current->forward[i];
-            }
-            update[i] = current;
+    //
+    // A range of entries, usable in a range-based for loop.
+    //
+    template <typename It>
+    class Range {
+        It first;
+        It last;
+
+    public:
+        Range(It f, It l) : first(f), last(l) {}
+        It begin() const { return first; }
+        It end() const { return last; }
+        bool empty() const { return first == last; }
+    };
+
+    SkipList(int maxLvl = 16, float prob = 0.5)
+        : SkipList(DuplicatePolicy::Allow, maxLvl, prob) {}
+
+    explicit SkipList(DuplicatePolicy dup, int maxLvl = 16, float prob = 0.5)
+        : policy(dup),
+          maxLevel(maxLvl < 1 ? 1 : (maxLvl > MaxLevelLimit ? MaxLevelLimit : maxLvl)),
+          level(1),
+          count(0),
+          version(1),
+          threshold(static_cast<std::uint32_t>(prob * 4294967296.0 > 4294967295.0
+                                                   ? 4294967295.0 : prob * 4294967296.0)),
+          gen(std::random_device{}()),
+          head(allocateNode(maxLevel)) {}
+
+    SkipList(const SkipList&) = delete;
+    SkipList& operator=(const SkipList&) = delete;
+
+    ~SkipList() { destroyAll(); }
+
+    size_type size() const { return count; }
+    bool empty() const { return count == 0; }
+    DuplicatePolicy duplicatePolicy() const { return policy; }
+
+    // Returns true if a new entry was added.  Under Overwrite an existing
+    // entry is updated in place and false is returned.
+    template <typename Value = V>
+    typename std::enable_if<std::is_void<Value>::value, bool>::type
+    insert(const K& key) { return insertEntry(key); }
+
+    template <typename Value = V>
+    typename std::enable_if<!std::is_void<Value>::value, bool>::type
+    insert(const K& key, const Value& value) { return insertEntry(value_type(key, value)); }
+
+    template <typename Value = V>
+    typename std::enable_if<!std::is_void<Value>::value, bool>::type
+    insert(const value_type& entry) { return insertEntry(entry); }
+
+    bool search(const K& key) const {
+        const Node* current = seek(key, false);
+        return current && !(key < current->key());
+    }
+
+    bool contains(const K& key) const { return search(key); }
+
+    // With duplicates allowed these find the first copy.
+    iterator find(const K& key) {
+        Node* current = seek(key, false);
+        return iterator(current && !(key < current->key()) ? current : nullptr);
+    }
+    const_iterator find(const K& key) const {
+        return const_cast<SkipList*>(this)->find(key);
+    }
+
+    // First entry with a key not less than / greater than key.
+    iterator lower_bound(const K& key) { return iterator(seek(key, false)); }
+    const_iterator lower_bound(const K& key) const { return const_iterator(seek(key, false)); }
+    iterator upper_bound(const K& key) { return iterator(seek(key, true)); }
+    const_iterator upper_bound(const K& key) const { return const_iterator(seek(key, true)); }
+
+    // The entries with lo <= key < hi, in order, like the standard
+    // containers' [lower_bound(lo), lower_bound(hi)).
+    Range<iterator> range(const K& lo, const K& hi) {
+        if (!(lo < hi)) return Range<iterator>(end(), end());
+        return Range<iterator>(lower_bound(lo), lower_bound(hi));
+    }
+    Range<const_iterator> range(const K& lo, const K& hi) const {
+        if (!(lo < hi)) return Range<const_iterator>(end(), end());
+        return Range<const_iterator>(lower_bound(lo), lower_bound(hi));
+    }
+
+    // The same searches, resuming from where the finger last stopped.
+    iterator lower_bound(const K& key, Finger& finger) { return iterator(fingerSearch(key, finger)); }
+    iterator find(const K& key, Finger& finger) {
+        Node* current = fingerSearch(key, finger);
+        return iterator(current && !(key < current->key()) ? current : nullptr);
+    }
+
+    //
+    // Insert every entry in [first, last), following the same rules as
+    // insert.  Each search starts from where the previous insert left off,
+    // so sorted or nearly sorted input costs close to O(1) per entry rather
+    // than O(log n).  Any order works; it is just slower when the keys jump
+    // around.  Returns how many entries were added.
+    //
+    template <typename InputIt>
+    size_type insert_sorted_batch(InputIt first, InputIt last) {
+        Finger finger;
+        size_type added = 0;
+        for (; first != last; ++first) {
+            value_type entry(*first);
+            Node* next = fingerSearch(keyOf(entry), finger);
+            if (insertEntry(entry, finger.preds, next)) ++added;
+            finger.version = version;
         }
+        return added;
+    }
 
-        current = current->forward[0];
+    iterator begin() { return iterator(head->forward()[0]); }
+    iterator end() { return iterator(nullptr); }
+    const_iterator begin() const { return const_iterator(head->forward()[0]); }
+    const_iterator end() const { return const_iterator(nullptr); }
 
-        if (current && current->key == key) {
-            for (int i = 0; i < level; ++i) {
-                if (update[i]->forward[i] != current) {
-                    break;
-                }
-                update[i]->forward[i] = current->forward[i];
-            }
+    // Removes one copy of key.  Returns false if it wasn't there.
+    bool erase(const K& key) {
+        Node* update[MaxLevelLimit];
+        Node* current = findPredecessors(key, update);
+        if (!current || key < current->key()) return false;
 
-            while (level > 1 && !head->forward[level - 1]) {
-                --level;
-            }
+        for (int i = 0; i < current->height; ++i) {
+            update[i]->forward()[i] = current->forward()[i];
+        }
+        destroyNode(current);
+        --count;
+        ++version;
+
+        while (level > 1 && !head->forward()[level - 1]) {
+            --level;
         }
+        return true;
+    }
+
+    void clear() {
+        destroyAll();
+        pool.clear();
+        head = allocateNode(maxLevel);
+        level = 1;
+        count = 0;
+        ++version;
     }
 
     void print() const {
         for (int i = 0; i < level; ++i) {
-            auto node = head->forward[i];
+            const Node* node = head->forward()[i];
             std::cout << "Level " << i + 1 << ": ";
             while (node) {
-                std::cout << node->key << " ";
-                node = node->forward[i];
+                std::cout << node->key() << " ";
+                node = node->forward()[i];
             }
             std::cout << "\n";
         }
     }
 };
-
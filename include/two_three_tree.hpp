@@ -1,3 +1,24 @@
+//
+// File:   two_three_tree.hpp
+// Author: Your Glorious Instructor
+// Purpose:
+// Provide a 2-3 tree: every internal node has 2 children and 1 key or 3
+// children and 2 keys, and all the leaves are at the same depth.
+//
+// Inserting goes down to a leaf and adds the key there.  A node that ends up
+// with 3 keys splits into two 1-key nodes and pushes its middle key up into
+// its parent, which may split in turn; when the root splits the tree grows
+// a level.
+//
+// Erasing always takes a key out of a leaf (a key in an internal node is
+// first swapped with its in-order predecessor, which is in a leaf).  A
+// node left with no keys borrows one through its parent from a sibling
+// that has two, or else merges with a sibling that has one, taking the
+// parent's key between them with it.  That can leave the parent empty, so
+// the fix-up repeats on the way back up; when the root ends up empty the
+// tree shrinks a level.
+//
+#pragma once
 #include <iostream>
 #include <vector>
 #include <memory>
@@ -13,7 +34,7 @@ private:
         std::vector<Comparable> keys; // Holds 1 or 2 keys
         std::vector<std::unique_ptr<TwoThreeNode>> children; // Holds 0, 2, or 3 children
 
-        TwoThreeNode(Comparable key) {
+        TwoThreeNode(const Comparable& key) {
             keys.push_back(key);
         }
 
@@ -21,14 +42,31 @@ private:
             return children.empty();
         }
 
+        // A node only holds 3 keys in the middle of an insert, just
+        // before splitNode breaks it up.
         bool isFull() const {
-            return keys.size() == 2;
+            return keys.size() == 3;
+        }
+
+        // Index of the first key that is not less than key; also the child
+        // to follow when key isn't in this node.
+        std::size_t position(const Comparable& key) const {
+            std::size_t index = 0;
+            while (index < keys.size() && keys[index] < key) {
+                ++index;
+            }
+            return index;
+        }
+
+        bool holds(std::size_t index, const Comparable& key) const {
+            return index < keys.size() && !(key < keys[index]);
         }
     };
     std::unique_ptr<TwoThreeNode> root;
 
 public:
-    void insert(Comparable key) {
+    // Adds key if it isn't already in the tree.
+    void insert(const Comparable& key) {
         if (!root) {
             root = std::make_unique<TwoThreeNode>(key);
             return;
@@ -43,10 +81,26 @@ public:
         }
     }
 
-    std::optional<Comparable> search(Comparable key) const {
+    // Returns true if key was in the tree and has been removed.
+    bool erase(const Comparable& key) {
+        if (!root) return false;
+        bool removed = eraseRec(root.get(), key);
+        if (root->keys.empty()) {
+            root = root->isLeaf() ? nullptr : std::move(root->children[0]);
+        }
+        return removed;
+    }
+
+    std::optional<Comparable> search(const Comparable& key) const {
         return searchRec(root.get(), key);
     }
 
+    // Every internal node has one more child than keys, keys are in order
+    // within and between nodes, and all the leaves are at one depth.
+    bool isValid() const {
+        return !root || checkedHeight(root.get(), nullptr, nullptr) > 0;
+    }
+
     void levelOrderTraversal() const {
         if (!root) return;
 
@@ -59,7 +113,7 @@ public:
                 auto* node = q.front();
                 q.pop();
                 if (node != nullptr) {
-                    for (int key : node->keys) {
+                    for (const Comparable& key : node->keys) {
                         std::cout << key << " ";
                     }
                     std::cout << " | ";
@@ -74,18 +128,16 @@ public:
     }
 
 private:
-    std::pair<std::unique_ptr<TwoThreeNode>, std::optional<Comparable>> insertRec(std::unique_ptr<TwoThreeNode>& node, Comparable key) {
+    std::pair<std::unique_ptr<TwoThreeNode>, std::optional<Comparable>> insertRec(std::unique_ptr<TwoThreeNode>& node, const Comparable& key) {
+        size_t index = node->position(key);
+        if (node->holds(index, key)) return {nullptr, std::nullopt};
+
         if (node->isLeaf()) {
-            node->keys.push_back(key);
-            std::sort(node->keys.begin(), node->keys.end());
+            // The keys are already in order, so just slot the new one in.
+            node->keys.insert(node->keys.begin() + index, key);
             return splitNode(node);
         }
 
-        size_t index = 0;
-        while (index < node->keys.size() && key > node->keys[index]) {
-            ++index;
-        }
-
         auto [newChild, promotedKey] = insertRec(node->children[index], key);
         if (newChild) {
             node->keys.insert(node->keys.begin() + index, promotedKey.value());
@@ -99,31 +151,119 @@ private:
     std::pair<std::unique_ptr<TwoThreeNode>, std::optional<Comparable>> splitNode(std::unique_ptr<TwoThreeNode>& node) {
         if (!node->isFull()) return {nullptr, std::nullopt};
 
-        auto newNode = std::make_unique<TwoThreeNode>(node->keys[1]);
-        node->keys.pop_back();
+        // Keep the smallest key, send the middle one up and move the largest
+        // (with the two rightmost children) to a new node.
+        auto newNode = std::make_unique<TwoThreeNode>(node->keys[2]);
+        Comparable middle = node->keys[1];
+        node->keys.resize(1);
 
         if (!node->isLeaf()) {
-            newNode->children.push_back(std::move(node->children[1]));
             newNode->children.push_back(std::move(node->children[2]));
+            newNode->children.push_back(std::move(node->children[3]));
             node->children.resize(2);
         }
 
-        return {std::move(newNode), node->keys[0]};
+        return {std::move(newNode), middle};
     }
 
-    std::optional<Comparable> searchRec(const TwoThreeNode* node, Comparable key) const {
-        if (!node) return std::nullopt;
+    // Remove key from the subtree at node.  Any child left empty is fixed
+    // before returning, but node itself may be left empty for its parent
+    // to deal with.
+    bool eraseRec(TwoThreeNode* node, const Comparable& key) {
+        size_t index = node->position(key);
+        bool here = node->holds(index, key);
 
-        for (int nodeKey : node->keys) {
-            if (key == nodeKey) return key;
+        if (node->isLeaf()) {
+            if (!here) return false;
+            node->keys.erase(node->keys.begin() + index);
+            return true;
         }
 
-        if (node->isLeaf()) return std::nullopt;
+        bool removed;
+        if (here) {
+            // Swap in the largest key of the left subtree, which sits in a
+            // leaf, and remove that instead.
+            const TwoThreeNode* pred = node->children[index].get();
+            while (!pred->isLeaf()) pred = pred->children.back().get();
+            node->keys[index] = pred->keys.back();
+            removed = eraseRec(node->children[index].get(), node->keys[index]);
+        } else {
+            removed = eraseRec(node->children[index].get(), key);
+        }
+
+        if (node->children[index]->keys.empty()) fixEmptyChild(node, index);
+        return removed;
+    }
+
+    // The child at index has no keys (and, if internal, one child).  Borrow
+    // a key from a sibling with two, or merge with a sibling with one.
+    void fixEmptyChild(TwoThreeNode* parent, size_t index) {
+        auto& children = parent->children;
+        TwoThreeNode* child = children[index].get();
 
-        size_t index = 0;
-        while (index < node->keys.size() && key > node->keys[index]) {
-            ++index;
+        if (index > 0 && children[index - 1]->keys.size() == 2) {
+            TwoThreeNode* left = children[index - 1].get();
+            child->keys.insert(child->keys.begin(), parent->keys[index - 1]);
+            parent->keys[index - 1] = left->keys.back();
+            left->keys.pop_back();
+            if (!left->isLeaf()) {
+                child->children.insert(child->children.begin(), std::move(left->children.back()));
+                left->children.pop_back();
+            }
+        } else if (index + 1 < children.size() && children[index + 1]->keys.size() == 2) {
+            TwoThreeNode* right = children[index + 1].get();
+            child->keys.push_back(parent->keys[index]);
+            parent->keys[index] = right->keys.front();
+            right->keys.erase(right->keys.begin());
+            if (!right->isLeaf()) {
+                child->children.push_back(std::move(right->children.front()));
+                right->children.erase(right->children.begin());
+            }
+        } else if (index > 0) {
+            // Fold the empty child and the key above it into the left sibling.
+            TwoThreeNode* left = children[index - 1].get();
+            left->keys.push_back(parent->keys[index - 1]);
+            for (auto& grandchild : child->children) left->children.push_back(std::move(grandchild));
+            parent->keys.erase(parent->keys.begin() + index - 1);
+            children.erase(children.begin() + index);
+        } else {
+            // Same, into the right sibling.
+            TwoThreeNode* right = children[index + 1].get();
+            right->keys.insert(right->keys.begin(), parent->keys[index]);
+            for (auto& grandchild : child->children)
+                right->children.insert(right->children.begin(), std::move(grandchild));
+            parent->keys.erase(parent->keys.begin() + index);
+            children.erase(children.begin() + index);
+        }
+    }
+
+    std::optional<Comparable> searchRec(const TwoThreeNode* node, const Comparable& key) const {
+        while (node) {
+            size_t index = node->position(key);
+            if (node->holds(index, key)) return node->keys[index];
+            node = node->isLeaf() ? nullptr : node->children[index].get();
+        }
+        return std::nullopt;
+    }
+
+    // Height of a valid subtree with all keys strictly between lo and hi
+    // (where given), or -1 if something is wrong.
+    int checkedHeight(const TwoThreeNode* node, const Comparable* lo, const Comparable* hi) const {
+        const auto& keys = node->keys;
+        if (keys.empty() || keys.size() > 2) return -1;
+        if (!node->isLeaf() && node->children.size() != keys.size() + 1) return -1;
+        for (size_t i = 0; i < keys.size(); ++i) {
+            if (i > 0 && !(keys[i - 1] < keys[i])) return -1;
+            if ((lo && !(*lo < keys[i])) || (hi && !(keys[i] < *hi))) return -1;
+        }
+        if (node->isLeaf()) return 1;
+        int height = -1;
+        for (size_t i = 0; i < node->children.size(); ++i) {
+            int h = checkedHeight(node->children[i].get(), i == 0 ? lo : &keys[i - 1],
+                                  i == keys.size() ? hi : &keys[i]);
+            if (h < 0 || (height >= 0 && h != height)) return -1;
+            height = h;
         }
-        return searchRec(node->children[index].get(), key);
+        return height + 1;
     }
 };